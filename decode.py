@@ -6,46 +6,183 @@ HEADER_BOOT =  0x00
 HEADER_UPDATE = 0x01
 HEADER_BUTTON_CLICK = 0x02
 HEADER_BUTTON_HOLD  = 0x03
+HEADER_ALARM = 0x04
+HEADER_BACKFILL = 0x05
+HEADER_DOWNLINK = 0x06
+
+HEADER_COMPACT = 0x80
+HEADER_BATCH = 0x40
+BATCH_ESCAPE = 0x80
+BITMAP_FIELDS = 7
+BITMAP_MORE = 0x80
 
 header_lut = {
     HEADER_BOOT: 'BOOT',
     HEADER_UPDATE: 'UPDATE',
     HEADER_BUTTON_CLICK: 'BUTTON_CLICK',
-    HEADER_BUTTON_HOLD: 'BUTTON_HOLD'
+    HEADER_BUTTON_HOLD: 'BUTTON_HOLD',
+    HEADER_ALARM: 'ALARM',
+    HEADER_BACKFILL: 'BACKFILL',
+    HEADER_DOWNLINK: 'DOWNLINK'
 }
 
+# Field order of all layouts and bit order of the presence bitmap, copy of SENSOR_TABLE in src/sensor.h:
+# (name, width in bytes, signed, num, den), wire value = physical value * num / den
+fields = (
+    ('voltage', 1, False, 10, 1),
+    ('temperature', 2, True, 10, 1),
+    ('humidity', 1, False, 2, 1),
+    ('voc', 2, False, 1, 1),
+    ('pressure', 2, False, 1, 2),
+    ('co2', 2, False, 1, 1),
+    ('voltage_idle', 1, False, 10, 1),
+    ('temperature_2', 2, True, 10, 1),
+    ('humidity_2', 1, False, 2, 1),
+)
+field_lut = {field[0]: field for field in fields}
+
+
+def decode_signed(name, raw):
+    _, width, signed, _, _ = field_lut[name]
+    if signed and raw >= 1 << (width * 8 - 1):
+        raw -= 1 << (width * 8)
+    return raw
+
+
+def decode_field(name, raw):
+    _, _, _, num, den = field_lut[name]
+    raw = decode_signed(name, raw)
+    if num == 1:
+        return raw * den
+    return raw * den / num
+
+
+def decode_bitmap(data, offset):
+    """Presence bitmap and the offset behind it, 7 fields per byte, bit 7 announces another byte."""
+    bitmap = 0
+    shift = 0
+    while True:
+        if offset + 2 > len(data):
+            raise Exception("Bad data length, presence bitmap not terminated")
+        byte = int(data[offset:offset + 2], 16)
+        offset += 2
+        bitmap |= (byte & ~BITMAP_MORE) << shift
+        shift += BITMAP_FIELDS
+        if not byte & BITMAP_MORE:
+            return bitmap, offset
+
+
+def decode_batch(data, offset=2):
+    """Windows of a batch frame, oldest first, the last one ends at the time of the uplink."""
+    count = int(data[offset:offset + 2], 16)
+    bitmap, offset = decode_bitmap(data, offset + 2)
+    raws = []
+
+    for index in range(count):
+        raw = {}
+        for i, (name, width, _, _, _) in enumerate(fields):
+            if not bitmap & (1 << i):
+                continue
+            if index > 0:
+                delta = int(data[offset:offset + 2], 16)
+                offset += 2
+                if delta != BATCH_ESCAPE:
+                    if raws[-1][name] is None:
+                        raise Exception("Bad data, delta of %s to a missing value" % name)
+                    raw[name] = raws[-1][name] + (delta - 256 if delta > 127 else delta)
+                    continue
+            value = int(data[offset:offset + width * 2], 16)
+            offset += width * 2
+            if value == (1 << (width * 8)) - 1:
+                value = None
+            else:
+                value = decode_signed(name, value)
+            raw[name] = value
+        raws.append(raw)
+
+    if offset != len(data):
+        raise Exception("Bad data length, %d characters expected" % offset)
+
+    records = []
+    for raw in raws:
+        record = {}
+        for name, width, _, _, _ in fields:
+            value = raw.get(name)
+            record[name] = decode_field(name, value & ((1 << (width * 8)) - 1)) if value is not None else None
+        records.append(record)
+
+    return records
+
 
 def decode(data):
-    if len(data) != 32:
-        raise Exception("Bad data length, 32 characters expected")
+    if len(data) < 2:
+        raise Exception("Bad data length, at least 2 characters expected")
 
     header = int(data[0:2], 16)
+    result = {"header": header_lut[header & ~(HEADER_COMPACT | HEADER_BATCH)]}
+
+    if header & HEADER_BATCH and header & ~(HEADER_COMPACT | HEADER_BATCH) == HEADER_BACKFILL:
+        # Stored windows, sequence number of the first one and windows closed since it
+        result["sequence"] = int(data[2:6], 16)
+        result["age"] = int(data[6:10], 16)
+        result["records"] = decode_batch(data, 10)
+        return result
+
+    if header & HEADER_BATCH:
+        result["records"] = decode_batch(data)
+        return result
+
+    if header & HEADER_COMPACT:
+        if len(data) < 4:
+            raise Exception("Bad data length, compact payload without presence bitmap")
+
+        bitmap, offset = decode_bitmap(data, 2)
+
+        for i, (name, width, _, _, _) in enumerate(fields):
+            if bitmap & (1 << i):
+                result[name] = decode_field(name, int(data[offset:offset + width * 2], 16))
+                offset += width * 2
+            else:
+                result[name] = None
+
+        if offset != len(data):
+            raise Exception("Bad data length, %d characters expected" % offset)
 
-    print(data[8:10])
+        return result
 
-    temperature = int(data[4:8], 16) if data[6:10] != 'ffff' else None
+    if len(data) != 32:
+        raise Exception("Bad data length, 32 characters expected")
 
-    if temperature:
-        if temperature > 32768:
-            temperature -= 65536
-        temperature /= 10.0
+    offset = 2
 
-    return {
-        "header": header_lut[header],
-        "voltage": int(data[2:4], 16) / 10.0 if data[2:4] != 'ff' else None,
-        "temperature": temperature,
-        "humidity": int(data[8:10], 16) / 2.0 if data[8:10] != 'ff' else None,
-        "pressure": int(data[14:18], 16) * 2 if data[14:18] != 'ffff' else None,
-        "voc": int(data[10:14], 16) if data[10:14] != 'ffff' else None,
-        "co2": int(data[18:22], 16) if data[18:22] != 'ffff' else None
-    }
+    for name, width, _, _, _ in fields:
+        chunk = data[offset:offset + width * 2]
+        result[name] = decode_field(name, int(chunk, 16)) if chunk != 'f' * width * 2 else None
+        offset += width * 2
+
+    return result
 
 
 def pprint(data):
     print('Header :', data['header'])
+
+    if 'sequence' in data:
+        print('Sequence :', data['sequence'])
+        print('Age :', data['age'])
+
+    for index, record in enumerate(data.get('records', [])):
+        print('Record %d :' % index, ', '.join('%s %s' % (name, record[name]) for name, _, _, _, _ in fields))
+
+    if 'records' in data:
+        return
+
     print('Voltage :', data['voltage'])
+    print('Voltage idle :', data['voltage_idle'])
     print('Temperature :', data['temperature'])
     print('Humidity :', data['humidity'])
+    if data['temperature_2'] is not None or data['humidity_2'] is not None:
+        print('Temperature 2 :', data['temperature_2'])
+        print('Humidity 2 :', data['humidity_2'])
     print('Pressure :', data['pressure'])
     print('VOC :', data['voc'])
     print('CO2 :', data['co2'])
@@ -55,6 +192,7 @@ if __name__ == '__main__':
     if len(sys.argv) != 2 or sys.argv[1] in ('help', '-h', '--help'):
         print("usage: python3 decode.py [data]")
         print("example: python3 decode.py 001E0100F5540070C1BE00000001FFFF")
+        print("example: python3 decode.py 81231E00F50190")
         exit(1)
 
     data = decode(sys.argv[1].lower())
@@ -0,0 +1,126 @@
+#ifndef _DECODER_H
+#define _DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sensor.h>
+
+// Decoder of the uplink payloads for the backend side, mirrors the layouts of src/payload.h
+// without depending on the SDK. The fields are expanded from SENSOR_TABLE of the firmware.
+// Nothing is allocated, a frame is decoded into a caller owned decoder_frame_t and formatted
+// into a caller owned buffer.
+
+// Header flags of the compact and batch layouts, the rest of the header byte is the message type
+#define DECODER_HEADER_COMPACT 0x80
+#define DECODER_HEADER_BATCH 0x40
+
+#define DECODER_FIXED_LENGTH 16
+
+#define DECODER_BATCH_ESCAPE 0x80
+
+// Presence bitmap, 7 fields per byte, bit 7 announces another byte
+#define DECODER_BITMAP_FIELDS 7
+#define DECODER_BITMAP_MORE 0x80
+
+// Record count of a batch frame is a single byte
+#define DECODER_RECORD_MAX 255
+
+// Longest output of one record without the key, also covers the frame prefix of the JSON object
+#define DECODER_RECORD_OUTPUT_MAX 192
+
+// Room the formatters need for a frame of count records and a key of key_length characters
+#define DECODER_OUTPUT_SIZE(count, key_length) (DECODER_RECORD_OUTPUT_MAX + (count) * (DECODER_RECORD_OUTPUT_MAX + (key_length)) + 2 * (key_length))
+
+typedef enum
+{
+    DECODER_HEADER_BOOT = 0,
+    DECODER_HEADER_UPDATE = 1,
+    DECODER_HEADER_BUTTON_CLICK = 2,
+    DECODER_HEADER_BUTTON_HOLD = 3,
+    DECODER_HEADER_ALARM = 4,
+    DECODER_HEADER_BACKFILL = 5,
+    DECODER_HEADER_DOWNLINK = 6,
+
+    DECODER_HEADER_COUNT
+
+} decoder_header_t;
+
+typedef enum
+{
+    DECODER_LAYOUT_FIXED = 0,
+    DECODER_LAYOUT_COMPACT = 1,
+    DECODER_LAYOUT_BATCH = 2
+
+} decoder_layout_t;
+
+#define _DECODER_FIELD_ID(id, name, label, width, sign, num, den, round, precision) DECODER_FIELD_##id,
+
+// Order of the fields in the frame and bit position in the presence bitmap
+typedef enum
+{
+    SENSOR_TABLE(_DECODER_FIELD_ID)
+
+    DECODER_FIELD_COUNT
+
+} decoder_field_t;
+
+typedef enum
+{
+    DECODER_OK = 0,
+    DECODER_ERROR_EMPTY = 1,
+    DECODER_ERROR_HEADER = 2,
+    DECODER_ERROR_LENGTH = 3,
+    DECODER_ERROR_DELTA = 4,
+    DECODER_ERROR_HEX = 5
+
+} decoder_error_t;
+
+typedef struct
+{
+    decoder_header_t header;
+    decoder_layout_t layout;
+
+    // Only set for backfill frames, sequence number of the first record and windows closed since it
+    bool has_sequence;
+    uint16_t sequence;
+    uint16_t age;
+
+    // Records oldest first, raw wire values and the bitmap of fields with a value
+    //
+    // All ones marks a missing value in the fixed and batch layouts, the compact layout leaves
+    // missing fields out so there all ones is a value (e.g. -0.1 °C).
+    int count;
+    uint16_t raw[DECODER_RECORD_MAX][DECODER_FIELD_COUNT];
+    uint16_t present[DECODER_RECORD_MAX];
+
+} decoder_frame_t;
+
+decoder_error_t decoder_decode(const uint8_t *data, size_t length, decoder_frame_t *frame);
+
+// Convert hex digits of either case to bytes, returns the number of bytes or -1 on an odd length, bad digit or overflow
+int decoder_hex_parse(const char *hex, size_t length, uint8_t *buffer, size_t size);
+
+// True if raw is the all ones wire value of a missing field
+bool decoder_is_missing(decoder_field_t field, uint16_t raw);
+
+const char *decoder_get_header_name(decoder_header_t header);
+
+const char *decoder_get_field_name(decoder_field_t field);
+
+const char *decoder_get_error_name(decoder_error_t error);
+
+// Physical value in the unit of the Python decoder (V, °C, %, ppb, Pa, ppm), returns false when missing
+bool decoder_get_value(const decoder_frame_t *frame, int record, decoder_field_t field, double *value);
+
+// Column names matching decoder_format_csv()
+const char *decoder_get_csv_header(void);
+
+// One CSV line per record terminated by a newline, key is copied verbatim into the first column
+// and may be NULL, returns the number of characters written or 0 if size is below DECODER_OUTPUT_SIZE()
+size_t decoder_format_csv(const decoder_frame_t *frame, const char *key, size_t key_length, char *buffer, size_t size);
+
+// One JSON object per frame with the keys of decode.py terminated by a newline, returns as decoder_format_csv()
+size_t decoder_format_json(const decoder_frame_t *frame, const char *key, size_t key_length, char *buffer, size_t size);
+
+#endif // _DECODER_H
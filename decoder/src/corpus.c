@@ -0,0 +1,256 @@
+#include <corpus.h>
+#include <payload.h>
+#include <stdio.h>
+
+#define CORPUS_DEVICES_MAX 4096
+
+typedef struct
+{
+    uint64_t eui;
+    float value[PAYLOAD_FIELD_COUNT];
+    bool voc_present;
+    bool barometer_present;
+    bool humidity_2_present;
+    uint16_t sequence;
+
+} corpus_device_t;
+
+// Starting point and random walk step of every field
+static const struct
+{
+    float initial;
+    float step;
+    float min;
+    float max;
+
+} _corpus_walk[PAYLOAD_FIELD_COUNT] = {
+    [PAYLOAD_FIELD_VOLTAGE] = { 3.0f, 0.01f, 2.2f, 3.3f },
+    [PAYLOAD_FIELD_TEMPERATURE] = { 21.0f, 0.4f, -30.0f, 50.0f },
+    [PAYLOAD_FIELD_HUMIDITY] = { 45.0f, 1.0f, 5.0f, 95.0f },
+    [PAYLOAD_FIELD_VOC] = { 150.0f, 30.0f, 0.0f, 4000.0f },
+    [PAYLOAD_FIELD_PRESSURE] = { 98000.0f, 40.0f, 90000.0f, 105000.0f },
+    [PAYLOAD_FIELD_CO2] = { 600.0f, 60.0f, 400.0f, 5000.0f },
+    [PAYLOAD_FIELD_VOLTAGE_IDLE] = { 3.1f, 0.01f, 2.3f, 3.3f },
+    [PAYLOAD_FIELD_TEMPERATURE_2] = { 18.0f, 0.4f, -30.0f, 50.0f },
+    [PAYLOAD_FIELD_HUMIDITY_2] = { 55.0f, 1.0f, 5.0f, 95.0f },
+};
+
+static struct
+{
+    uint32_t state;
+    int devices;
+    corpus_device_t device[CORPUS_DEVICES_MAX];
+
+} _corpus;
+
+static uint32_t _corpus_random(void)
+{
+    // xorshift32
+    _corpus.state ^= _corpus.state << 13;
+    _corpus.state ^= _corpus.state >> 17;
+    _corpus.state ^= _corpus.state << 5;
+
+    return _corpus.state;
+}
+
+static float _corpus_uniform(float min, float max)
+{
+    return min + (max - min) * (_corpus_random() >> 8) / 16777216.f;
+}
+
+void corpus_init(uint32_t seed, int devices)
+{
+    _corpus.state = seed != 0 ? seed : 1;
+    _corpus.devices = devices < 1 ? 1 : devices > CORPUS_DEVICES_MAX ? CORPUS_DEVICES_MAX : devices;
+
+    for (int i = 0; i < _corpus.devices; i++)
+    {
+        corpus_device_t *device = &_corpus.device[i];
+
+        device->eui = 0x70b3d57ed0000000ULL | i;
+        device->voc_present = _corpus_random() % 4 != 0;
+        device->barometer_present = _corpus_random() % 2 != 0;
+        device->humidity_2_present = _corpus_random() % 4 == 0;
+        device->sequence = _corpus_random();
+
+        for (int j = 0; j < PAYLOAD_FIELD_COUNT; j++)
+        {
+            device->value[j] = _corpus_walk[j].initial;
+        }
+    }
+}
+
+// Window statistics of one device after the next random walk step, occasionally with a jump or a failed sensor
+static void _corpus_window(corpus_device_t *device, aggregate_t aggregates[PAYLOAD_FIELD_COUNT])
+{
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        float step = _corpus_walk[i].step * (_corpus_random() % 32 == 0 ? 40.f : 1.f);
+        float value = device->value[i] + _corpus_uniform(-step, step);
+
+        if (value < _corpus_walk[i].min || value > _corpus_walk[i].max)
+        {
+            value = _corpus_walk[i].initial;
+        }
+
+        device->value[i] = value;
+
+        aggregate_reset(&aggregates[i]);
+
+        if ((i == PAYLOAD_FIELD_VOC && !device->voc_present) || (i == PAYLOAD_FIELD_PRESSURE && !device->barometer_present) ||
+            ((i == PAYLOAD_FIELD_TEMPERATURE_2 || i == PAYLOAD_FIELD_HUMIDITY_2) && !device->humidity_2_present))
+        {
+            continue;
+        }
+
+        if (_corpus_random() % 64 == 0)
+        {
+            continue;
+        }
+
+        aggregate_feed(&aggregates[i], payload_field_quantize(i, value));
+    }
+}
+
+void corpus_next(corpus_frame_t *frame)
+{
+    corpus_device_t *device = &_corpus.device[_corpus_random() % _corpus.devices];
+    aggregate_t aggregates[PAYLOAD_FIELD_COUNT];
+    aggregate_t *pointers[PAYLOAD_FIELD_COUNT];
+    decoder_frame_t *expected = &frame->expected;
+    uint32_t kind = _corpus_random() % 100;
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        pointers[i] = &aggregates[i];
+    }
+
+    frame->device = device->eui;
+
+    expected->header = kind < 90 ? DECODER_HEADER_UPDATE : DECODER_HEADER_BOOT + kind % 5;
+    expected->has_sequence = false;
+
+    // Mix of the three formats, batches of 1 to 8 windows and backfill frames of 8
+    if (kind < 60)
+    {
+        payload_format_t format = kind < 20 ? PAYLOAD_FORMAT_FIXED : PAYLOAD_FORMAT_COMPACT;
+
+        _corpus_window(device, aggregates);
+
+        frame->length = payload_encode(format, expected->header, pointers, frame->data, sizeof(frame->data));
+
+        expected->layout = format == PAYLOAD_FORMAT_FIXED ? DECODER_LAYOUT_FIXED : DECODER_LAYOUT_COMPACT;
+        expected->count = 1;
+
+        payload_window_raw(pointers, expected->raw[0]);
+
+        // Presence is told by the bitmap of the compact layout and by the all ones value of the fixed one
+        expected->present[0] = 0;
+
+        for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+        {
+            if (format == PAYLOAD_FORMAT_FIXED ? !decoder_is_missing(i, expected->raw[0][i]) : aggregate_get_count(&aggregates[i]) > 0)
+            {
+                expected->present[0] |= 1 << i;
+            }
+        }
+
+        device->sequence++;
+
+        return;
+    }
+
+    payload_batch_t batch;
+    int count = kind < 95 ? 1 + _corpus_random() % PAYLOAD_BATCH_MAX : PAYLOAD_BATCH_MAX;
+
+    payload_batch_reset(&batch);
+
+    for (int i = 0; i < count; i++)
+    {
+        _corpus_window(device, aggregates);
+
+        payload_window_raw(pointers, expected->raw[i]);
+
+        payload_batch_add_raw(&batch, expected->raw[i]);
+
+        expected->present[i] = 0;
+
+        for (int j = 0; j < PAYLOAD_FIELD_COUNT; j++)
+        {
+            if (!decoder_is_missing(j, expected->raw[i][j]))
+            {
+                expected->present[i] |= 1 << j;
+            }
+        }
+    }
+
+    expected->layout = DECODER_LAYOUT_BATCH;
+
+    if (kind < 95)
+    {
+        frame->length = payload_batch_encode(&batch, expected->header, frame->data, sizeof(frame->data));
+    }
+    else
+    {
+        uint16_t age = count + _corpus_random() % 1000;
+
+        expected->header = DECODER_HEADER_BACKFILL;
+        expected->has_sequence = true;
+        expected->sequence = device->sequence - age;
+        expected->age = age;
+
+        frame->length = payload_backfill_encode(&batch, expected->header, expected->sequence, age, frame->data, sizeof(frame->data));
+    }
+
+    // Windows that did not fit stay in the batch, the firmware sends them in the next frame
+    expected->count = count - payload_batch_get_count(&batch);
+
+    device->sequence += expected->count;
+}
+
+bool corpus_check(const corpus_frame_t *frame, const decoder_frame_t *decoded)
+{
+    const decoder_frame_t *expected = &frame->expected;
+    bool match = decoded->header == expected->header && decoded->layout == expected->layout &&
+                 decoded->has_sequence == expected->has_sequence && decoded->count == expected->count;
+
+    if (match && expected->has_sequence)
+    {
+        match = decoded->sequence == expected->sequence && decoded->age == expected->age;
+    }
+
+    for (int i = 0; match && i < expected->count; i++)
+    {
+        if (decoded->present[i] != expected->present[i])
+        {
+            fprintf(stderr, "corpus: record %d decoded presence %04x, encoded %04x\n", i, decoded->present[i], expected->present[i]);
+
+            match = false;
+        }
+
+        for (int j = 0; j < DECODER_FIELD_COUNT; j++)
+        {
+            if (decoded->raw[i][j] != expected->raw[i][j])
+            {
+                fprintf(stderr, "corpus: record %d %s decoded %u, encoded %u\n",
+                        i, decoder_get_field_name(j), decoded->raw[i][j], expected->raw[i][j]);
+
+                match = false;
+            }
+        }
+    }
+
+    if (!match)
+    {
+        fprintf(stderr, "corpus: mismatch of frame ");
+
+        for (size_t i = 0; i < frame->length; i++)
+        {
+            fprintf(stderr, "%02x", frame->data[i]);
+        }
+
+        fprintf(stderr, "\n");
+    }
+
+    return match;
+}
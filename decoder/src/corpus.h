@@ -0,0 +1,29 @@
+#ifndef _CORPUS_H
+#define _CORPUS_H
+
+#include <decoder.h>
+
+// Synthetic uplinks of a fleet of devices encoded by the firmware payload code (src/payload.c),
+// together with the wire values the decoder has to recover from them
+
+#define CORPUS_FRAME_MAX 51
+
+typedef struct
+{
+    uint64_t device;
+    uint8_t data[CORPUS_FRAME_MAX];
+    size_t length;
+
+    // Expected result of decoder_decode()
+    decoder_frame_t expected;
+
+} corpus_frame_t;
+
+void corpus_init(uint32_t seed, int devices);
+
+void corpus_next(corpus_frame_t *frame);
+
+// Compare a decoded frame with the expected one, returns false and prints the difference if they do not match
+bool corpus_check(const corpus_frame_t *frame, const decoder_frame_t *decoded);
+
+#endif // _CORPUS_H
@@ -0,0 +1,571 @@
+#include <decoder.h>
+#include <string.h>
+
+// Offset of every field in the fixed layout, each one follows the previous field
+#define _DECODER_FIELD_OFFSET(id, name, label, width, sign, num, den, round, precision) \
+    _DECODER_OFFSET_##id, _DECODER_OFFSET_LAST_##id = _DECODER_OFFSET_##id + (width) - 1,
+
+enum
+{
+    _DECODER_OFFSET_HEADER = 0,
+
+    SENSOR_TABLE(_DECODER_FIELD_OFFSET)
+
+    _DECODER_FIXED_USED_LENGTH
+};
+
+_Static_assert(_DECODER_FIXED_USED_LENGTH <= DECODER_FIXED_LENGTH, "fields do not fit the fixed layout");
+
+#define _DECODER_FIELD(id, name, label, width, sign, num, den, round, precision) \
+    [DECODER_FIELD_##id] = { #name, width, _DECODER_OFFSET_##id, sign, num, den },
+
+// Wire format of every field expanded from SENSOR_TABLE, physical value = wire value * den / num
+static const struct
+{
+    const char *name;
+    uint8_t width;
+    uint8_t offset;
+    bool sign;
+    uint8_t num;
+    uint8_t den;
+
+} _decoder_field[DECODER_FIELD_COUNT] = {
+    SENSOR_TABLE(_DECODER_FIELD)
+};
+
+#define _DECODER_CSV_NAME(id, name, label, width, sign, num, den, round, precision) "," #name
+
+static const char *const _decoder_header_name[DECODER_HEADER_COUNT] = {
+    [DECODER_HEADER_BOOT] = "BOOT",
+    [DECODER_HEADER_UPDATE] = "UPDATE",
+    [DECODER_HEADER_BUTTON_CLICK] = "BUTTON_CLICK",
+    [DECODER_HEADER_BUTTON_HOLD] = "BUTTON_HOLD",
+    [DECODER_HEADER_ALARM] = "ALARM",
+    [DECODER_HEADER_BACKFILL] = "BACKFILL",
+    [DECODER_HEADER_DOWNLINK] = "DOWNLINK",
+};
+
+static uint16_t _decoder_field_missing(decoder_field_t field)
+{
+    return _decoder_field[field].width == 1 ? 0xff : 0xffff;
+}
+
+static uint16_t _decoder_read_raw(decoder_field_t field, const uint8_t *data)
+{
+    return _decoder_field[field].width == 1 ? data[0] : (uint16_t) (data[0] << 8 | data[1]);
+}
+
+static int32_t _decoder_field_signed(decoder_field_t field, uint16_t raw)
+{
+    if (!_decoder_field[field].sign)
+    {
+        return raw;
+    }
+
+    return _decoder_field[field].width == 1 ? (int8_t) raw : (int16_t) raw;
+}
+
+// Presence bitmap at data[*offset], bits of fields the decoder does not know are kept so their values fail the length check
+static decoder_error_t _decoder_read_bitmap(const uint8_t *data, size_t length, size_t *offset, uint32_t *bitmap)
+{
+    *bitmap = 0;
+
+    for (int shift = 0; ; shift += DECODER_BITMAP_FIELDS)
+    {
+        if (*offset >= length || shift >= 32)
+        {
+            return DECODER_ERROR_LENGTH;
+        }
+
+        uint8_t byte = data[(*offset)++];
+
+        *bitmap |= (uint32_t) (byte & ~DECODER_BITMAP_MORE) << shift;
+
+        if (!(byte & DECODER_BITMAP_MORE))
+        {
+            return DECODER_OK;
+        }
+    }
+}
+
+// Record count, presence bitmap, the first record with absolute values and the following as deltas
+static decoder_error_t _decoder_decode_batch(const uint8_t *data, size_t length, decoder_frame_t *frame)
+{
+    uint32_t bitmap;
+    size_t offset = 1;
+
+    if (length < 2)
+    {
+        return DECODER_ERROR_LENGTH;
+    }
+
+    decoder_error_t error = _decoder_read_bitmap(data, length, &offset, &bitmap);
+
+    if (error != DECODER_OK)
+    {
+        return error;
+    }
+
+    frame->count = data[0];
+
+    for (int i = 0; i < frame->count; i++)
+    {
+        uint16_t *raw = frame->raw[i];
+
+        frame->present[i] = 0;
+
+        for (int j = 0; j < DECODER_FIELD_COUNT; j++)
+        {
+            if (!(bitmap & (1 << j)))
+            {
+                raw[j] = _decoder_field_missing(j);
+
+                continue;
+            }
+
+            if (i > 0)
+            {
+                if (offset >= length)
+                {
+                    return DECODER_ERROR_LENGTH;
+                }
+
+                uint8_t delta = data[offset++];
+
+                if (delta != DECODER_BATCH_ESCAPE)
+                {
+                    uint16_t previous = frame->raw[i - 1][j];
+
+                    if (previous == _decoder_field_missing(j))
+                    {
+                        return DECODER_ERROR_DELTA;
+                    }
+
+                    raw[j] = (uint16_t) (previous + (int8_t) delta) & _decoder_field_missing(j);
+
+                    continue;
+                }
+            }
+
+            if (offset + _decoder_field[j].width > length)
+            {
+                return DECODER_ERROR_LENGTH;
+            }
+
+            raw[j] = _decoder_read_raw(j, data + offset);
+
+            offset += _decoder_field[j].width;
+        }
+
+        for (int j = 0; j < DECODER_FIELD_COUNT; j++)
+        {
+            if (raw[j] != _decoder_field_missing(j))
+            {
+                frame->present[i] |= 1 << j;
+            }
+        }
+    }
+
+    return offset == length ? DECODER_OK : DECODER_ERROR_LENGTH;
+}
+
+decoder_error_t decoder_decode(const uint8_t *data, size_t length, decoder_frame_t *frame)
+{
+    if (length == 0)
+    {
+        return DECODER_ERROR_EMPTY;
+    }
+
+    uint8_t header = data[0] & ~(DECODER_HEADER_COMPACT | DECODER_HEADER_BATCH);
+
+    if (header >= DECODER_HEADER_COUNT)
+    {
+        return DECODER_ERROR_HEADER;
+    }
+
+    frame->header = header;
+    frame->has_sequence = false;
+
+    if (data[0] & DECODER_HEADER_BATCH)
+    {
+        frame->layout = DECODER_LAYOUT_BATCH;
+
+        if (header != DECODER_HEADER_BACKFILL)
+        {
+            return _decoder_decode_batch(data + 1, length - 1, frame);
+        }
+
+        if (length < 5)
+        {
+            return DECODER_ERROR_LENGTH;
+        }
+
+        frame->has_sequence = true;
+        frame->sequence = data[1] << 8 | data[2];
+        frame->age = data[3] << 8 | data[4];
+
+        return _decoder_decode_batch(data + 5, length - 5, frame);
+    }
+
+    frame->count = 1;
+
+    uint16_t *raw = frame->raw[0];
+
+    if (data[0] & DECODER_HEADER_COMPACT)
+    {
+        frame->layout = DECODER_LAYOUT_COMPACT;
+
+        uint32_t bitmap;
+        size_t offset = 1;
+        decoder_error_t error = _decoder_read_bitmap(data, length, &offset, &bitmap);
+
+        if (error != DECODER_OK)
+        {
+            return error;
+        }
+
+        frame->present[0] = bitmap & ((1 << DECODER_FIELD_COUNT) - 1);
+
+        for (int i = 0; i < DECODER_FIELD_COUNT; i++)
+        {
+            if (!(bitmap & (1 << i)))
+            {
+                raw[i] = _decoder_field_missing(i);
+
+                continue;
+            }
+
+            if (offset + _decoder_field[i].width > length)
+            {
+                return DECODER_ERROR_LENGTH;
+            }
+
+            raw[i] = _decoder_read_raw(i, data + offset);
+
+            offset += _decoder_field[i].width;
+        }
+
+        return offset == length ? DECODER_OK : DECODER_ERROR_LENGTH;
+    }
+
+    frame->layout = DECODER_LAYOUT_FIXED;
+
+    if (length != DECODER_FIXED_LENGTH)
+    {
+        return DECODER_ERROR_LENGTH;
+    }
+
+    frame->present[0] = 0;
+
+    for (int i = 0; i < DECODER_FIELD_COUNT; i++)
+    {
+        raw[i] = _decoder_read_raw(i, data + _decoder_field[i].offset);
+
+        if (raw[i] != _decoder_field_missing(i))
+        {
+            frame->present[0] |= 1 << i;
+        }
+    }
+
+    return DECODER_OK;
+}
+
+static int _decoder_hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    c |= 0x20;
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+int decoder_hex_parse(const char *hex, size_t length, uint8_t *buffer, size_t size)
+{
+    if (length % 2 != 0 || length / 2 > size)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < length / 2; i++)
+    {
+        int high = _decoder_hex_digit(hex[i * 2]);
+        int low = _decoder_hex_digit(hex[i * 2 + 1]);
+
+        if (high < 0 || low < 0)
+        {
+            return -1;
+        }
+
+        buffer[i] = high << 4 | low;
+    }
+
+    return length / 2;
+}
+
+bool decoder_is_missing(decoder_field_t field, uint16_t raw)
+{
+    return raw == _decoder_field_missing(field);
+}
+
+const char *decoder_get_header_name(decoder_header_t header)
+{
+    return header < DECODER_HEADER_COUNT ? _decoder_header_name[header] : "";
+}
+
+const char *decoder_get_field_name(decoder_field_t field)
+{
+    return field < DECODER_FIELD_COUNT ? _decoder_field[field].name : "";
+}
+
+const char *decoder_get_error_name(decoder_error_t error)
+{
+    switch (error)
+    {
+        case DECODER_OK:
+            return "ok";
+        case DECODER_ERROR_EMPTY:
+            return "empty frame";
+        case DECODER_ERROR_HEADER:
+            return "unknown header";
+        case DECODER_ERROR_LENGTH:
+            return "bad length";
+        case DECODER_ERROR_DELTA:
+            return "delta to a missing value";
+        case DECODER_ERROR_HEX:
+            return "bad hex";
+        default:
+            return "unknown error";
+    }
+}
+
+bool decoder_get_value(const decoder_frame_t *frame, int record, decoder_field_t field, double *value)
+{
+    if (record < 0 || record >= frame->count || field >= DECODER_FIELD_COUNT || !(frame->present[record] & (1 << field)))
+    {
+        return false;
+    }
+
+    *value = (double) _decoder_field_signed(field, frame->raw[record][field]) * _decoder_field[field].den / _decoder_field[field].num;
+
+    return true;
+}
+
+const char *decoder_get_csv_header(void)
+{
+    return "key,header,sequence,age,record" SENSOR_TABLE(_DECODER_CSV_NAME) "\n";
+}
+
+// The formatters below print the scaled values with integer arithmetic, snprintf() of doubles
+// costs more than the decoding of the whole frame
+
+static char *_decoder_put_string(char *p, const char *string)
+{
+    while (*string != '\0')
+    {
+        *p++ = *string++;
+    }
+
+    return p;
+}
+
+static char *_decoder_put_uint(char *p, uint32_t value)
+{
+    char digits[10];
+    int length = 0;
+
+    do
+    {
+        digits[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (length > 0)
+    {
+        *p++ = digits[--length];
+    }
+
+    return p;
+}
+
+// Value in the unit of decoder_get_value() with one decimal for the scaled fields, exact for num of 1, 2, 5
+// and 10, the caller handles missing values
+static char *_decoder_put_value(char *p, decoder_field_t field, uint16_t raw)
+{
+    int32_t value = _decoder_field_signed(field, raw) * _decoder_field[field].den;
+    uint8_t num = _decoder_field[field].num;
+
+    if (value < 0)
+    {
+        *p++ = '-';
+        value = -value;
+    }
+
+    p = _decoder_put_uint(p, value / num);
+
+    if (num > 1)
+    {
+        *p++ = '.';
+        *p++ = '0' + value % num * 10 / num;
+    }
+
+    return p;
+}
+
+size_t decoder_format_csv(const decoder_frame_t *frame, const char *key, size_t key_length, char *buffer, size_t size)
+{
+    if (size < DECODER_OUTPUT_SIZE(frame->count, key_length))
+    {
+        return 0;
+    }
+
+    const char *header = _decoder_header_name[frame->header];
+    char *p = buffer;
+
+    for (int i = 0; i < frame->count; i++)
+    {
+        if (key != NULL)
+        {
+            memcpy(p, key, key_length);
+            p += key_length;
+        }
+
+        *p++ = ',';
+        p = _decoder_put_string(p, header);
+        *p++ = ',';
+
+        // Backfill records carry their own sequence number and the windows closed since them
+        if (frame->has_sequence)
+        {
+            p = _decoder_put_uint(p, (uint16_t) (frame->sequence + i));
+            *p++ = ',';
+            p = _decoder_put_uint(p, frame->age >= i ? frame->age - i : 0);
+        }
+        else
+        {
+            *p++ = ',';
+        }
+
+        *p++ = ',';
+        p = _decoder_put_uint(p, i);
+
+        for (int j = 0; j < DECODER_FIELD_COUNT; j++)
+        {
+            *p++ = ',';
+
+            if (frame->present[i] & (1 << j))
+            {
+                p = _decoder_put_value(p, j, frame->raw[i][j]);
+            }
+        }
+
+        *p++ = '\n';
+    }
+
+    return p - buffer;
+}
+
+static char *_decoder_put_json_record(char *p, const uint16_t raw[DECODER_FIELD_COUNT], uint16_t present)
+{
+    for (int i = 0; i < DECODER_FIELD_COUNT; i++)
+    {
+        *p++ = '"';
+        p = _decoder_put_string(p, _decoder_field[i].name);
+        *p++ = '"';
+        *p++ = ':';
+
+        p = present & (1 << i) ? _decoder_put_value(p, i, raw[i]) : _decoder_put_string(p, "null");
+
+        if (i + 1 < DECODER_FIELD_COUNT)
+        {
+            *p++ = ',';
+        }
+    }
+
+    return p;
+}
+
+size_t decoder_format_json(const decoder_frame_t *frame, const char *key, size_t key_length, char *buffer, size_t size)
+{
+    if (size < DECODER_OUTPUT_SIZE(frame->count, key_length))
+    {
+        return 0;
+    }
+
+    char *p = buffer;
+
+    *p++ = '{';
+
+    if (key != NULL)
+    {
+        p = _decoder_put_string(p, "\"key\":\"");
+
+        // Quotes and backslashes are escaped, control characters dropped
+        for (size_t i = 0; i < key_length; i++)
+        {
+            if ((uint8_t) key[i] < 0x20)
+            {
+                continue;
+            }
+
+            if (key[i] == '"' || key[i] == '\\')
+            {
+                *p++ = '\\';
+            }
+
+            *p++ = key[i];
+        }
+
+        *p++ = '"';
+        *p++ = ',';
+    }
+
+    p = _decoder_put_string(p, "\"header\":\"");
+    p = _decoder_put_string(p, _decoder_header_name[frame->header]);
+    *p++ = '"';
+
+    if (frame->layout != DECODER_LAYOUT_BATCH)
+    {
+        *p++ = ',';
+        p = _decoder_put_json_record(p, frame->raw[0], frame->present[0]);
+        *p++ = '}';
+        *p++ = '\n';
+
+        return p - buffer;
+    }
+
+    if (frame->has_sequence)
+    {
+        p = _decoder_put_string(p, ",\"sequence\":");
+        p = _decoder_put_uint(p, frame->sequence);
+        p = _decoder_put_string(p, ",\"age\":");
+        p = _decoder_put_uint(p, frame->age);
+    }
+
+    p = _decoder_put_string(p, ",\"records\":[");
+
+    for (int i = 0; i < frame->count; i++)
+    {
+        if (i > 0)
+        {
+            *p++ = ',';
+        }
+
+        *p++ = '{';
+        p = _decoder_put_json_record(p, frame->raw[i], frame->present[i]);
+        *p++ = '}';
+    }
+
+    *p++ = ']';
+    *p++ = '}';
+    *p++ = '\n';
+
+    return p - buffer;
+}
@@ -0,0 +1,464 @@
+#include <decoder.h>
+#include <corpus.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Batch decoder of recorded uplinks: reads "[key,]hex" lines or length prefixed binary frames
+// and writes one CSV line per record or one JSON object per frame
+
+#define DECODE_INPUT_SIZE (1024 * 1024)
+#define DECODE_OUTPUT_SIZE (1024 * 1024)
+#define DECODE_KEY_MAX 256
+#define DECODE_BENCH_FRAMES 1000000
+#define DECODE_BENCH_DEVICES 500
+
+typedef enum
+{
+    DECODE_FORMAT_CSV = 0,
+    DECODE_FORMAT_JSON = 1
+
+} decode_format_t;
+
+static struct
+{
+    decode_format_t format;
+    bool binary;
+    bool header;
+
+    // Output is dropped instead of written when NULL, used by the benchmark
+    FILE *stream;
+    char output[DECODE_OUTPUT_SIZE];
+    size_t output_length;
+
+    decoder_frame_t frame;
+
+    unsigned long long line;
+    unsigned long long frames;
+    unsigned long long records;
+    unsigned long long errors;
+
+} _decode = {
+    .format = DECODE_FORMAT_CSV,
+    .header = true
+};
+
+static char _decode_input[DECODE_INPUT_SIZE];
+
+static void _decode_usage(const char *name)
+{
+    printf("usage: %s [options] [FILE]\n", name);
+    printf("Decode uplinks from FILE or standard input, one hex frame per line optionally preceded\n");
+    printf("by a key and a comma, e.g. a device EUI or a timestamp copied to the output.\n");
+    printf("  --json              one JSON object per frame instead of one CSV line per record\n");
+    printf("  --binary            frames as a length byte and the payload instead of hex lines\n");
+    printf("  --no-header         omit the CSV column names\n");
+    printf("  --generate N        write N frames of a simulated fleet as hex lines and exit\n");
+    printf("  --bench [N]         decode N generated frames in memory and report the throughput (default %d)\n", DECODE_BENCH_FRAMES);
+    printf("  --seed N            seed of the generated frames (default 1)\n");
+}
+
+static void _decode_flush(void)
+{
+    if (_decode.stream != NULL && _decode.output_length > 0)
+    {
+        fwrite(_decode.output, 1, _decode.output_length, _decode.stream);
+    }
+
+    _decode.output_length = 0;
+}
+
+static void _decode_error(const char *message)
+{
+    _decode.errors++;
+
+    if (_decode.stream != NULL)
+    {
+        fprintf(stderr, "decode: %s %llu: %s\n", _decode.binary ? "frame" : "line", _decode.line, message);
+    }
+}
+
+static void _decode_frame(const uint8_t *data, size_t length, const char *key, size_t key_length)
+{
+    decoder_error_t error = decoder_decode(data, length, &_decode.frame);
+
+    if (error != DECODER_OK)
+    {
+        _decode_error(decoder_get_error_name(error));
+
+        return;
+    }
+
+    if (DECODE_OUTPUT_SIZE - _decode.output_length < DECODER_OUTPUT_SIZE(_decode.frame.count, key_length))
+    {
+        _decode_flush();
+    }
+
+    char *output = _decode.output + _decode.output_length;
+    size_t size = DECODE_OUTPUT_SIZE - _decode.output_length;
+
+    if (_decode.format == DECODE_FORMAT_JSON)
+    {
+        _decode.output_length += decoder_format_json(&_decode.frame, key, key_length, output, size);
+    }
+    else
+    {
+        _decode.output_length += decoder_format_csv(&_decode.frame, key, key_length, output, size);
+    }
+
+    _decode.frames++;
+    _decode.records += _decode.frame.count;
+}
+
+static void _decode_line(const char *line, size_t length)
+{
+    _decode.line++;
+
+    while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ' || line[length - 1] == '\t'))
+    {
+        length--;
+    }
+
+    if (length == 0 || line[0] == '#')
+    {
+        return;
+    }
+
+    // Everything up to the last comma is the key
+    const char *hex = line + length;
+
+    while (hex > line && hex[-1] != ',')
+    {
+        hex--;
+    }
+
+    size_t key_length = hex > line ? (size_t) (hex - line - 1) : 0;
+
+    if (key_length > DECODE_KEY_MAX)
+    {
+        _decode_error("key too long");
+
+        return;
+    }
+
+    uint8_t data[DECODER_RECORD_MAX];
+    int data_length = decoder_hex_parse(hex, line + length - hex, data, sizeof(data));
+
+    if (data_length < 0)
+    {
+        _decode_error(decoder_get_error_name(DECODER_ERROR_HEX));
+
+        return;
+    }
+
+    _decode_frame(data, data_length, hex > line ? line : NULL, key_length);
+}
+
+// Decode the complete lines of text, returns the length of the unterminated rest
+static size_t _decode_text(const char *text, size_t length)
+{
+    const char *end = text + length;
+    const char *line = text;
+
+    for (;;)
+    {
+        const char *newline = memchr(line, '\n', end - line);
+
+        if (newline == NULL)
+        {
+            return end - line;
+        }
+
+        _decode_line(line, newline - line);
+
+        line = newline + 1;
+    }
+}
+
+static void _decode_text_stream(FILE *file)
+{
+    size_t length = 0;
+
+    for (;;)
+    {
+        size_t read = fread(_decode_input + length, 1, sizeof(_decode_input) - length, file);
+
+        if (read == 0)
+        {
+            break;
+        }
+
+        length += read;
+
+        size_t rest = _decode_text(_decode_input, length);
+
+        if (rest == sizeof(_decode_input))
+        {
+            _decode.line++;
+            _decode_error("line too long");
+
+            // Skip to the end of the line
+            int c;
+
+            while ((c = fgetc(file)) != EOF && c != '\n')
+            {
+            }
+
+            rest = 0;
+        }
+
+        memmove(_decode_input, _decode_input + length - rest, rest);
+
+        length = rest;
+    }
+
+    if (length > 0)
+    {
+        _decode_line(_decode_input, length);
+    }
+}
+
+static void _decode_binary_stream(FILE *file)
+{
+    uint8_t data[256];
+    int length;
+
+    while ((length = fgetc(file)) != EOF)
+    {
+        _decode.line++;
+
+        if (fread(data, 1, length, file) != (size_t) length)
+        {
+            _decode_error("truncated frame");
+
+            break;
+        }
+
+        _decode_frame(data, length, NULL, 0);
+    }
+}
+
+static void _decode_begin(void)
+{
+    if (_decode.header && _decode.format == DECODE_FORMAT_CSV)
+    {
+        strcpy(_decode.output, decoder_get_csv_header());
+
+        _decode.output_length = strlen(_decode.output);
+    }
+}
+
+static size_t _decode_put_corpus_line(const corpus_frame_t *frame, char *buffer)
+{
+    static const char digits[] = "0123456789abcdef";
+    char *p = buffer;
+
+    for (int i = 60; i >= 0; i -= 4)
+    {
+        *p++ = digits[(frame->device >> i) & 0xf];
+    }
+
+    *p++ = ',';
+
+    for (size_t i = 0; i < frame->length; i++)
+    {
+        *p++ = digits[frame->data[i] >> 4];
+        *p++ = digits[frame->data[i] & 0xf];
+    }
+
+    *p++ = '\n';
+
+    return p - buffer;
+}
+
+static int _decode_generate(unsigned long long frames)
+{
+    corpus_frame_t frame;
+    size_t length = 0;
+
+    for (unsigned long long i = 0; i < frames; i++)
+    {
+        corpus_next(&frame);
+
+        if (sizeof(_decode_input) - length < 16 + 1 + CORPUS_FRAME_MAX * 2 + 1)
+        {
+            fwrite(_decode_input, 1, length, stdout);
+
+            length = 0;
+        }
+
+        length += _decode_put_corpus_line(&frame, _decode_input + length);
+    }
+
+    fwrite(_decode_input, 1, length, stdout);
+
+    return 0;
+}
+
+static double _decode_elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Generated corpus held in memory as text, every frame is checked against the encoder input first
+static int _decode_bench(unsigned long long frames)
+{
+    size_t size = frames * (16 + 1 + CORPUS_FRAME_MAX * 2 + 1);
+    char *corpus = malloc(size);
+
+    if (corpus == NULL)
+    {
+        fprintf(stderr, "decode: cannot allocate %zu B for the corpus\n", size);
+
+        return 1;
+    }
+
+    corpus_frame_t frame;
+    decoder_frame_t decoded;
+    size_t length = 0;
+
+    for (unsigned long long i = 0; i < frames; i++)
+    {
+        corpus_next(&frame);
+
+        if (decoder_decode(frame.data, frame.length, &decoded) != DECODER_OK || !corpus_check(&frame, &decoded))
+        {
+            free(corpus);
+
+            return 1;
+        }
+
+        length += _decode_put_corpus_line(&frame, corpus + length);
+    }
+
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    _decode.stream = NULL;
+
+    _decode_begin();
+    _decode_text(corpus, length);
+
+    double elapsed = _decode_elapsed(&start);
+
+    free(corpus);
+
+    printf("format          %s\n", _decode.format == DECODE_FORMAT_JSON ? "json" : "csv");
+    printf("input           %.1f MB, %llu frames, %llu records, %llu errors\n", length / 1e6, _decode.frames, _decode.records, _decode.errors);
+    printf("time            %.3f s\n", elapsed);
+    printf("throughput      %.0f records/s, %.0f frames/s, %.1f MB/s\n",
+           _decode.records / elapsed, _decode.frames / elapsed, length / 1e6 / elapsed);
+
+    return _decode.errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    unsigned long long generate = 0;
+    unsigned long long bench = 0;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--json") == 0)
+        {
+            _decode.format = DECODE_FORMAT_JSON;
+        }
+        else if (strcmp(arg, "--binary") == 0)
+        {
+            _decode.binary = true;
+        }
+        else if (strcmp(arg, "--no-header") == 0)
+        {
+            _decode.header = false;
+        }
+        else if (strcmp(arg, "--bench") == 0)
+        {
+            bench = DECODE_BENCH_FRAMES;
+
+            if (value != NULL && value[0] != '-')
+            {
+                bench = strtoull(value, NULL, 10);
+                i++;
+            }
+        }
+        else if (strcmp(arg, "--generate") == 0 && value != NULL)
+        {
+            generate = strtoull(value, NULL, 10);
+            i++;
+        }
+        else if (strcmp(arg, "--seed") == 0 && value != NULL)
+        {
+            seed = strtoul(value, NULL, 10);
+            i++;
+        }
+        else if (arg[0] != '-' || strcmp(arg, "-") == 0)
+        {
+            path = arg;
+        }
+        else
+        {
+            _decode_usage(argv[0]);
+
+            return 1;
+        }
+    }
+
+    if (generate > 0 || bench > 0)
+    {
+        corpus_init(seed, DECODE_BENCH_DEVICES);
+
+        return generate > 0 ? _decode_generate(generate) : _decode_bench(bench);
+    }
+
+    FILE *file = stdin;
+
+    if (path != NULL && strcmp(path, "-") != 0)
+    {
+        file = fopen(path, _decode.binary ? "rb" : "r");
+
+        if (file == NULL)
+        {
+            fprintf(stderr, "decode: cannot open %s\n", path);
+
+            return 1;
+        }
+    }
+
+    _decode.stream = stdout;
+
+    _decode_begin();
+
+    if (_decode.binary)
+    {
+        _decode_binary_stream(file);
+    }
+    else
+    {
+        _decode_text_stream(file);
+    }
+
+    _decode_flush();
+
+    if (file != stdin)
+    {
+        fclose(file);
+    }
+
+    if (_decode.errors > 0)
+    {
+        fprintf(stderr, "decode: %llu frames, %llu records, %llu errors\n", _decode.frames, _decode.records, _decode.errors);
+    }
+
+    return _decode.errors == 0 ? 0 : 1;
+}
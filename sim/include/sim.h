@@ -0,0 +1,204 @@
+#ifndef _SIM_H
+#define _SIM_H
+
+#include <twr.h>
+
+// Control and observation interface of the host simulation, not part of the SDK API
+
+#define SIM_HUMIDITY_TAG_NONE (-1)
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+
+    // Scripted sensor values as a function of virtual time, NAN makes the driver report an error
+    float (*co2_ppm)(twr_tick_t tick);
+    float (*tvoc_ppb)(twr_tick_t tick);
+    // Temperature and humidity at the tag on the given I2C bus
+    float (*temperature)(twr_tick_t tick, twr_i2c_channel_t channel);
+    float (*humidity)(twr_tick_t tick, twr_i2c_channel_t channel);
+    float (*pressure)(twr_tick_t tick);
+    float (*voltage)(twr_tick_t tick);
+    // Drop of the cell voltage under the transmit current of the modem
+    float voltage_tx_drop;
+
+    // Populated hardware
+    bool voc_lp_present;
+    bool barometer_present;
+    int humidity_revision[2];
+
+} sim_scenario_t;
+
+typedef struct
+{
+    twr_tick_t tick;
+    uint8_t port;
+    bool confirmed;
+    uint8_t datarate;
+    twr_tick_t airtime;
+    size_t length;
+    uint8_t data[TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE];
+
+} sim_uplink_t;
+
+typedef struct
+{
+    twr_tick_t tick;
+    uint8_t port;
+    size_t length;
+    uint8_t data[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+
+} sim_downlink_t;
+
+typedef struct
+{
+    uint32_t wakeups;
+    uint32_t dispatches;
+    uint32_t i2c_transactions;
+    uint32_t i2c_errors;
+    uint32_t adc_reads;
+    uint32_t co2_measurements;
+    uint32_t voc_measurements;
+    uint32_t barometer_measurements;
+    uint32_t humidity_measurements;
+    uint32_t uart_bytes;
+    // Console bytes the UART refused, written while an asynchronous write was in progress
+    uint32_t uart_refused;
+    uint32_t uplinks;
+    uint32_t uplinks_confirmed;
+    uint32_t uplink_bytes;
+    uint32_t uplinks_rejected;
+    uint32_t uplinks_lost;
+    uint32_t retransmissions;
+    uint32_t uplink_errors;
+    twr_tick_t airtime;
+    uint32_t eeprom_writes;
+    uint32_t eeprom_bytes;
+    uint32_t eeprom_cycles_max;
+
+} sim_stats_t;
+
+typedef struct
+{
+    twr_tick_t duration;
+    uint8_t datarate;
+    bool verbose;
+    bool uplinks;
+    bool csv;
+
+    // Network outage, uplinks in it are lost and confirmed ones are not acknowledged
+    twr_tick_t outage_start;
+    twr_tick_t outage_end;
+
+    // Uplinks reach the network but their acknowledges are lost
+    twr_tick_t ack_loss_start;
+    twr_tick_t ack_loss_end;
+
+    // Modem fails every send with an error
+    twr_tick_t error_start;
+    twr_tick_t error_end;
+
+    // File holding the EEPROM contents across runs, NULL starts erased
+    const char *eeprom;
+
+    // Console log with AT$STREAM lines to replay, NULL uses the scripted values
+    const char *replay;
+
+} sim_options_t;
+
+// Subsystems of the battery projection
+typedef enum
+{
+    SIM_BATTERY_IDLE = 0,
+    SIM_BATTERY_WAKEUP = 1,
+    SIM_BATTERY_I2C = 2,
+    SIM_BATTERY_ADC = 3,
+    SIM_BATTERY_CO2 = 4,
+    SIM_BATTERY_VOC = 5,
+    SIM_BATTERY_BAROMETER = 6,
+    SIM_BATTERY_HUMIDITY = 7,
+    SIM_BATTERY_CONSOLE = 8,
+    SIM_BATTERY_LORA = 9,
+    SIM_BATTERY_EEPROM = 10,
+    SIM_BATTERY_COUNT
+
+} sim_battery_subsystem_t;
+
+typedef struct
+{
+    double mah_per_day[SIM_BATTERY_COUNT];
+    double total_mah_per_day;
+    double capacity;
+    double days;
+
+} sim_battery_t;
+
+extern sim_stats_t sim_stats;
+
+extern sim_options_t sim_options;
+
+const sim_scenario_t *sim_scenario_get(void);
+
+const sim_scenario_t *sim_scenario_find(const char *name);
+
+void sim_scenario_list(void);
+
+// Replaces the values of the selected scenario by the samples of a recorded AT$STREAM, a sensor
+// returns the sample of its field nearest to the time it is read
+bool sim_scenario_replay(const char *path);
+
+// Set a coefficient of the battery model by name (capacity in mAh, idle and tx in uA, the rest in uC per event)
+bool sim_battery_set(const char *name, double value);
+
+// Sleep, sensor and LoRa coefficients from the AT$ENERGY? output of the firmware, the ones set by
+// sim_battery_set stay
+void sim_battery_read(const char *output);
+
+// Consumption per subsystem from the counts in sim_stats over the simulated duration and the life of the battery
+void sim_battery_project(sim_battery_t *battery);
+
+const char *sim_battery_get_name(sim_battery_subsystem_t subsystem);
+
+void sim_tick_set(twr_tick_t tick);
+
+void sim_scheduler_run(twr_tick_t until);
+
+bool sim_i2c_device_present(twr_i2c_channel_t channel, uint8_t address);
+
+bool sim_i2c_transaction(twr_i2c_channel_t channel, uint8_t address);
+
+// Register contents of the populated devices, identification registers only, zero otherwise
+void sim_i2c_memory_read(twr_i2c_channel_t channel, uint8_t address, uint32_t memory_address, uint8_t *buffer, size_t length);
+
+void sim_uart_write(const char *text, size_t length);
+
+bool sim_atci_execute(const char *line);
+
+void sim_button_event(twr_button_event_t event);
+
+void sim_uplink_record(const sim_uplink_t *uplink);
+
+bool sim_lora_link_up(twr_tick_t tick);
+
+bool sim_lora_modem_up(twr_tick_t tick);
+
+// Acknowledge of an uplink sent at tick reaches the modem
+bool sim_lora_ack_up(twr_tick_t tick);
+
+// The modem sent the last uplink again because its acknowledge did not come
+void sim_retransmission_record(twr_tick_t tick, twr_tick_t airtime);
+
+// Modem is sending the last recorded uplink at tick
+bool sim_lora_transmitting(twr_tick_t tick);
+
+// Oldest downlink queued by the network before tick, delivered in the receive windows of an uplink
+bool sim_downlink_take(twr_tick_t tick, sim_downlink_t *downlink);
+
+bool sim_eeprom_load(const char *path);
+
+bool sim_eeprom_save(const char *path);
+
+twr_tick_t sim_lora_airtime(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length);
+
+#endif // _SIM_H
@@ -0,0 +1,45 @@
+#ifndef _SIM_SENSOR_H
+#define _SIM_SENSOR_H
+
+#include <twr_scheduler.h>
+#include <twr_i2c.h>
+
+// Generic measurement state machine shared by the stand-in sensor drivers
+//
+// A measurement is split into phases separated by conversion delays, every phase is a separate
+// scheduler wakeup issuing a number of bus transactions, the same way the real drivers behave.
+// The first transaction of a measurement fails if the device is absent on the bus.
+
+typedef struct sim_sensor_t sim_sensor_t;
+
+typedef struct
+{
+    const char *name;
+    const twr_tick_t *phase_delay;
+    int phase_count;
+    int transactions_per_phase;
+
+} sim_sensor_profile_t;
+
+struct sim_sensor_t
+{
+    const sim_sensor_profile_t *_profile;
+    twr_i2c_channel_t _i2c_channel;
+    uint8_t _i2c_address;
+    twr_scheduler_task_id_t _task_id_interval;
+    twr_scheduler_task_id_t _task_id_measure;
+    twr_tick_t _update_interval;
+    bool _measurement_active;
+    int _phase;
+    void (*_complete)(sim_sensor_t *, bool);
+    void *_owner;
+
+};
+
+void sim_sensor_init(sim_sensor_t *self, const sim_sensor_profile_t *profile, twr_i2c_channel_t i2c_channel, uint8_t i2c_address, void (*complete)(sim_sensor_t *, bool), void *owner);
+
+void sim_sensor_set_update_interval(sim_sensor_t *self, twr_tick_t interval);
+
+bool sim_sensor_measure(sim_sensor_t *self);
+
+#endif // _SIM_SENSOR_H
@@ -0,0 +1,32 @@
+#ifndef _TWR_H
+#define _TWR_H
+
+// Host stand-in for the HARDWARIO TOWER SDK umbrella header, covering the subset used by the application
+
+#include <twr_common.h>
+#include <twr_tick.h>
+#include <twr_scheduler.h>
+#include <twr_log.h>
+#include <twr_gpio.h>
+#include <twr_i2c.h>
+#include <twr_fifo.h>
+#include <twr_uart.h>
+#include <twr_led.h>
+#include <twr_button.h>
+#include <twr_config.h>
+#include <twr_data_stream.h>
+#include <twr_eeprom.h>
+#include <twr_atci.h>
+#include <twr_cmwx1zzabz.h>
+#include <twr_module_co2.h>
+#include <twr_module_battery.h>
+#include <twr_tag_voc_lp.h>
+#include <twr_tag_humidity.h>
+#include <twr_tag_barometer.h>
+#include <twr_radio_pub.h>
+
+void application_init(void);
+
+void application_task(void);
+
+#endif // _TWR_H
@@ -0,0 +1,43 @@
+#ifndef _TWR_ATCI_H
+#define _TWR_ATCI_H
+
+#include <twr_common.h>
+
+#define TWR_ATCI_COMMANDS_LENGTH(COMMANDS) (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+#define TWR_ATCI_COMMAND_CLAC {"+CLAC", twr_atci_clac_action, NULL, NULL, NULL, "Lists all available AT commands"}
+
+#define TWR_ATCI_COMMAND_HELP {"$HELP", twr_atci_help_action, NULL, NULL, NULL, "This help"}
+
+typedef struct
+{
+    char *txt;
+    size_t length;
+    size_t offset;
+
+} twr_atci_param_t;
+
+typedef struct
+{
+    const char *command;
+    bool (*action)(void);
+    bool (*set)(twr_atci_param_t *param);
+    bool (*read)(void);
+    bool (*help)(void);
+    const char *hint;
+
+} twr_atci_command_t;
+
+void twr_atci_init(const twr_atci_command_t *commands, int length);
+
+void twr_atci_write_ok(void);
+
+void twr_atci_write_error(void);
+
+size_t twr_atci_printf(const char *format, ...);
+
+bool twr_atci_clac_action(void);
+
+bool twr_atci_help_action(void);
+
+#endif // _TWR_ATCI_H
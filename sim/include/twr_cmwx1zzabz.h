@@ -0,0 +1,155 @@
+#ifndef _TWR_CMWX1ZZABZ_H
+#define _TWR_CMWX1ZZABZ_H
+
+#include <twr_scheduler.h>
+#include <twr_uart.h>
+
+#define TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE 230
+#define TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE 230
+
+typedef enum
+{
+    TWR_CMWX1ZZABZ_EVENT_READY = 0,
+    TWR_CMWX1ZZABZ_EVENT_ERROR = 1,
+    TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START = 2,
+    TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE = 3,
+    TWR_CMWX1ZZABZ_EVENT_CONFIG_SAVE_DONE = 4,
+    TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS = 5,
+    TWR_CMWX1ZZABZ_EVENT_JOIN_ERROR = 6,
+    TWR_CMWX1ZZABZ_EVENT_MESSAGE_RECEIVED = 7,
+    TWR_CMWX1ZZABZ_EVENT_MESSAGE_RETRANSMISSION = 8,
+    TWR_CMWX1ZZABZ_EVENT_MESSAGE_CONFIRMED = 9,
+    TWR_CMWX1ZZABZ_EVENT_MESSAGE_NOT_CONFIRMED = 10
+
+} twr_cmwx1zzabz_event_t;
+
+typedef enum
+{
+    TWR_CMWX1ZZABZ_CONFIG_BAND_AS923 = 0,
+    TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 = 1,
+    TWR_CMWX1ZZABZ_CONFIG_BAND_EU868 = 5,
+    TWR_CMWX1ZZABZ_CONFIG_BAND_KR920 = 6,
+    TWR_CMWX1ZZABZ_CONFIG_BAND_IN865 = 7,
+    TWR_CMWX1ZZABZ_CONFIG_BAND_US915 = 8
+
+} twr_cmwx1zzabz_config_band_t;
+
+typedef enum
+{
+    TWR_CMWX1ZZABZ_CONFIG_MODE_ABP = 0,
+    TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA = 1
+
+} twr_cmwx1zzabz_config_mode_t;
+
+typedef enum
+{
+    TWR_CMWX1ZZABZ_CONFIG_CLASS_A = 0,
+    TWR_CMWX1ZZABZ_CONFIG_CLASS_C = 2
+
+} twr_cmwx1zzabz_config_class_t;
+
+typedef struct twr_cmwx1zzabz_t twr_cmwx1zzabz_t;
+
+struct twr_cmwx1zzabz_t
+{
+    twr_uart_channel_t _uart_channel;
+    twr_scheduler_task_id_t _task_id;
+    void (*_event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *);
+    void *_event_param;
+    int _state;
+    bool _ready;
+    bool _confirmed;
+    uint8_t _message_buffer[TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE];
+    size_t _message_length;
+    twr_tick_t _message_tick;
+    int _message_retransmissions;
+    uint8_t _message_port;
+    uint8_t _received_buffer[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+    size_t _received_length;
+    uint8_t _received_port;
+    twr_cmwx1zzabz_config_band_t _band;
+    twr_cmwx1zzabz_config_mode_t _mode;
+    twr_cmwx1zzabz_config_class_t _class;
+    uint8_t _nwk_public;
+    uint8_t _datarate;
+    bool _adaptive_datarate;
+    char _deveui[16 + 1];
+    char _devaddr[8 + 1];
+    char _nwkskey[32 + 1];
+    char _appskey[32 + 1];
+    char _appkey[32 + 1];
+    char _appeui[16 + 1];
+
+};
+
+void twr_cmwx1zzabz_init(twr_cmwx1zzabz_t *self, twr_uart_channel_t uart_channel);
+
+void twr_cmwx1zzabz_set_event_handler(twr_cmwx1zzabz_t *self, void (*event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *), void *event_param);
+
+bool twr_cmwx1zzabz_is_ready(twr_cmwx1zzabz_t *self);
+
+bool twr_cmwx1zzabz_send_message(twr_cmwx1zzabz_t *self, const void *buffer, size_t length);
+
+bool twr_cmwx1zzabz_send_message_confirmed(twr_cmwx1zzabz_t *self, const void *buffer, size_t length);
+
+uint32_t twr_cmwx1zzabz_get_received_message_length(twr_cmwx1zzabz_t *self);
+
+uint8_t twr_cmwx1zzabz_get_received_message_port(twr_cmwx1zzabz_t *self);
+
+uint32_t twr_cmwx1zzabz_get_received_message_data(twr_cmwx1zzabz_t *self, uint8_t *buffer, uint32_t buffer_size);
+
+void twr_cmwx1zzabz_set_port(twr_cmwx1zzabz_t *self, uint8_t port);
+
+uint8_t twr_cmwx1zzabz_get_port(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_deveui(twr_cmwx1zzabz_t *self, const char *deveui);
+
+void twr_cmwx1zzabz_get_deveui(twr_cmwx1zzabz_t *self, char *deveui);
+
+void twr_cmwx1zzabz_set_devaddr(twr_cmwx1zzabz_t *self, const char *devaddr);
+
+void twr_cmwx1zzabz_get_devaddr(twr_cmwx1zzabz_t *self, char *devaddr);
+
+void twr_cmwx1zzabz_set_nwkskey(twr_cmwx1zzabz_t *self, const char *nwkskey);
+
+void twr_cmwx1zzabz_get_nwkskey(twr_cmwx1zzabz_t *self, char *nwkskey);
+
+void twr_cmwx1zzabz_set_appskey(twr_cmwx1zzabz_t *self, const char *appskey);
+
+void twr_cmwx1zzabz_get_appskey(twr_cmwx1zzabz_t *self, char *appskey);
+
+void twr_cmwx1zzabz_set_appkey(twr_cmwx1zzabz_t *self, const char *appkey);
+
+void twr_cmwx1zzabz_get_appkey(twr_cmwx1zzabz_t *self, char *appkey);
+
+void twr_cmwx1zzabz_set_appeui(twr_cmwx1zzabz_t *self, const char *appeui);
+
+void twr_cmwx1zzabz_get_appeui(twr_cmwx1zzabz_t *self, char *appeui);
+
+void twr_cmwx1zzabz_set_band(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_band_t band);
+
+twr_cmwx1zzabz_config_band_t twr_cmwx1zzabz_get_band(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_mode(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_mode_t mode);
+
+twr_cmwx1zzabz_config_mode_t twr_cmwx1zzabz_get_mode(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_class(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_class_t class);
+
+twr_cmwx1zzabz_config_class_t twr_cmwx1zzabz_get_class(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_nwk_public(twr_cmwx1zzabz_t *self, uint8_t public);
+
+uint8_t twr_cmwx1zzabz_get_nwk_public(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_datarate(twr_cmwx1zzabz_t *self, uint8_t datarate);
+
+uint8_t twr_cmwx1zzabz_get_datarate(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_set_adaptive_datarate(twr_cmwx1zzabz_t *self, bool enable);
+
+bool twr_cmwx1zzabz_get_adaptive_datarate(twr_cmwx1zzabz_t *self);
+
+void twr_cmwx1zzabz_join(twr_cmwx1zzabz_t *self);
+
+#endif // _TWR_CMWX1ZZABZ_H
@@ -0,0 +1,16 @@
+#ifndef _TWR_CONFIG_H
+#define _TWR_CONFIG_H
+
+#include <twr_common.h>
+
+// Application configuration in EEPROM, guarded by a signature, its size and a CRC
+
+void twr_config_init(uint64_t signature, void *config, size_t size, void *init_config);
+
+bool twr_config_load(void);
+
+bool twr_config_save(void);
+
+void twr_config_reset(void);
+
+#endif // _TWR_CONFIG_H
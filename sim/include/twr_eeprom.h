@@ -0,0 +1,16 @@
+#ifndef _TWR_EEPROM_H
+#define _TWR_EEPROM_H
+
+#include <twr_common.h>
+
+// Data EEPROM of the STM32L083, erased bytes read as zero
+
+#define TWR_EEPROM_SIZE 6144
+
+bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length);
+
+bool twr_eeprom_read(uint32_t address, void *buffer, size_t length);
+
+size_t twr_eeprom_get_size(void);
+
+#endif // _TWR_EEPROM_H
@@ -0,0 +1,19 @@
+#ifndef _TWR_FIFO_H
+#define _TWR_FIFO_H
+
+#include <twr_common.h>
+
+// The simulated UART only uses the size of a FIFO, the bytes go straight to the console
+
+typedef struct
+{
+    void *buffer;
+    size_t size;
+    size_t head;
+    size_t tail;
+
+} twr_fifo_t;
+
+void twr_fifo_init(twr_fifo_t *fifo, void *buffer, size_t size);
+
+#endif // _TWR_FIFO_H
@@ -0,0 +1,39 @@
+#ifndef _TWR_GPIO_H
+#define _TWR_GPIO_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_GPIO_P0 = 0,
+    TWR_GPIO_P1 = 1,
+    TWR_GPIO_P2 = 2,
+    TWR_GPIO_P3 = 3,
+    TWR_GPIO_P4 = 4,
+    TWR_GPIO_P5 = 5,
+    TWR_GPIO_P6 = 6,
+    TWR_GPIO_P7 = 7,
+    TWR_GPIO_P8 = 8,
+    TWR_GPIO_P9 = 9,
+    TWR_GPIO_P10 = 10,
+    TWR_GPIO_P11 = 11,
+    TWR_GPIO_P12 = 12,
+    TWR_GPIO_P13 = 13,
+    TWR_GPIO_P14 = 14,
+    TWR_GPIO_P15 = 15,
+    TWR_GPIO_P16 = 16,
+    TWR_GPIO_P17 = 17,
+    TWR_GPIO_LED = 18,
+    TWR_GPIO_BUTTON = 19
+
+} twr_gpio_channel_t;
+
+typedef enum
+{
+    TWR_GPIO_PULL_NONE = 0,
+    TWR_GPIO_PULL_UP = 1,
+    TWR_GPIO_PULL_DOWN = 2
+
+} twr_gpio_pull_t;
+
+#endif // _TWR_GPIO_H
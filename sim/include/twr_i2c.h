@@ -0,0 +1,50 @@
+#ifndef _TWR_I2C_H
+#define _TWR_I2C_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_I2C_I2C0 = 0,
+    TWR_I2C_I2C1 = 1,
+    TWR_I2C_I2C_1W = 2
+
+} twr_i2c_channel_t;
+
+typedef enum
+{
+    TWR_I2C_SPEED_100_KHZ = 100000,
+    TWR_I2C_SPEED_400_KHZ = 400000
+
+} twr_i2c_speed_t;
+
+typedef struct
+{
+    uint8_t device_address;
+    void *buffer;
+    size_t length;
+
+} twr_i2c_transfer_t;
+
+typedef struct
+{
+    uint8_t device_address;
+    uint32_t memory_address;
+    void *buffer;
+    size_t length;
+
+} twr_i2c_memory_transfer_t;
+
+void twr_i2c_init(twr_i2c_channel_t channel, twr_i2c_speed_t speed);
+
+bool twr_i2c_write(twr_i2c_channel_t channel, const twr_i2c_transfer_t *transfer);
+
+bool twr_i2c_read(twr_i2c_channel_t channel, const twr_i2c_transfer_t *transfer);
+
+bool twr_i2c_memory_read(twr_i2c_channel_t channel, const twr_i2c_memory_transfer_t *transfer);
+
+bool twr_i2c_memory_read_8b(twr_i2c_channel_t channel, uint8_t device_address, uint32_t memory_address, uint8_t *data);
+
+bool twr_i2c_memory_read_16b(twr_i2c_channel_t channel, uint8_t device_address, uint32_t memory_address, uint16_t *data);
+
+#endif // _TWR_I2C_H
@@ -0,0 +1,35 @@
+#ifndef _TWR_LED_H
+#define _TWR_LED_H
+
+#include <twr_gpio.h>
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_LED_MODE_TOGGLE = 0,
+    TWR_LED_MODE_OFF = 1,
+    TWR_LED_MODE_ON = 2,
+    TWR_LED_MODE_BLINK = 3,
+    TWR_LED_MODE_BLINK_SLOW = 4,
+    TWR_LED_MODE_BLINK_FAST = 5,
+    TWR_LED_MODE_FLASH = 6
+
+} twr_led_mode_t;
+
+typedef struct
+{
+    twr_gpio_channel_t _channel;
+    twr_led_mode_t _mode;
+    int _blink_count;
+
+} twr_led_t;
+
+void twr_led_init(twr_led_t *self, twr_gpio_channel_t gpio_channel, bool open_drain_output, int idle_state);
+
+void twr_led_set_mode(twr_led_t *self, twr_led_mode_t mode);
+
+void twr_led_blink(twr_led_t *self, int count);
+
+void twr_led_pulse(twr_led_t *self, twr_tick_t duration);
+
+#endif // _TWR_LED_H
@@ -0,0 +1,37 @@
+#ifndef _TWR_LOG_H
+#define _TWR_LOG_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_LOG_LEVEL_DUMP = -1,
+    TWR_LOG_LEVEL_DEBUG = 0,
+    TWR_LOG_LEVEL_INFO = 1,
+    TWR_LOG_LEVEL_WARNING = 2,
+    TWR_LOG_LEVEL_ERROR = 3,
+    TWR_LOG_LEVEL_OFF = 4
+
+} twr_log_level_t;
+
+typedef enum
+{
+    TWR_LOG_TIMESTAMP_OFF = -1,
+    TWR_LOG_TIMESTAMP_ABS = 0,
+    TWR_LOG_TIMESTAMP_REL = 1
+
+} twr_log_timestamp_t;
+
+void twr_log_init(twr_log_level_t level, twr_log_timestamp_t timestamp);
+
+void twr_log_dump(const void *buffer, size_t length, const char *format, ...);
+
+void twr_log_debug(const char *format, ...);
+
+void twr_log_info(const char *format, ...);
+
+void twr_log_warning(const char *format, ...);
+
+void twr_log_error(const char *format, ...);
+
+#endif // _TWR_LOG_H
@@ -0,0 +1,23 @@
+#ifndef _TWR_LP8_H
+#define _TWR_LP8_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_LP8_CALIBRATION_ABC = 0x70,
+    TWR_LP8_CALIBRATION_ABC_RESET = 0x72,
+    TWR_LP8_CALIBRATION_BACKGROUND_FILTERED = 0x50,
+    TWR_LP8_CALIBRATION_BACKGROUND_UNFILTERED = 0x51
+
+} twr_lp8_calibration_t;
+
+typedef enum
+{
+    TWR_LP8_ERROR_INITIALIZE = 0,
+    TWR_LP8_ERROR_CHARGE_CHARGE_ENABLE = 1,
+    TWR_LP8_ERROR_MODBUS_TIMEOUT = 19
+
+} twr_lp8_error_t;
+
+#endif // _TWR_LP8_H
@@ -0,0 +1,27 @@
+#ifndef _TWR_MODULE_BATTERY_H
+#define _TWR_MODULE_BATTERY_H
+
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_MODULE_BATTERY_EVENT_LEVEL_LOW = 0,
+    TWR_MODULE_BATTERY_EVENT_LEVEL_CRITICAL = 1,
+    TWR_MODULE_BATTERY_EVENT_UPDATE = 2,
+    TWR_MODULE_BATTERY_EVENT_ERROR = 3
+
+} twr_module_battery_event_t;
+
+void twr_module_battery_init(void);
+
+void twr_module_battery_set_event_handler(void (*event_handler)(twr_module_battery_event_t, void *), void *event_param);
+
+void twr_module_battery_set_update_interval(twr_tick_t interval);
+
+bool twr_module_battery_measure(void);
+
+bool twr_module_battery_get_voltage(float *voltage);
+
+bool twr_module_battery_get_charge_level(int *percentage);
+
+#endif // _TWR_MODULE_BATTERY_H
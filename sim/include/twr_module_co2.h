@@ -0,0 +1,28 @@
+#ifndef _TWR_MODULE_CO2_H
+#define _TWR_MODULE_CO2_H
+
+#include <twr_lp8.h>
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_MODULE_CO2_EVENT_ERROR = 0,
+    TWR_MODULE_CO2_EVENT_UPDATE = 1
+
+} twr_module_co2_event_t;
+
+void twr_module_co2_init(void);
+
+void twr_module_co2_set_event_handler(void (*event_handler)(twr_module_co2_event_t, void *), void *event_param);
+
+void twr_module_co2_set_update_interval(twr_tick_t interval);
+
+bool twr_module_co2_measure(void);
+
+bool twr_module_co2_get_concentration_ppm(float *ppm);
+
+bool twr_module_co2_get_error(twr_lp8_error_t *error);
+
+void twr_module_co2_calibration(twr_lp8_calibration_t calibration);
+
+#endif // _TWR_MODULE_CO2_H
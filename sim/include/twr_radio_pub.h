@@ -0,0 +1,23 @@
+#ifndef _TWR_RADIO_PUB_H
+#define _TWR_RADIO_PUB_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT = 0x00,
+    TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_ALTERNATE = 0x01,
+    TWR_RADIO_PUB_CHANNEL_R2_I2C0_ADDRESS_DEFAULT = 0x02,
+    TWR_RADIO_PUB_CHANNEL_R2_I2C0_ADDRESS_ALTERNATE = 0x03,
+    TWR_RADIO_PUB_CHANNEL_R3_I2C0_ADDRESS_DEFAULT = 0x04,
+    TWR_RADIO_PUB_CHANNEL_R3_I2C0_ADDRESS_ALTERNATE = 0x05,
+    TWR_RADIO_PUB_CHANNEL_R1_I2C1_ADDRESS_DEFAULT = 0x80,
+    TWR_RADIO_PUB_CHANNEL_R1_I2C1_ADDRESS_ALTERNATE = 0x81,
+    TWR_RADIO_PUB_CHANNEL_R2_I2C1_ADDRESS_DEFAULT = 0x82,
+    TWR_RADIO_PUB_CHANNEL_R2_I2C1_ADDRESS_ALTERNATE = 0x83,
+    TWR_RADIO_PUB_CHANNEL_R3_I2C1_ADDRESS_DEFAULT = 0x84,
+    TWR_RADIO_PUB_CHANNEL_R3_I2C1_ADDRESS_ALTERNATE = 0x85
+
+} twr_radio_pub_channel_t;
+
+#endif // _TWR_RADIO_PUB_H
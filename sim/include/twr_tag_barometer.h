@@ -0,0 +1,36 @@
+#ifndef _TWR_TAG_BAROMETER_H
+#define _TWR_TAG_BAROMETER_H
+
+#include <sim_sensor.h>
+
+#define TWR_TAG_BAROMETER_I2C_ADDRESS_DEFAULT 0x60
+
+typedef enum
+{
+    TWR_TAG_BAROMETER_EVENT_ERROR = 0,
+    TWR_TAG_BAROMETER_EVENT_UPDATE = 1
+
+} twr_tag_barometer_event_t;
+
+typedef struct twr_tag_barometer_t twr_tag_barometer_t;
+
+struct twr_tag_barometer_t
+{
+    sim_sensor_t _sensor;
+    void (*_event_handler)(twr_tag_barometer_t *, twr_tag_barometer_event_t, void *);
+    void *_event_param;
+    float _pascal;
+
+};
+
+void twr_tag_barometer_init(twr_tag_barometer_t *self, twr_i2c_channel_t i2c_channel);
+
+void twr_tag_barometer_set_event_handler(twr_tag_barometer_t *self, void (*event_handler)(twr_tag_barometer_t *, twr_tag_barometer_event_t, void *), void *event_param);
+
+void twr_tag_barometer_set_update_interval(twr_tag_barometer_t *self, twr_tick_t interval);
+
+bool twr_tag_barometer_measure(twr_tag_barometer_t *self);
+
+bool twr_tag_barometer_get_pressure_pascal(twr_tag_barometer_t *self, float *pascal);
+
+#endif // _TWR_TAG_BAROMETER_H
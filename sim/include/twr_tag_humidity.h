@@ -0,0 +1,54 @@
+#ifndef _TWR_TAG_HUMIDITY_H
+#define _TWR_TAG_HUMIDITY_H
+
+#include <sim_sensor.h>
+
+typedef enum
+{
+    TWR_TAG_HUMIDITY_REVISION_R1 = 0,
+    TWR_TAG_HUMIDITY_REVISION_R2 = 1,
+    TWR_TAG_HUMIDITY_REVISION_R3 = 2,
+    TWR_TAG_HUMIDITY_REVISION_R4 = 3
+
+} twr_tag_humidity_revision_t;
+
+typedef enum
+{
+    TWR_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT = 0,
+    TWR_TAG_HUMIDITY_I2C_ADDRESS_ALTERNATE = 1
+
+} twr_tag_humidity_i2c_address_t;
+
+typedef enum
+{
+    TWR_TAG_HUMIDITY_EVENT_ERROR = 0,
+    TWR_TAG_HUMIDITY_EVENT_UPDATE = 1
+
+} twr_tag_humidity_event_t;
+
+typedef struct twr_tag_humidity_t twr_tag_humidity_t;
+
+struct twr_tag_humidity_t
+{
+    sim_sensor_t _sensor;
+    twr_tag_humidity_revision_t _revision;
+    void (*_event_handler)(twr_tag_humidity_t *, twr_tag_humidity_event_t, void *);
+    void *_event_param;
+    float _humidity;
+    float _temperature;
+
+};
+
+void twr_tag_humidity_init(twr_tag_humidity_t *self, twr_tag_humidity_revision_t revision, twr_i2c_channel_t i2c_channel, twr_tag_humidity_i2c_address_t i2c_address);
+
+void twr_tag_humidity_set_event_handler(twr_tag_humidity_t *self, void (*event_handler)(twr_tag_humidity_t *, twr_tag_humidity_event_t, void *), void *event_param);
+
+void twr_tag_humidity_set_update_interval(twr_tag_humidity_t *self, twr_tick_t interval);
+
+bool twr_tag_humidity_measure(twr_tag_humidity_t *self);
+
+bool twr_tag_humidity_get_humidity_percentage(twr_tag_humidity_t *self, float *percentage);
+
+bool twr_tag_humidity_get_temperature_celsius(twr_tag_humidity_t *self, float *celsius);
+
+#endif // _TWR_TAG_HUMIDITY_H
@@ -0,0 +1,37 @@
+#ifndef _TWR_TAG_VOC_LP_H
+#define _TWR_TAG_VOC_LP_H
+
+#include <sim_sensor.h>
+
+#define TWR_TAG_VOC_LP_I2C_ADDRESS_DEFAULT 0x59
+
+typedef enum
+{
+    TWR_TAG_VOC_LP_EVENT_ERROR = 0,
+    TWR_TAG_VOC_LP_EVENT_UPDATE = 1
+
+} twr_tag_voc_lp_event_t;
+
+typedef struct twr_tag_voc_lp_t twr_tag_voc_lp_t;
+
+struct twr_tag_voc_lp_t
+{
+    sim_sensor_t _sensor;
+    void (*_event_handler)(twr_tag_voc_lp_t *, twr_tag_voc_lp_event_t, void *);
+    void *_event_param;
+    bool _valid;
+    uint16_t _tvoc;
+
+};
+
+void twr_tag_voc_lp_init(twr_tag_voc_lp_t *self, twr_i2c_channel_t i2c_channel);
+
+void twr_tag_voc_lp_set_event_handler(twr_tag_voc_lp_t *self, void (*event_handler)(twr_tag_voc_lp_t *, twr_tag_voc_lp_event_t, void *), void *event_param);
+
+void twr_tag_voc_lp_set_update_interval(twr_tag_voc_lp_t *self, twr_tick_t interval);
+
+bool twr_tag_voc_lp_measure(twr_tag_voc_lp_t *self);
+
+bool twr_tag_voc_lp_get_tvoc_ppb(twr_tag_voc_lp_t *self, uint16_t *tvoc);
+
+#endif // _TWR_TAG_VOC_LP_H
@@ -0,0 +1,14 @@
+#ifndef _TWR_TICK_H
+#define _TWR_TICK_H
+
+#include <twr_common.h>
+
+#define TWR_TICK_INFINITY ((twr_tick_t) -1)
+
+typedef uint64_t twr_tick_t;
+
+//! @brief Get virtual time in milliseconds since simulation start
+
+twr_tick_t twr_tick_get(void);
+
+#endif // _TWR_TICK_H
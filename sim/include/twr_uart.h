@@ -0,0 +1,25 @@
+#ifndef _TWR_UART_H
+#define _TWR_UART_H
+
+#include <twr_common.h>
+#include <twr_fifo.h>
+
+typedef enum
+{
+    TWR_UART_UART0 = 0,
+    TWR_UART_UART1 = 1,
+    TWR_UART_UART2 = 2
+
+} twr_uart_channel_t;
+
+void twr_uart_set_async_fifo(twr_uart_channel_t channel, twr_fifo_t *write_fifo, twr_fifo_t *read_fifo);
+
+// Blocking write, like the SDK it writes nothing while an asynchronous write is in progress
+size_t twr_uart_write(twr_uart_channel_t channel, const void *buffer, size_t length);
+
+// Puts as much of the buffer into the transmit FIFO as fits and returns the bytes taken, does not wait,
+// takes nothing without a write FIFO like the SDK. A caller trying again at the tick it found the FIFO full
+// spins until it drains, the virtual clock stands still meanwhile
+size_t twr_uart_async_write(twr_uart_channel_t channel, const void *buffer, size_t length);
+
+#endif // _TWR_UART_H
@@ -0,0 +1,1061 @@
+#include <sim.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Host entry point standing in for the SDK main(): runs application_init() and the scheduler on a
+// virtual clock, applies scripted user actions and reports what the firmware did.
+
+#define SIM_MAX_ACTIONS 64
+#define SIM_MAX_DOWNLINKS 16
+#define SIM_MAX_SWEEPS 6
+#define SIM_MAX_SWEEP_VALUES 16
+#define SIM_MAX_EXPECTS 16
+
+typedef enum
+{
+    SIM_ACTION_AT = 0,
+    SIM_ACTION_CLICK = 1,
+    SIM_ACTION_HOLD = 2
+
+} sim_action_type_t;
+
+typedef struct
+{
+    twr_tick_t tick;
+    sim_action_type_t type;
+    const char *command;
+
+} sim_action_t;
+
+sim_stats_t sim_stats;
+
+sim_options_t sim_options = {
+    .duration = 7 * 24 * 60 * 60 * 1000ULL,
+    .datarate = 0
+};
+
+// Values of one swept setting, an interval of AT$INTERVAL in seconds or the data rate
+typedef struct
+{
+    const char *name;
+    long values[SIM_MAX_SWEEP_VALUES];
+    size_t length;
+
+} sim_sweep_t;
+
+// Bound on a value of the summary, checked after the run
+typedef struct
+{
+    char name[32];
+    char relation;
+    double value;
+
+} sim_expect_t;
+
+// Settings a sweep can change, the intervals in the order AT$INTERVAL? lists them
+static const char *const _sim_sweep_names[] = { "send", "measure", "co2", "voc", "barometer", "dr" };
+
+static struct
+{
+    sim_action_t actions[SIM_MAX_ACTIONS];
+    size_t actions_length;
+    sim_uplink_t *uplinks;
+    size_t uplinks_capacity;
+    sim_downlink_t downlinks[SIM_MAX_DOWNLINKS];
+    size_t downlinks_length;
+    sim_sweep_t sweeps[SIM_MAX_SWEEPS];
+    size_t sweeps_length;
+    char sweep_commands[SIM_MAX_SWEEPS][64];
+    sim_expect_t expects[SIM_MAX_EXPECTS];
+    size_t expects_length;
+    // Console output of a query is collected here instead of being echoed and counted
+    char *capture;
+    size_t capture_length;
+    size_t capture_size;
+
+} _sim;
+
+static void _sim_application_task(void *param)
+{
+    (void) param;
+
+    application_task();
+}
+
+static void _sim_usage(const char *name)
+{
+    printf("usage: %s [options]\n", name);
+    printf("  --days N            simulated duration in days (default 7)\n");
+    printf("  --hours N           simulated duration in hours\n");
+    printf("  --scenario NAME     scripted environment (default office)\n");
+    printf("  --list-scenarios    list scripted environments\n");
+    printf("  --dr N              LoRaWAN data rate used for time-on-air (default 0)\n");
+    printf("  --at SEC:COMMAND    execute AT command at given second, e.g. 3600:AT$STATUS\n");
+    printf("  --click SEC         button click at given second\n");
+    printf("  --hold SEC          button hold at given second\n");
+    printf("  --downlink SEC:PORT:HEX  queue downlink at given second, sent after the next uplink\n");
+    printf("  --outage SEC:SEC    network outage between given seconds\n");
+    printf("  --modem-error SEC:SEC  modem answers sends with an error between given seconds\n");
+    printf("  --ack-loss SEC:SEC  acknowledges of confirmed uplinks are lost between given seconds\n");
+    printf("  --eeprom FILE       load EEPROM from and save it to FILE, simulates a reboot\n");
+    printf("  --replay FILE       sensor values from the AT$STREAM lines in FILE\n");
+    printf("  --battery MAH       usable battery capacity of the projection (default 1200)\n");
+    printf("  --energy NAME=VALUE coefficient of the battery model, e.g. idle=15 (uA) or co2=900 (uC)\n");
+    printf("  --sweep NAME=V,...  run every combination of the values, NAME is an interval of AT$INTERVAL or dr\n");
+    printf("  --uplinks           print every recorded uplink\n");
+    printf("  --expect NAME<=V    fail unless a summary value (CSV column or store_pending) is <=, >= or = V\n");
+    printf("  --csv               print summary as a CSV header and row\n");
+    printf("  --verbose           echo the device console\n");
+}
+
+static bool _sim_add_action(sim_action_type_t type, const char *arg)
+{
+    if (_sim.actions_length == SIM_MAX_ACTIONS)
+    {
+        return false;
+    }
+
+    char *end;
+    double seconds = strtod(arg, &end);
+
+    if (end == arg || seconds < 0)
+    {
+        return false;
+    }
+
+    if (type == SIM_ACTION_AT)
+    {
+        if (*end != ':')
+        {
+            return false;
+        }
+
+        end++;
+    }
+
+    sim_action_t *action = &_sim.actions[_sim.actions_length++];
+
+    action->tick = (twr_tick_t) (seconds * 1000);
+    action->type = type;
+    action->command = end;
+
+    // Keep actions ordered by time, insertion keeps equal times in command line order
+    for (size_t i = _sim.actions_length - 1; i > 0 && _sim.actions[i - 1].tick > _sim.actions[i].tick; i--)
+    {
+        sim_action_t tmp = _sim.actions[i - 1];
+        _sim.actions[i - 1] = _sim.actions[i];
+        _sim.actions[i] = tmp;
+    }
+
+    return true;
+}
+
+static bool _sim_add_downlink(const char *arg)
+{
+    if (_sim.downlinks_length == SIM_MAX_DOWNLINKS)
+    {
+        return false;
+    }
+
+    char *end;
+    double seconds = strtod(arg, &end);
+
+    if (end == arg || *end != ':')
+    {
+        return false;
+    }
+
+    long port = strtol(end + 1, &end, 10);
+
+    if (*end != ':' || port < 1 || port > 223)
+    {
+        return false;
+    }
+
+    const char *hex = end + 1;
+    size_t length = strlen(hex);
+    sim_downlink_t *downlink = &_sim.downlinks[_sim.downlinks_length];
+
+    if (length % 2 != 0 || length / 2 > sizeof(downlink->data))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length / 2; i++)
+    {
+        char byte[3] = { hex[i * 2], hex[i * 2 + 1], '\0' };
+
+        if (!isxdigit((unsigned char) byte[0]) || !isxdigit((unsigned char) byte[1]))
+        {
+            return false;
+        }
+
+        downlink->data[i] = strtol(byte, NULL, 16);
+    }
+
+    downlink->tick = (twr_tick_t) (seconds * 1000);
+    downlink->port = port;
+    downlink->length = length / 2;
+
+    _sim.downlinks_length++;
+
+    return true;
+}
+
+static bool _sim_add_sweep(const char *arg)
+{
+    if (_sim.sweeps_length == SIM_MAX_SWEEPS)
+    {
+        return false;
+    }
+
+    sim_sweep_t *sweep = &_sim.sweeps[_sim.sweeps_length];
+    size_t length = strcspn(arg, "=");
+
+    sweep->name = NULL;
+
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_sim_sweep_names); i++)
+    {
+        if (strlen(_sim_sweep_names[i]) == length && strncmp(_sim_sweep_names[i], arg, length) == 0)
+        {
+            sweep->name = _sim_sweep_names[i];
+        }
+    }
+
+    if (sweep->name == NULL || arg[length] != '=')
+    {
+        return false;
+    }
+
+    const char *p = arg + length;
+
+    for (sweep->length = 0; *p == '=' || *p == ','; sweep->length++)
+    {
+        char *end;
+
+        if (sweep->length == SIM_MAX_SWEEP_VALUES)
+        {
+            return false;
+        }
+
+        sweep->values[sweep->length] = strtol(p + 1, &end, 10);
+
+        if (end == p + 1 || sweep->values[sweep->length] < 0)
+        {
+            return false;
+        }
+
+        p = end;
+    }
+
+    if (*p != '\0')
+    {
+        return false;
+    }
+
+    _sim.sweeps_length++;
+
+    return true;
+}
+
+static bool _sim_add_expect(const char *arg)
+{
+    if (_sim.expects_length == SIM_MAX_EXPECTS)
+    {
+        return false;
+    }
+
+    sim_expect_t *expect = &_sim.expects[_sim.expects_length];
+    size_t length = strcspn(arg, "<>=");
+    const char *p = arg + length;
+    char *end;
+
+    if (length == 0 || length >= sizeof(expect->name) || *p == '\0')
+    {
+        return false;
+    }
+
+    memcpy(expect->name, arg, length);
+    expect->name[length] = '\0';
+
+    expect->relation = *p;
+
+    if (*p != '=' && *++p != '=')
+    {
+        return false;
+    }
+
+    expect->value = strtod(p + 1, &end);
+
+    if (end == p + 1 || *end != '\0')
+    {
+        return false;
+    }
+
+    _sim.expects_length++;
+
+    return true;
+}
+
+bool sim_downlink_take(twr_tick_t tick, sim_downlink_t *downlink)
+{
+    size_t oldest = _sim.downlinks_length;
+
+    for (size_t i = 0; i < _sim.downlinks_length; i++)
+    {
+        if (_sim.downlinks[i].tick <= tick && (oldest == _sim.downlinks_length || _sim.downlinks[i].tick < _sim.downlinks[oldest].tick))
+        {
+            oldest = i;
+        }
+    }
+
+    if (oldest == _sim.downlinks_length)
+    {
+        return false;
+    }
+
+    *downlink = _sim.downlinks[oldest];
+
+    _sim.downlinks[oldest] = _sim.downlinks[--_sim.downlinks_length];
+
+    return true;
+}
+
+static bool _sim_parse_args(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--verbose") == 0)
+        {
+            sim_options.verbose = true;
+        }
+        else if (strcmp(arg, "--uplinks") == 0)
+        {
+            sim_options.uplinks = true;
+        }
+        else if (strcmp(arg, "--csv") == 0)
+        {
+            sim_options.csv = true;
+        }
+        else if (strcmp(arg, "--list-scenarios") == 0)
+        {
+            sim_scenario_list();
+
+            exit(0);
+        }
+        else if (value == NULL)
+        {
+            return false;
+        }
+        else if (strcmp(arg, "--days") == 0)
+        {
+            sim_options.duration = (twr_tick_t) (atof(value) * 24 * 60 * 60 * 1000);
+            i++;
+        }
+        else if (strcmp(arg, "--hours") == 0)
+        {
+            sim_options.duration = (twr_tick_t) (atof(value) * 60 * 60 * 1000);
+            i++;
+        }
+        else if (strcmp(arg, "--scenario") == 0)
+        {
+            if (sim_scenario_find(value) == NULL)
+            {
+                fprintf(stderr, "sim: unknown scenario %s\n", value);
+
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--downlink") == 0)
+        {
+            if (!_sim_add_downlink(value))
+            {
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--outage") == 0 || strcmp(arg, "--modem-error") == 0 || strcmp(arg, "--ack-loss") == 0)
+        {
+            char *end;
+            double start = strtod(value, &end);
+
+            if (end == value || *end != ':')
+            {
+                return false;
+            }
+
+            twr_tick_t stop = (twr_tick_t) (strtod(end + 1, NULL) * 1000);
+
+            if (arg[2] == 'o')
+            {
+                sim_options.outage_start = (twr_tick_t) (start * 1000);
+                sim_options.outage_end = stop;
+            }
+            else if (arg[2] == 'a')
+            {
+                sim_options.ack_loss_start = (twr_tick_t) (start * 1000);
+                sim_options.ack_loss_end = stop;
+            }
+            else
+            {
+                sim_options.error_start = (twr_tick_t) (start * 1000);
+                sim_options.error_end = stop;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--eeprom") == 0)
+        {
+            sim_options.eeprom = value;
+            i++;
+        }
+        else if (strcmp(arg, "--replay") == 0)
+        {
+            sim_options.replay = value;
+            i++;
+        }
+        else if (strcmp(arg, "--dr") == 0)
+        {
+            sim_options.datarate = atoi(value);
+            i++;
+        }
+        else if (strcmp(arg, "--battery") == 0)
+        {
+            if (!sim_battery_set("capacity", atof(value)))
+            {
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--energy") == 0)
+        {
+            char name[16];
+            size_t length = strcspn(value, "=");
+
+            if (length >= sizeof(name) || value[length] != '=')
+            {
+                return false;
+            }
+
+            memcpy(name, value, length);
+            name[length] = '\0';
+
+            if (!sim_battery_set(name, atof(value + length + 1)))
+            {
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--expect") == 0)
+        {
+            if (!_sim_add_expect(value))
+            {
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--sweep") == 0)
+        {
+            if (!_sim_add_sweep(value))
+            {
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--at") == 0 || strcmp(arg, "--click") == 0 || strcmp(arg, "--hold") == 0)
+        {
+            sim_action_type_t type = arg[2] == 'a' ? SIM_ACTION_AT : arg[2] == 'c' ? SIM_ACTION_CLICK : SIM_ACTION_HOLD;
+
+            if (!_sim_add_action(type, value))
+            {
+                return false;
+            }
+            i++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void sim_uart_write(const char *text, size_t length)
+{
+    if (_sim.capture != NULL)
+    {
+        if (length > _sim.capture_size - 1 - _sim.capture_length)
+        {
+            length = _sim.capture_size - 1 - _sim.capture_length;
+        }
+
+        memcpy(_sim.capture + _sim.capture_length, text, length);
+
+        _sim.capture_length += length;
+        _sim.capture[_sim.capture_length] = '\0';
+
+        return;
+    }
+
+    sim_stats.uart_bytes += length;
+
+    if (sim_options.verbose)
+    {
+        fwrite(text, 1, length, stdout);
+    }
+}
+
+bool sim_i2c_transaction(twr_i2c_channel_t channel, uint8_t address)
+{
+    sim_stats.i2c_transactions++;
+
+    if (!sim_i2c_device_present(channel, address))
+    {
+        sim_stats.i2c_errors++;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool sim_lora_link_up(twr_tick_t tick)
+{
+    return tick < sim_options.outage_start || tick >= sim_options.outage_end;
+}
+
+bool sim_lora_modem_up(twr_tick_t tick)
+{
+    return tick < sim_options.error_start || tick >= sim_options.error_end;
+}
+
+bool sim_lora_ack_up(twr_tick_t tick)
+{
+    return sim_lora_link_up(tick) && (tick < sim_options.ack_loss_start || tick >= sim_options.ack_loss_end);
+}
+
+void sim_retransmission_record(twr_tick_t tick, twr_tick_t airtime)
+{
+    (void) tick;
+
+    sim_stats.retransmissions++;
+    sim_stats.airtime += airtime;
+}
+
+bool sim_lora_transmitting(twr_tick_t tick)
+{
+    if (sim_stats.uplinks == 0)
+    {
+        return false;
+    }
+
+    const sim_uplink_t *uplink = &_sim.uplinks[sim_stats.uplinks - 1];
+
+    return tick >= uplink->tick && tick < uplink->tick + uplink->airtime;
+}
+
+void sim_uplink_record(const sim_uplink_t *uplink)
+{
+    if (sim_stats.uplinks == _sim.uplinks_capacity)
+    {
+        _sim.uplinks_capacity = _sim.uplinks_capacity ? _sim.uplinks_capacity * 2 : 1024;
+        _sim.uplinks = realloc(_sim.uplinks, _sim.uplinks_capacity * sizeof(sim_uplink_t));
+
+        if (_sim.uplinks == NULL)
+        {
+            abort();
+        }
+    }
+
+    _sim.uplinks[sim_stats.uplinks++] = *uplink;
+
+    sim_stats.uplinks_confirmed += uplink->confirmed;
+    sim_stats.uplink_bytes += uplink->length;
+    sim_stats.airtime += uplink->airtime;
+
+    if (!sim_lora_link_up(uplink->tick))
+    {
+        sim_stats.uplinks_lost++;
+    }
+}
+
+static void _sim_print_uplinks(void)
+{
+    for (size_t i = 0; i < sim_stats.uplinks; i++)
+    {
+        const sim_uplink_t *uplink = &_sim.uplinks[i];
+
+        printf("uplink %10.3f port %u dr %u %s%s%5llu ms ", uplink->tick / 1000.0, uplink->port, uplink->datarate, uplink->confirmed ? "confirmed " : "",
+               sim_lora_link_up(uplink->tick) ? "" : "lost ", (unsigned long long) uplink->airtime);
+
+        for (size_t j = 0; j < uplink->length; j++)
+        {
+            printf("%02x", uplink->data[j]);
+        }
+
+        printf("\n");
+    }
+}
+
+// Number of the names of _sim_sweep_names that are intervals of AT$INTERVAL
+#define _SIM_INTERVALS (TWR_ARRAY_LENGTH(_sim_sweep_names) - 1)
+
+static bool _sim_query(const char *command, char *buffer, size_t size)
+{
+    _sim.capture = buffer;
+    _sim.capture_length = 0;
+    _sim.capture_size = size;
+    buffer[0] = '\0';
+
+    bool result = sim_atci_execute(command);
+
+    _sim.capture = NULL;
+
+    return result;
+}
+
+// Coefficients of the firmware energy model feed the battery projection
+static void _sim_read_energy(void)
+{
+    char buffer[1024];
+
+    if (_sim_query("AT$ENERGY?", buffer, sizeof(buffer)))
+    {
+        sim_battery_read(buffer);
+    }
+}
+
+// Intervals in seconds the firmware ends the run with, in the order of _sim_sweep_names
+static void _sim_read_intervals(unsigned long *intervals)
+{
+    char buffer[512];
+
+    memset(intervals, 0, _SIM_INTERVALS * sizeof(*intervals));
+
+    _sim_query("AT$INTERVAL?", buffer, sizeof(buffer));
+
+    for (char *line = strstr(buffer, "$INTERVAL: "); line != NULL; line = strstr(line + 1, "$INTERVAL: "))
+    {
+        char name[16];
+        unsigned long seconds;
+
+        if (sscanf(line, "$INTERVAL: \"%15[^\"]\",%lu", name, &seconds) != 2)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < _SIM_INTERVALS; i++)
+        {
+            if (strcmp(_sim_sweep_names[i], name) == 0)
+            {
+                intervals[i] = seconds;
+            }
+        }
+    }
+}
+
+static void _sim_print_summary(double wall_time)
+{
+    double hours = sim_options.duration / 3600000.0;
+    double duty_cycle = sim_options.duration ? 100.0 * sim_stats.airtime / sim_options.duration : 0;
+    unsigned long intervals[_SIM_INTERVALS];
+    sim_battery_t battery;
+
+    _sim_read_intervals(intervals);
+
+    sim_battery_project(&battery);
+
+    if (sim_options.csv)
+    {
+        printf("scenario,hours,datarate,wakeups,dispatches,i2c_transactions,i2c_errors,adc_reads,"
+               "co2_measurements,voc_measurements,barometer_measurements,humidity_measurements,"
+               "uart_bytes,uplinks,uplinks_confirmed,retransmissions,uplinks_rejected,uplinks_lost,uplink_errors,uplink_bytes,airtime_ms,duty_cycle_percent,"
+               "eeprom_writes,eeprom_bytes,eeprom_cycles_max,mah_per_day,battery_days\n");
+
+        printf("%s,%.3f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%.4f,%u,%u,%u,%.4f,%.1f\n",
+               sim_scenario_get()->name, hours, sim_options.datarate, sim_stats.wakeups, sim_stats.dispatches,
+               sim_stats.i2c_transactions, sim_stats.i2c_errors, sim_stats.adc_reads,
+               sim_stats.co2_measurements, sim_stats.voc_measurements, sim_stats.barometer_measurements, sim_stats.humidity_measurements,
+               sim_stats.uart_bytes, sim_stats.uplinks, sim_stats.uplinks_confirmed, sim_stats.retransmissions, sim_stats.uplinks_rejected, sim_stats.uplinks_lost, sim_stats.uplink_errors, sim_stats.uplink_bytes,
+               (unsigned long long) sim_stats.airtime, duty_cycle, sim_stats.eeprom_writes, sim_stats.eeprom_bytes, sim_stats.eeprom_cycles_max,
+               battery.total_mah_per_day, battery.days);
+
+        return;
+    }
+
+    printf("scenario        %s\n", sim_scenario_get()->name);
+    printf("duration        %.1f h\n", hours);
+    printf("wall time       %.3f s\n", wall_time);
+    printf("wakeups         %u (%.1f /h)\n", sim_stats.wakeups, sim_stats.wakeups / hours);
+    printf("dispatches      %u\n", sim_stats.dispatches);
+    printf("i2c             %u transactions, %u errors\n", sim_stats.i2c_transactions, sim_stats.i2c_errors);
+    printf("adc reads       %u\n", sim_stats.adc_reads);
+    printf("measurements    co2 %u, voc %u, barometer %u, humidity %u\n",
+           sim_stats.co2_measurements, sim_stats.voc_measurements, sim_stats.barometer_measurements, sim_stats.humidity_measurements);
+    printf("uart            %u B, %u B refused\n", sim_stats.uart_bytes, sim_stats.uart_refused);
+    printf("uplinks         %u (%.2f /h), %u confirmed, %u retransmitted, %u rejected, %u lost, %u errors, %u B payload\n",
+           sim_stats.uplinks, sim_stats.uplinks / hours, sim_stats.uplinks_confirmed, sim_stats.retransmissions, sim_stats.uplinks_rejected, sim_stats.uplinks_lost, sim_stats.uplink_errors, sim_stats.uplink_bytes);
+    printf("airtime         %llu ms at DR%u (%.4f %% duty cycle)\n", (unsigned long long) sim_stats.airtime, sim_options.datarate, duty_cycle);
+    printf("eeprom          %u writes, %u B programmed, %u cycles on the most worn byte\n",
+           sim_stats.eeprom_writes, sim_stats.eeprom_bytes, sim_stats.eeprom_cycles_max);
+
+    printf("intervals      ");
+
+    for (size_t i = 0; i < _SIM_INTERVALS; i++)
+    {
+        printf(" %s %lu s%s", _sim_sweep_names[i], intervals[i], i + 1 < _SIM_INTERVALS ? "," : "\n");
+    }
+
+    printf("energy         ");
+
+    for (int i = 0; i < SIM_BATTERY_COUNT; i++)
+    {
+        printf(" %s %.3f%s", sim_battery_get_name(i), battery.mah_per_day[i], i + 1 < SIM_BATTERY_COUNT ? "," : " mAh/day\n");
+    }
+
+    printf("battery         %.3f mAh/day, %.0f mAh last %.0f days (%.1f months)\n",
+           battery.total_mah_per_day, battery.capacity, battery.days, battery.days / 30.44);
+}
+
+// Returns the number of failed expectations
+static int _sim_check_expects(void)
+{
+    double hours = sim_options.duration / 3600000.0;
+    char buffer[1024];
+    unsigned int sequence = 0;
+    int pending = -1;
+    sim_battery_t battery;
+    int failed = 0;
+
+    unsigned long charged = 0;
+    unsigned long battery_count = 0;
+
+    if (_sim_query("AT$STORE?", buffer, sizeof(buffer)))
+    {
+        sscanf(buffer, "$STORE: %u,%d", &sequence, &pending);
+    }
+
+    // Airtime the firmware took from its budget, the fourth figure of AT$AIRTIME?
+    if (_sim_query("AT$AIRTIME?", buffer, sizeof(buffer)))
+    {
+        sscanf(buffer, "$AIRTIME: %*u,%*u,%*u,%lu", &charged);
+    }
+
+    // Battery measurements the firmware accounted, the count of AT$ENERGY?
+    if (_sim_query("AT$ENERGY?", buffer, sizeof(buffer)))
+    {
+        const char *line = strstr(buffer, "$ENERGY: \"Battery\",");
+
+        if (line != NULL)
+        {
+            sscanf(line, "$ENERGY: \"Battery\",%lu", &battery_count);
+        }
+    }
+
+    sim_battery_project(&battery);
+
+    const struct
+    {
+        const char *name;
+        double value;
+
+    } values[] = {
+        { "hours", hours },
+        { "wakeups", sim_stats.wakeups },
+        { "wakeups_per_hour", sim_stats.wakeups / hours },
+        { "dispatches", sim_stats.dispatches },
+        { "i2c_transactions", sim_stats.i2c_transactions },
+        { "i2c_errors", sim_stats.i2c_errors },
+        { "adc_reads", sim_stats.adc_reads },
+        { "adc_reads_uncounted", (double) sim_stats.adc_reads - battery_count },
+        { "co2_measurements", sim_stats.co2_measurements },
+        { "voc_measurements", sim_stats.voc_measurements },
+        { "barometer_measurements", sim_stats.barometer_measurements },
+        { "humidity_measurements", sim_stats.humidity_measurements },
+        { "uart_bytes", sim_stats.uart_bytes },
+        { "uart_refused", sim_stats.uart_refused },
+        { "uplinks", sim_stats.uplinks },
+        { "uplinks_confirmed", sim_stats.uplinks_confirmed },
+        { "retransmissions", sim_stats.retransmissions },
+        { "uplinks_rejected", sim_stats.uplinks_rejected },
+        { "uplinks_lost", sim_stats.uplinks_lost },
+        { "uplink_errors", sim_stats.uplink_errors },
+        { "uplink_bytes", sim_stats.uplink_bytes },
+        { "airtime_ms", sim_stats.airtime },
+        { "airtime_uncharged_ms", (double) sim_stats.airtime - charged },
+        { "duty_cycle_percent", sim_options.duration ? 100.0 * sim_stats.airtime / sim_options.duration : 0 },
+        { "eeprom_writes", sim_stats.eeprom_writes },
+        { "eeprom_bytes", sim_stats.eeprom_bytes },
+        { "eeprom_cycles_max", sim_stats.eeprom_cycles_max },
+        { "mah_per_day", battery.total_mah_per_day },
+        { "battery_days", battery.days },
+        { "store_pending", pending },
+    };
+
+    for (size_t i = 0; i < _sim.expects_length; i++)
+    {
+        const sim_expect_t *expect = &_sim.expects[i];
+        size_t j = 0;
+
+        while (j < TWR_ARRAY_LENGTH(values) && strcmp(values[j].name, expect->name) != 0)
+        {
+            j++;
+        }
+
+        if (j == TWR_ARRAY_LENGTH(values))
+        {
+            fprintf(stderr, "sim: unknown value %s\n", expect->name);
+
+            failed++;
+
+            continue;
+        }
+
+        double value = values[j].value;
+        bool met = expect->relation == '<' ? value <= expect->value : expect->relation == '>' ? value >= expect->value : value == expect->value;
+
+        if (!met)
+        {
+            fprintf(stderr, "sim: expected %s %s %g, got %g\n", expect->name,
+                    expect->relation == '<' ? "<=" : expect->relation == '>' ? ">=" : "=", expect->value, value);
+
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+// Runs the firmware for the duration, the sweep commands are executed right after its init
+static bool _sim_run(bool sweep, double *wall_time)
+{
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (sim_options.eeprom != NULL)
+    {
+        sim_eeprom_load(sim_options.eeprom);
+    }
+
+    twr_scheduler_init();
+    twr_scheduler_register(_sim_application_task, NULL, 0);
+
+    application_init();
+
+    for (size_t i = 0; sweep && i < _sim.sweeps_length; i++)
+    {
+        char buffer[64];
+
+        if (_sim.sweep_commands[i][0] != '\0' && !_sim_query(_sim.sweep_commands[i], buffer, sizeof(buffer)))
+        {
+            fprintf(stderr, "sim: %s failed\n", _sim.sweep_commands[i]);
+
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < _sim.actions_length; i++)
+    {
+        const sim_action_t *action = &_sim.actions[i];
+
+        if (action->tick > sim_options.duration)
+        {
+            break;
+        }
+
+        sim_scheduler_run(action->tick);
+
+        if (action->type == SIM_ACTION_AT)
+        {
+            sim_atci_execute(action->command);
+        }
+        else
+        {
+            sim_button_event(action->type == SIM_ACTION_CLICK ? TWR_BUTTON_EVENT_CLICK : TWR_BUTTON_EVENT_HOLD);
+        }
+    }
+
+    sim_scheduler_run(sim_options.duration);
+
+    _sim_read_energy();
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    // The runs of a sweep all start from the same EEPROM
+    if (!sweep && sim_options.eeprom != NULL && !sim_eeprom_save(sim_options.eeprom))
+    {
+        fprintf(stderr, "sim: cannot write %s\n", sim_options.eeprom);
+    }
+
+    *wall_time = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    return true;
+}
+
+static void _sim_print_sweep_header(void)
+{
+    const char *separator = sim_options.csv ? "," : " ";
+
+    printf(sim_options.csv ? "%s" : "%-9s", "scenario");
+
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_sim_sweep_names); i++)
+    {
+        printf(sim_options.csv ? "%s%s" : "%s%9s", separator, _sim_sweep_names[i]);
+    }
+
+    printf(sim_options.csv ? "%s%s%s%s%s%s" : "%s%7s%s%8s%s%6s", separator, "uplinks", separator, sim_options.csv ? "mah_per_day" : "mAh/day",
+           separator, sim_options.csv ? "battery_days" : "days");
+
+    for (int i = 0; i < SIM_BATTERY_COUNT; i++)
+    {
+        printf(sim_options.csv ? "%s%s" : "%s%9s", separator, sim_battery_get_name(i));
+    }
+
+    printf("\n");
+}
+
+// One run of the sweep in a fresh process, the firmware keeps its state in statics
+static void _sim_print_sweep_row(void)
+{
+    const char *separator = sim_options.csv ? "," : " ";
+    unsigned long intervals[_SIM_INTERVALS];
+    sim_battery_t battery;
+
+    _sim_read_intervals(intervals);
+
+    sim_battery_project(&battery);
+
+    printf(sim_options.csv ? "%s" : "%-9s", sim_scenario_get()->name);
+
+    for (size_t i = 0; i < _SIM_INTERVALS; i++)
+    {
+        printf(sim_options.csv ? "%s%lu" : "%s%9lu", separator, intervals[i]);
+    }
+
+    printf(sim_options.csv ? "%s%u%s%u%s%.4f%s%.1f" : "%s%9u%s%7u%s%8.3f%s%6.0f", separator, sim_options.datarate, separator, sim_stats.uplinks,
+           separator, battery.total_mah_per_day, separator, battery.days);
+
+    for (int i = 0; i < SIM_BATTERY_COUNT; i++)
+    {
+        printf(sim_options.csv ? "%s%.4f" : "%s%9.3f", separator, battery.mah_per_day[i]);
+    }
+
+    printf("\n");
+}
+
+static int _sim_sweep(void)
+{
+    size_t index[SIM_MAX_SWEEPS] = { 0 };
+    int result = 0;
+
+    _sim_print_sweep_header();
+
+    while (true)
+    {
+        fflush(stdout);
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            perror("sim: fork");
+
+            return 1;
+        }
+
+        if (pid == 0)
+        {
+            double wall_time;
+
+            for (size_t i = 0; i < _sim.sweeps_length; i++)
+            {
+                const sim_sweep_t *sweep = &_sim.sweeps[i];
+
+                if (strcmp(sweep->name, "dr") == 0)
+                {
+                    sim_options.datarate = sweep->values[index[i]];
+                }
+                else
+                {
+                    snprintf(_sim.sweep_commands[i], sizeof(_sim.sweep_commands[i]), "AT$INTERVAL=%s,%ld", sweep->name, sweep->values[index[i]]);
+                }
+            }
+
+            if (!_sim_run(true, &wall_time))
+            {
+                exit(1);
+            }
+
+            _sim_print_sweep_row();
+
+            fflush(stdout);
+
+            exit(0);
+        }
+
+        int status;
+
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            result = 1;
+        }
+
+        size_t i = 0;
+
+        for (; i < _sim.sweeps_length; i++)
+        {
+            if (++index[i] < _sim.sweeps[i].length)
+            {
+                break;
+            }
+
+            index[i] = 0;
+        }
+
+        if (i == _sim.sweeps_length)
+        {
+            return result;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (!_sim_parse_args(argc, argv))
+    {
+        _sim_usage(argv[0]);
+
+        return 1;
+    }
+
+    if (sim_options.replay != NULL && !sim_scenario_replay(sim_options.replay))
+    {
+        fprintf(stderr, "sim: cannot replay %s\n", sim_options.replay);
+
+        return 1;
+    }
+
+    if (_sim.sweeps_length > 0)
+    {
+        return _sim_sweep();
+    }
+
+    double wall_time;
+
+    _sim_run(false, &wall_time);
+
+    if (sim_options.uplinks)
+    {
+        _sim_print_uplinks();
+    }
+
+    _sim_print_summary(wall_time);
+
+    return _sim_check_expects() > 0 ? 1 : 0;
+}
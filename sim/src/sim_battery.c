@@ -0,0 +1,194 @@
+#include <sim.h>
+
+#define _SIM_BATTERY_UC_PER_MAH (3600.0 * 1000.0)
+#define _SIM_BATTERY_DAY (24.0 * 60 * 60 * 1000)
+
+typedef enum
+{
+    _SIM_BATTERY_CAPACITY = 0,
+    _SIM_BATTERY_IDLE,
+    _SIM_BATTERY_WAKEUP,
+    _SIM_BATTERY_I2C,
+    _SIM_BATTERY_ADC,
+    _SIM_BATTERY_CO2,
+    _SIM_BATTERY_VOC,
+    _SIM_BATTERY_BAROMETER,
+    _SIM_BATTERY_HUMIDITY,
+    _SIM_BATTERY_UART,
+    _SIM_BATTERY_UPLINK,
+    _SIM_BATTERY_TX,
+    _SIM_BATTERY_EEPROM,
+    _SIM_BATTERY_COEFFICIENTS
+
+} _sim_battery_coefficient_t;
+
+// Charge per counted event in uC, currents in uA, estimates to be calibrated on a unit. The sleep,
+// sensor, battery and LoRa coefficients are read from the firmware (AT$ENERGY?) after the run, the
+// bus traffic of a measurement is accounted under I2C.
+static struct
+{
+    const char *name;
+    double value;
+    // Set by --energy, the firmware value does not replace it
+    bool overridden;
+
+} _sim_battery_coefficients[_SIM_BATTERY_COEFFICIENTS] = {
+    // Usable capacity in mAh, four AAA alkaline cells of the Battery Module
+    [_SIM_BATTERY_CAPACITY] = { "capacity", 1200.0 },
+    // Sleep current of the whole unit
+    [_SIM_BATTERY_IDLE] = { "idle", 0 },
+    // Leaving stop mode and one pass of the scheduler
+    [_SIM_BATTERY_WAKEUP] = { "wakeup", 3.0 },
+    // One transaction at 100 kHz with the MCU running
+    [_SIM_BATTERY_I2C] = { "i2c", 0.5 },
+    [_SIM_BATTERY_ADC] = { "adc", 0 },
+    [_SIM_BATTERY_CO2] = { "co2", 0 },
+    [_SIM_BATTERY_VOC] = { "voc", 0 },
+    [_SIM_BATTERY_BAROMETER] = { "barometer", 0 },
+    [_SIM_BATTERY_HUMIDITY] = { "humidity", 0 },
+    // Console byte at 115200 Bd
+    [_SIM_BATTERY_UART] = { "uart", 0.2 },
+    // Modem wakeup and receive windows of an uplink, the transmit current over its airtime
+    [_SIM_BATTERY_UPLINK] = { "uplink", 0 },
+    [_SIM_BATTERY_TX] = { "tx", 0 },
+    // Byte programmed into the data EEPROM
+    [_SIM_BATTERY_EEPROM] = { "eeprom", 1.0 },
+};
+
+static const char *_sim_battery_names[SIM_BATTERY_COUNT] = {
+    [SIM_BATTERY_IDLE] = "idle",
+    [SIM_BATTERY_WAKEUP] = "wakeup",
+    [SIM_BATTERY_I2C] = "i2c",
+    [SIM_BATTERY_ADC] = "adc",
+    [SIM_BATTERY_CO2] = "co2",
+    [SIM_BATTERY_VOC] = "voc",
+    [SIM_BATTERY_BAROMETER] = "barometer",
+    [SIM_BATTERY_HUMIDITY] = "humidity",
+    [SIM_BATTERY_CONSOLE] = "console",
+    [SIM_BATTERY_LORA] = "lora",
+    [SIM_BATTERY_EEPROM] = "eeprom",
+};
+
+// Subsystems of src/energy.c as AT$ENERGY? names them, with the coefficients their charge per
+// operation and active current feed, the sensors are not modelled while active
+static const struct
+{
+    const char *name;
+    _sim_battery_coefficient_t charge;
+    _sim_battery_coefficient_t current;
+
+} _sim_battery_energy[] = {
+    { "CO2", _SIM_BATTERY_CO2, _SIM_BATTERY_COEFFICIENTS },
+    { "VOC", _SIM_BATTERY_VOC, _SIM_BATTERY_COEFFICIENTS },
+    { "Barometer", _SIM_BATTERY_BAROMETER, _SIM_BATTERY_COEFFICIENTS },
+    { "Humidity", _SIM_BATTERY_HUMIDITY, _SIM_BATTERY_COEFFICIENTS },
+    { "Battery", _SIM_BATTERY_ADC, _SIM_BATTERY_COEFFICIENTS },
+    { "LoRa", _SIM_BATTERY_UPLINK, _SIM_BATTERY_TX },
+    { "Idle", _SIM_BATTERY_COEFFICIENTS, _SIM_BATTERY_IDLE },
+};
+
+bool sim_battery_set(const char *name, double value)
+{
+    for (int i = 0; i < _SIM_BATTERY_COEFFICIENTS; i++)
+    {
+        if (strcmp(_sim_battery_coefficients[i].name, name) == 0 && value >= 0)
+        {
+            _sim_battery_coefficients[i].value = value;
+            _sim_battery_coefficients[i].overridden = true;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void _sim_battery_load(_sim_battery_coefficient_t coefficient, const char *field)
+{
+    if (coefficient != _SIM_BATTERY_COEFFICIENTS && *field != ',' && !_sim_battery_coefficients[coefficient].overridden)
+    {
+        _sim_battery_coefficients[coefficient].value = atof(field);
+    }
+}
+
+void sim_battery_read(const char *output)
+{
+    for (const char *line = strstr(output, "$ENERGY: \""); line != NULL; line = strstr(line + 1, "$ENERGY: \""))
+    {
+        const char *name = line + strlen("$ENERGY: \"");
+        size_t length = strcspn(name, "\"");
+
+        for (size_t i = 0; i < TWR_ARRAY_LENGTH(_sim_battery_energy); i++)
+        {
+            if (strlen(_sim_battery_energy[i].name) != length || strncmp(_sim_battery_energy[i].name, name, length) != 0)
+            {
+                continue;
+            }
+
+            // name,count,active s,uC/op,uA,mC, the idle line leaves the count and charge per operation empty
+            const char *field = name + length + 1;
+
+            for (int j = 0; j < 3 && field != NULL; j++)
+            {
+                field = strchr(field, ',');
+                field = field != NULL ? field + 1 : NULL;
+            }
+
+            if (field == NULL)
+            {
+                break;
+            }
+
+            _sim_battery_load(_sim_battery_energy[i].charge, field);
+
+            field = strchr(field, ',');
+
+            if (field != NULL)
+            {
+                _sim_battery_load(_sim_battery_energy[i].current, field + 1);
+            }
+        }
+    }
+}
+
+void sim_battery_project(sim_battery_t *battery)
+{
+    double c[_SIM_BATTERY_COEFFICIENTS];
+    double days = sim_options.duration / _SIM_BATTERY_DAY;
+    double total = 0;
+
+    for (int i = 0; i < _SIM_BATTERY_COEFFICIENTS; i++)
+    {
+        c[i] = _sim_battery_coefficients[i].value;
+    }
+
+    double charge[SIM_BATTERY_COUNT] = {
+        [SIM_BATTERY_IDLE] = c[_SIM_BATTERY_IDLE] * sim_options.duration / 1000.0,
+        [SIM_BATTERY_WAKEUP] = c[_SIM_BATTERY_WAKEUP] * sim_stats.wakeups,
+        [SIM_BATTERY_I2C] = c[_SIM_BATTERY_I2C] * sim_stats.i2c_transactions,
+        [SIM_BATTERY_ADC] = c[_SIM_BATTERY_ADC] * sim_stats.adc_reads,
+        [SIM_BATTERY_CO2] = c[_SIM_BATTERY_CO2] * sim_stats.co2_measurements,
+        [SIM_BATTERY_VOC] = c[_SIM_BATTERY_VOC] * sim_stats.voc_measurements,
+        [SIM_BATTERY_BAROMETER] = c[_SIM_BATTERY_BAROMETER] * sim_stats.barometer_measurements,
+        [SIM_BATTERY_HUMIDITY] = c[_SIM_BATTERY_HUMIDITY] * sim_stats.humidity_measurements,
+        [SIM_BATTERY_CONSOLE] = c[_SIM_BATTERY_UART] * sim_stats.uart_bytes,
+        [SIM_BATTERY_LORA] = c[_SIM_BATTERY_UPLINK] * sim_stats.uplinks + c[_SIM_BATTERY_TX] * sim_stats.airtime / 1000.0,
+        [SIM_BATTERY_EEPROM] = c[_SIM_BATTERY_EEPROM] * sim_stats.eeprom_bytes,
+    };
+
+    for (int i = 0; i < SIM_BATTERY_COUNT; i++)
+    {
+        battery->mah_per_day[i] = days > 0 ? charge[i] / _SIM_BATTERY_UC_PER_MAH / days : 0;
+
+        total += battery->mah_per_day[i];
+    }
+
+    battery->total_mah_per_day = total;
+    battery->capacity = c[_SIM_BATTERY_CAPACITY];
+    battery->days = total > 0 ? battery->capacity / total : 0;
+}
+
+const char *sim_battery_get_name(sim_battery_subsystem_t subsystem)
+{
+    return _sim_battery_names[subsystem];
+}
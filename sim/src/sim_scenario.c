@@ -0,0 +1,544 @@
+#include <sim.h>
+
+// Scripted environments, virtual time starts on Monday 00:00
+
+#define _SIM_HOUR (60 * 60 * 1000ULL)
+#define _SIM_DAY (24 * _SIM_HOUR)
+
+// Drop of the cell voltage under the transmit current of the modem
+#define _SIM_VOLTAGE_TX_DROP 0.12f
+
+static float _sim_noise(twr_tick_t tick, uint32_t seed)
+{
+    uint32_t x = (uint32_t) (tick / 1000) * 2654435761u ^ seed;
+
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+
+    return (float) (x & 0xffff) / 32768.f - 1.f;
+}
+
+static float _sim_occupancy(twr_tick_t tick)
+{
+    int day = (tick / _SIM_DAY) % 7;
+    float hour = (float) (tick % _SIM_DAY) / _SIM_HOUR;
+
+    if (day >= 5 || hour < 8.f || hour > 17.f)
+    {
+        return 0.f;
+    }
+
+    return 1.f;
+}
+
+// Room air follows occupancy with a first order lag of about an hour
+static float _sim_room_level(twr_tick_t tick)
+{
+    twr_tick_t start = tick > 4 * _SIM_HOUR ? tick - 4 * _SIM_HOUR : 0;
+    float level = 0.f;
+
+    for (twr_tick_t t = start; t < tick; t += 5 * 60 * 1000)
+    {
+        level += (_sim_occupancy(t) - level) * (5.f / 60.f);
+    }
+
+    return level;
+}
+
+static float _sim_office_co2(twr_tick_t tick)
+{
+    return 420.f + 900.f * _sim_room_level(tick) + 8.f * _sim_noise(tick, 1);
+}
+
+static float _sim_office_tvoc(twr_tick_t tick)
+{
+    return 60.f + 260.f * _sim_room_level(tick) + 10.f * _sim_noise(tick, 2);
+}
+
+static float _sim_office_temperature(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    (void) channel;
+
+    return 21.f + 2.5f * _sim_room_level(tick) + 0.1f * _sim_noise(tick, 3);
+}
+
+static float _sim_office_humidity(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    (void) channel;
+
+    return 38.f + 9.f * _sim_room_level(tick) + 0.5f * _sim_noise(tick, 4);
+}
+
+// Second tag on I2C1 in the unheated store room next door, the office one on I2C0
+static float _sim_dual_temperature(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    if (channel == TWR_I2C_I2C0)
+    {
+        return _sim_office_temperature(tick, channel);
+    }
+
+    return 16.5f + 0.5f * _sim_room_level(tick) + 0.1f * _sim_noise(tick, 7);
+}
+
+static float _sim_dual_humidity(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    if (channel == TWR_I2C_I2C0)
+    {
+        return _sim_office_humidity(tick, channel);
+    }
+
+    return 52.f + 0.5f * _sim_noise(tick, 8);
+}
+
+static float _sim_pressure(twr_tick_t tick)
+{
+    return 98500.f + 600.f * sinf((float) tick / (3 * _SIM_DAY) * 2 * (float) M_PI) + 5.f * _sim_noise(tick, 5);
+}
+
+static float _sim_voltage(twr_tick_t tick)
+{
+    // Slow discharge of a fresh pair of cells
+    return 3.05f - 0.01f * (float) tick / (7 * _SIM_DAY) + 0.01f * _sim_noise(tick, 6);
+}
+
+static float _sim_depleted_voltage(twr_tick_t tick)
+{
+    // Cells near the end, the battery module reports a low level and a critical one under the transmit current
+    return 1.95f + 0.01f * _sim_noise(tick, 6);
+}
+
+static float _sim_empty_co2(twr_tick_t tick)
+{
+    return 430.f + 6.f * _sim_noise(tick, 1);
+}
+
+static float _sim_empty_tvoc(twr_tick_t tick)
+{
+    return 55.f + 5.f * _sim_noise(tick, 2);
+}
+
+static float _sim_empty_temperature(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    (void) channel;
+
+    return 19.5f + 0.1f * _sim_noise(tick, 3);
+}
+
+static float _sim_empty_humidity(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    (void) channel;
+
+    return 41.f + 0.5f * _sim_noise(tick, 4);
+}
+
+static const sim_scenario_t _sim_scenarios[] = {
+    {
+        .name = "office",
+        .description = "Weekday occupancy 8:00-17:00, all tags populated",
+        .co2_ppm = _sim_office_co2,
+        .tvoc_ppb = _sim_office_tvoc,
+        .temperature = _sim_office_temperature,
+        .humidity = _sim_office_humidity,
+        .pressure = _sim_pressure,
+        .voltage = _sim_voltage,
+        .voltage_tx_drop = _SIM_VOLTAGE_TX_DROP,
+        .voc_lp_present = true,
+        .barometer_present = true,
+        .humidity_revision = { TWR_TAG_HUMIDITY_REVISION_R3, SIM_HUMIDITY_TAG_NONE }
+    },
+    {
+        .name = "empty",
+        .description = "Unoccupied room with stable readings, all tags populated",
+        .co2_ppm = _sim_empty_co2,
+        .tvoc_ppb = _sim_empty_tvoc,
+        .temperature = _sim_empty_temperature,
+        .humidity = _sim_empty_humidity,
+        .pressure = _sim_pressure,
+        .voltage = _sim_voltage,
+        .voltage_tx_drop = _SIM_VOLTAGE_TX_DROP,
+        .voc_lp_present = true,
+        .barometer_present = true,
+        .humidity_revision = { TWR_TAG_HUMIDITY_REVISION_R3, SIM_HUMIDITY_TAG_NONE }
+    },
+    {
+        .name = "minimal",
+        .description = "Office occupancy, only the CO2 module and a humidity tag R2 on I2C1",
+        .co2_ppm = _sim_office_co2,
+        .tvoc_ppb = _sim_office_tvoc,
+        .temperature = _sim_office_temperature,
+        .humidity = _sim_office_humidity,
+        .pressure = _sim_pressure,
+        .voltage = _sim_voltage,
+        .voltage_tx_drop = _SIM_VOLTAGE_TX_DROP,
+        .voc_lp_present = false,
+        .barometer_present = false,
+        .humidity_revision = { SIM_HUMIDITY_TAG_NONE, TWR_TAG_HUMIDITY_REVISION_R2 }
+    },
+    {
+        .name = "dual",
+        .description = "Office occupancy, all tags populated and a second humidity tag R2 in the store room on I2C1",
+        .co2_ppm = _sim_office_co2,
+        .tvoc_ppb = _sim_office_tvoc,
+        .temperature = _sim_dual_temperature,
+        .humidity = _sim_dual_humidity,
+        .pressure = _sim_pressure,
+        .voltage = _sim_voltage,
+        .voltage_tx_drop = _SIM_VOLTAGE_TX_DROP,
+        .voc_lp_present = true,
+        .barometer_present = true,
+        .humidity_revision = { TWR_TAG_HUMIDITY_REVISION_R3, TWR_TAG_HUMIDITY_REVISION_R2 }
+    },
+    {
+        .name = "depleted",
+        .description = "Office occupancy, all tags populated and the cells near the end",
+        .co2_ppm = _sim_office_co2,
+        .tvoc_ppb = _sim_office_tvoc,
+        .temperature = _sim_office_temperature,
+        .humidity = _sim_office_humidity,
+        .pressure = _sim_pressure,
+        .voltage = _sim_depleted_voltage,
+        .voltage_tx_drop = _SIM_VOLTAGE_TX_DROP,
+        .voc_lp_present = true,
+        .barometer_present = true,
+        .humidity_revision = { TWR_TAG_HUMIDITY_REVISION_R3, SIM_HUMIDITY_TAG_NONE }
+    }
+};
+
+static const sim_scenario_t *_sim_scenario = &_sim_scenarios[0];
+
+// Fields of a stream record, PAYLOAD_FIELD_* of the firmware
+typedef enum
+{
+    _SIM_REPLAY_VOLTAGE = 0,
+    _SIM_REPLAY_TEMPERATURE = 1,
+    _SIM_REPLAY_HUMIDITY = 2,
+    _SIM_REPLAY_VOC = 3,
+    _SIM_REPLAY_PRESSURE = 4,
+    _SIM_REPLAY_CO2 = 5,
+    _SIM_REPLAY_VOLTAGE_IDLE = 6,
+    _SIM_REPLAY_TEMPERATURE_2 = 7,
+    _SIM_REPLAY_HUMIDITY_2 = 8,
+    _SIM_REPLAY_FIELDS = 9
+
+} _sim_replay_field_t;
+
+typedef struct
+{
+    twr_tick_t tick;
+    float value;
+
+} _sim_replay_sample_t;
+
+static struct
+{
+    sim_scenario_t scenario;
+    _sim_replay_sample_t *samples[_SIM_REPLAY_FIELDS];
+    size_t length[_SIM_REPLAY_FIELDS];
+    size_t size[_SIM_REPLAY_FIELDS];
+
+} _sim_replay;
+
+// CRC-8 of the record, polynomial 0x07 as in stream.c
+static uint8_t _sim_replay_crc(const uint8_t *buffer, size_t length)
+{
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= buffer[i];
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = crc & 0x80 ? (uint8_t) (crc << 1) ^ 0x07 : (uint8_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static void _sim_replay_add(int field, twr_tick_t tick, float value)
+{
+    if (_sim_replay.length[field] == _sim_replay.size[field])
+    {
+        _sim_replay.size[field] = _sim_replay.size[field] ? 2 * _sim_replay.size[field] : 256;
+        _sim_replay.samples[field] = realloc(_sim_replay.samples[field], _sim_replay.size[field] * sizeof(_sim_replay_sample_t));
+    }
+
+    _sim_replay.samples[field][_sim_replay.length[field]++] = (_sim_replay_sample_t) { tick, value };
+}
+
+// Sample of the field nearest to tick if it is nearer than distance
+static void _sim_replay_nearest(twr_tick_t tick, int field, twr_tick_t *distance, float *value)
+{
+    const _sim_replay_sample_t *samples = _sim_replay.samples[field];
+    size_t length = _sim_replay.length[field];
+    size_t low = 0;
+    size_t high = length;
+
+    // First sample after tick, the nearest one is it or the one before
+    while (low < high)
+    {
+        size_t middle = (low + high) / 2;
+
+        if (samples[middle].tick <= tick)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (size_t i = low > 0 ? low - 1 : 0; i <= low && i < length; i++)
+    {
+        twr_tick_t d = samples[i].tick > tick ? samples[i].tick - tick : tick - samples[i].tick;
+
+        if (d < *distance)
+        {
+            *distance = d;
+            *value = samples[i].value;
+        }
+    }
+}
+
+static float _sim_replay_value(twr_tick_t tick, int field)
+{
+    twr_tick_t distance = TWR_TICK_INFINITY;
+    float value = NAN;
+
+    _sim_replay_nearest(tick, field, &distance, &value);
+
+    return value;
+}
+
+static float _sim_replay_co2(twr_tick_t tick)
+{
+    return _sim_replay_value(tick, _SIM_REPLAY_CO2);
+}
+
+static float _sim_replay_tvoc(twr_tick_t tick)
+{
+    return _sim_replay_value(tick, _SIM_REPLAY_VOC);
+}
+
+// The firmware gives the first humidity channel to the tag on the lowest bus, it is attached first
+static bool _sim_replay_second_channel(twr_i2c_channel_t channel)
+{
+    return channel == TWR_I2C_I2C1 && _sim_replay.scenario.humidity_revision[TWR_I2C_I2C0] != SIM_HUMIDITY_TAG_NONE;
+}
+
+static float _sim_replay_temperature(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    return _sim_replay_value(tick, _sim_replay_second_channel(channel) ? _SIM_REPLAY_TEMPERATURE_2 : _SIM_REPLAY_TEMPERATURE);
+}
+
+static float _sim_replay_humidity(twr_tick_t tick, twr_i2c_channel_t channel)
+{
+    return _sim_replay_value(tick, _sim_replay_second_channel(channel) ? _SIM_REPLAY_HUMIDITY_2 : _SIM_REPLAY_HUMIDITY);
+}
+
+static float _sim_replay_pressure(twr_tick_t tick)
+{
+    return _sim_replay_value(tick, _SIM_REPLAY_PRESSURE);
+}
+
+// The recorded voltage was read under load or idle already, whichever the firmware chose then
+static float _sim_replay_voltage(twr_tick_t tick)
+{
+    twr_tick_t distance = TWR_TICK_INFINITY;
+    float value = NAN;
+
+    _sim_replay_nearest(tick, _SIM_REPLAY_VOLTAGE, &distance, &value);
+    _sim_replay_nearest(tick, _SIM_REPLAY_VOLTAGE_IDLE, &distance, &value);
+
+    return value;
+}
+
+bool sim_scenario_replay(const char *path)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    char line[256];
+    uint32_t epoch = 0;
+    uint32_t last = 0;
+    size_t samples = 0;
+    size_t rejected = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (line[0] != '#')
+        {
+            continue;
+        }
+
+        uint8_t record[10];
+        size_t length = 0;
+
+        for (const char *c = line + 1; length < sizeof(record) && isxdigit((unsigned char) c[0]) && isxdigit((unsigned char) c[1]); c += 2)
+        {
+            char hex[3] = { c[0], c[1], '\0' };
+
+            record[length++] = (uint8_t) strtoul(hex, NULL, 16);
+        }
+
+        if (length != sizeof(record) || _sim_replay_crc(record, 9) != record[9] || record[4] >= _SIM_REPLAY_FIELDS)
+        {
+            rejected++;
+
+            continue;
+        }
+
+        uint32_t tick = (uint32_t) record[0] << 24 | (uint32_t) record[1] << 16 | (uint32_t) record[2] << 8 | record[3];
+        uint32_t bits = (uint32_t) record[5] << 24 | (uint32_t) record[6] << 16 | (uint32_t) record[7] << 8 | record[8];
+        float value;
+
+        memcpy(&value, &bits, sizeof(value));
+
+        // The firmware sends the low 32 bits of the tick
+        if (tick < last)
+        {
+            epoch++;
+        }
+
+        last = tick;
+
+        _sim_replay_add(record[4], (twr_tick_t) epoch << 32 | tick, value);
+        samples++;
+    }
+
+    fclose(file);
+
+    if (rejected > 0)
+    {
+        fprintf(stderr, "sim: %zu damaged stream lines in %s skipped\n", rejected, path);
+    }
+
+    if (samples == 0)
+    {
+        return false;
+    }
+
+    // Populated hardware stays as in the selected scenario
+    _sim_replay.scenario = *_sim_scenario;
+    _sim_replay.scenario.name = "replay";
+    _sim_replay.scenario.description = path;
+    _sim_replay.scenario.co2_ppm = _sim_replay_co2;
+    _sim_replay.scenario.tvoc_ppb = _sim_replay_tvoc;
+    _sim_replay.scenario.temperature = _sim_replay_temperature;
+    _sim_replay.scenario.humidity = _sim_replay_humidity;
+    _sim_replay.scenario.pressure = _sim_replay_pressure;
+    _sim_replay.scenario.voltage = _sim_replay_voltage;
+    _sim_replay.scenario.voltage_tx_drop = 0.f;
+
+    _sim_scenario = &_sim_replay.scenario;
+
+    return true;
+}
+
+const sim_scenario_t *sim_scenario_get(void)
+{
+    return _sim_scenario;
+}
+
+const sim_scenario_t *sim_scenario_find(const char *name)
+{
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_sim_scenarios); i++)
+    {
+        if (strcmp(_sim_scenarios[i].name, name) == 0)
+        {
+            _sim_scenario = &_sim_scenarios[i];
+
+            return _sim_scenario;
+        }
+    }
+
+    return NULL;
+}
+
+void sim_scenario_list(void)
+{
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_sim_scenarios); i++)
+    {
+        printf("%-10s %s\n", _sim_scenarios[i].name, _sim_scenarios[i].description);
+    }
+}
+
+bool sim_i2c_device_present(twr_i2c_channel_t channel, uint8_t address)
+{
+    const sim_scenario_t *scenario = _sim_scenario;
+
+    if (channel == TWR_I2C_I2C0)
+    {
+        // CO2 module is always fitted on I2C0
+        if (address == 0x4d)
+        {
+            return true;
+        }
+
+        if (address == TWR_TAG_VOC_LP_I2C_ADDRESS_DEFAULT && scenario->voc_lp_present)
+        {
+            return true;
+        }
+
+        if (address == TWR_TAG_BAROMETER_I2C_ADDRESS_DEFAULT && scenario->barometer_present)
+        {
+            return true;
+        }
+    }
+
+    if (channel > TWR_I2C_I2C1)
+    {
+        return false;
+    }
+
+    switch (scenario->humidity_revision[channel])
+    {
+        case TWR_TAG_HUMIDITY_REVISION_R1:
+            return address == 0x5f;
+        case TWR_TAG_HUMIDITY_REVISION_R2:
+        case TWR_TAG_HUMIDITY_REVISION_R3:
+            return address == 0x40;
+        case TWR_TAG_HUMIDITY_REVISION_R4:
+            return address == 0x44;
+        default:
+            return false;
+    }
+}
+
+void sim_i2c_memory_read(twr_i2c_channel_t channel, uint8_t address, uint32_t memory_address, uint8_t *buffer, size_t length)
+{
+    int revision = channel <= TWR_I2C_I2C1 ? _sim_scenario->humidity_revision[channel] : SIM_HUMIDITY_TAG_NONE;
+    uint8_t id[2] = { 0, 0 };
+
+    if (address == 0x5f && memory_address == 0x0f)
+    {
+        // HTS221 WHO_AM_I
+        id[0] = 0xbc;
+    }
+    else if (address == 0x40 && memory_address == 0xfc && revision == TWR_TAG_HUMIDITY_REVISION_R2)
+    {
+        // HDC2080 manufacturer ID
+        id[0] = 0x49;
+        id[1] = 0x54;
+    }
+    else if (address == 0x40 && memory_address == 0xe7 && revision == TWR_TAG_HUMIDITY_REVISION_R3)
+    {
+        // SHT20 user register
+        id[0] = 0x3a;
+    }
+    else if (address == TWR_TAG_BAROMETER_I2C_ADDRESS_DEFAULT && memory_address == 0x0c)
+    {
+        // MPL3115A2 WHO_AM_I
+        id[0] = 0xc4;
+    }
+
+    memset(buffer, 0, length);
+    memcpy(buffer, id, length < sizeof(id) ? length : sizeof(id));
+}
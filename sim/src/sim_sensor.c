@@ -0,0 +1,89 @@
+#include <sim_sensor.h>
+#include <sim.h>
+
+static void _sim_sensor_task_interval(void *param);
+static void _sim_sensor_task_measure(void *param);
+
+void sim_sensor_init(sim_sensor_t *self, const sim_sensor_profile_t *profile, twr_i2c_channel_t i2c_channel, uint8_t i2c_address, void (*complete)(sim_sensor_t *, bool), void *owner)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_profile = profile;
+    self->_i2c_channel = i2c_channel;
+    self->_i2c_address = i2c_address;
+    self->_complete = complete;
+    self->_owner = owner;
+    self->_update_interval = TWR_TICK_INFINITY;
+
+    self->_task_id_interval = twr_scheduler_register(_sim_sensor_task_interval, self, TWR_TICK_INFINITY);
+    self->_task_id_measure = twr_scheduler_register(_sim_sensor_task_measure, self, TWR_TICK_INFINITY);
+}
+
+void sim_sensor_set_update_interval(sim_sensor_t *self, twr_tick_t interval)
+{
+    self->_update_interval = interval;
+
+    if (interval == TWR_TICK_INFINITY)
+    {
+        twr_scheduler_plan_absolute(self->_task_id_interval, TWR_TICK_INFINITY);
+    }
+    else
+    {
+        twr_scheduler_plan_relative(self->_task_id_interval, interval);
+
+        sim_sensor_measure(self);
+    }
+}
+
+bool sim_sensor_measure(sim_sensor_t *self)
+{
+    if (self->_measurement_active)
+    {
+        return false;
+    }
+
+    self->_measurement_active = true;
+    self->_phase = 0;
+
+    twr_scheduler_plan_now(self->_task_id_measure);
+
+    return true;
+}
+
+static void _sim_sensor_task_interval(void *param)
+{
+    sim_sensor_t *self = param;
+
+    sim_sensor_measure(self);
+
+    twr_scheduler_plan_current_relative(self->_update_interval);
+}
+
+static void _sim_sensor_task_measure(void *param)
+{
+    sim_sensor_t *self = param;
+    const sim_sensor_profile_t *profile = self->_profile;
+
+    for (int i = 0; i < profile->transactions_per_phase; i++)
+    {
+        if (!sim_i2c_transaction(self->_i2c_channel, self->_i2c_address))
+        {
+            self->_measurement_active = false;
+
+            self->_complete(self, false);
+
+            return;
+        }
+    }
+
+    if (++self->_phase < profile->phase_count)
+    {
+        twr_scheduler_plan_current_from_now(profile->phase_delay[self->_phase]);
+
+        return;
+    }
+
+    self->_measurement_active = false;
+
+    self->_complete(self, true);
+}
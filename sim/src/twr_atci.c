@@ -0,0 +1,129 @@
+#include <twr_atci.h>
+#include <twr_uart.h>
+#include <sim.h>
+
+static struct
+{
+    const twr_atci_command_t *commands;
+    int commands_length;
+
+} _twr_atci;
+
+void twr_atci_init(const twr_atci_command_t *commands, int length)
+{
+    _twr_atci.commands = commands;
+    _twr_atci.commands_length = length;
+}
+
+void twr_atci_write_ok(void)
+{
+    twr_uart_write(TWR_UART_UART2, "OK\r\n", 4);
+}
+
+void twr_atci_write_error(void)
+{
+    twr_uart_write(TWR_UART_UART2, "ERROR\r\n", 7);
+}
+
+size_t twr_atci_printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list ap;
+
+    va_start(ap, format);
+    int length = vsnprintf(buffer, sizeof(buffer) - 2, format, ap);
+    va_end(ap);
+
+    if (length < 0)
+    {
+        return 0;
+    }
+
+    if (length > (int) sizeof(buffer) - 3)
+    {
+        length = sizeof(buffer) - 3;
+    }
+
+    buffer[length++] = '\r';
+    buffer[length++] = '\n';
+
+    return twr_uart_write(TWR_UART_UART2, buffer, length);
+}
+
+bool twr_atci_clac_action(void)
+{
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        twr_atci_printf("AT%s", _twr_atci.commands[i].command);
+    }
+
+    return true;
+}
+
+bool twr_atci_help_action(void)
+{
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        twr_atci_printf("AT%s %s", _twr_atci.commands[i].command, _twr_atci.commands[i].hint);
+    }
+
+    return true;
+}
+
+bool sim_atci_execute(const char *line)
+{
+    char buffer[128];
+
+    if (strncmp(line, "AT", 2) == 0)
+    {
+        line += 2;
+    }
+
+    strncpy(buffer, line, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    size_t length = strcspn(buffer, "=?");
+
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        const twr_atci_command_t *command = &_twr_atci.commands[i];
+
+        if (strlen(command->command) != length || strncmp(command->command, buffer, length) != 0)
+        {
+            continue;
+        }
+
+        bool result = false;
+
+        if (buffer[length] == '\0')
+        {
+            result = command->action != NULL && command->action();
+        }
+        else if (strcmp(buffer + length, "?") == 0)
+        {
+            result = command->read != NULL && command->read();
+        }
+        else if (strcmp(buffer + length, "=?") == 0)
+        {
+            result = command->help != NULL && command->help();
+        }
+        else if (buffer[length] == '=' && command->set != NULL)
+        {
+            twr_atci_param_t param = {
+                .txt = buffer + length + 1,
+                .length = strlen(buffer + length + 1),
+                .offset = 0
+            };
+
+            result = command->set(&param);
+        }
+
+        result ? twr_atci_write_ok() : twr_atci_write_error();
+
+        return result;
+    }
+
+    twr_atci_write_error();
+
+    return false;
+}
@@ -0,0 +1,30 @@
+#include <twr_button.h>
+#include <sim.h>
+
+static twr_button_t *_twr_button;
+
+void twr_button_init(twr_button_t *self, twr_gpio_channel_t gpio_channel, twr_gpio_pull_t gpio_pull, int idle_state)
+{
+    (void) gpio_pull;
+    (void) idle_state;
+
+    memset(self, 0, sizeof(*self));
+
+    self->_channel = gpio_channel;
+
+    _twr_button = self;
+}
+
+void twr_button_set_event_handler(twr_button_t *self, void (*event_handler)(twr_button_t *, twr_button_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void sim_button_event(twr_button_event_t event)
+{
+    if (_twr_button != NULL && _twr_button->_event_handler != NULL)
+    {
+        _twr_button->_event_handler(_twr_button, event, _twr_button->_event_param);
+    }
+}
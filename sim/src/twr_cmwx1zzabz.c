@@ -0,0 +1,373 @@
+#include <twr_cmwx1zzabz.h>
+#include <sim.h>
+
+// Fake LoRa modem: records every uplink with its time-on-air and emits the driver events on the
+// virtual clock. The modem boots for a few seconds, then stays busy for the transmission plus the
+// two class A receive windows after every uplink. A confirmed uplink is acknowledged unless it
+// falls into the simulated network outage or the acknowledge is lost, an uplink without its
+// acknowledge is sent again up to 3 times like the modem does, each time announced by
+// MESSAGE_RETRANSMISSION. A queued downlink is received after an uplink outside the outage.
+
+#define _TWR_CMWX1ZZABZ_BOOT_TIME 3000
+#define _TWR_CMWX1ZZABZ_COMMAND_TIME 50
+#define _TWR_CMWX1ZZABZ_RX_WINDOWS_TIME 2100
+#define _TWR_CMWX1ZZABZ_JOIN_TIME 6000
+#define _TWR_CMWX1ZZABZ_LORAWAN_OVERHEAD 13
+#define _TWR_CMWX1ZZABZ_RETRANSMISSIONS 3
+
+typedef enum
+{
+    _TWR_CMWX1ZZABZ_STATE_BOOT = 0,
+    _TWR_CMWX1ZZABZ_STATE_IDLE = 1,
+    _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_START = 2,
+    _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_DONE = 3,
+    _TWR_CMWX1ZZABZ_STATE_JOIN = 4
+
+} _twr_cmwx1zzabz_state_t;
+
+static void _twr_cmwx1zzabz_task(void *param);
+static bool _twr_cmwx1zzabz_send(twr_cmwx1zzabz_t *self, const void *buffer, size_t length, bool confirmed);
+static void _twr_cmwx1zzabz_event(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event);
+
+void twr_cmwx1zzabz_init(twr_cmwx1zzabz_t *self, twr_uart_channel_t uart_channel)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_uart_channel = uart_channel;
+    self->_band = TWR_CMWX1ZZABZ_CONFIG_BAND_EU868;
+    self->_nwk_public = 1;
+    self->_message_port = 2;
+    self->_datarate = sim_options.datarate;
+
+    strcpy(self->_deveui, "0000000000000000");
+    strcpy(self->_devaddr, "00000000");
+    strcpy(self->_nwkskey, "00000000000000000000000000000000");
+    strcpy(self->_appskey, "00000000000000000000000000000000");
+    strcpy(self->_appkey, "00000000000000000000000000000000");
+    strcpy(self->_appeui, "0000000000000000");
+
+    self->_state = _TWR_CMWX1ZZABZ_STATE_BOOT;
+    self->_task_id = twr_scheduler_register(_twr_cmwx1zzabz_task, self, twr_tick_get() + _TWR_CMWX1ZZABZ_BOOT_TIME);
+}
+
+void twr_cmwx1zzabz_set_event_handler(twr_cmwx1zzabz_t *self, void (*event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+bool twr_cmwx1zzabz_is_ready(twr_cmwx1zzabz_t *self)
+{
+    return self->_ready;
+}
+
+bool twr_cmwx1zzabz_send_message(twr_cmwx1zzabz_t *self, const void *buffer, size_t length)
+{
+    return _twr_cmwx1zzabz_send(self, buffer, length, false);
+}
+
+bool twr_cmwx1zzabz_send_message_confirmed(twr_cmwx1zzabz_t *self, const void *buffer, size_t length)
+{
+    return _twr_cmwx1zzabz_send(self, buffer, length, true);
+}
+
+uint32_t twr_cmwx1zzabz_get_received_message_length(twr_cmwx1zzabz_t *self)
+{
+    return self->_received_length;
+}
+
+uint8_t twr_cmwx1zzabz_get_received_message_port(twr_cmwx1zzabz_t *self)
+{
+    return self->_received_port;
+}
+
+uint32_t twr_cmwx1zzabz_get_received_message_data(twr_cmwx1zzabz_t *self, uint8_t *buffer, uint32_t buffer_size)
+{
+    if (buffer_size < self->_received_length)
+    {
+        return 0;
+    }
+
+    memcpy(buffer, self->_received_buffer, self->_received_length);
+
+    return self->_received_length;
+}
+
+void twr_cmwx1zzabz_set_port(twr_cmwx1zzabz_t *self, uint8_t port)
+{
+    self->_message_port = port;
+}
+
+uint8_t twr_cmwx1zzabz_get_port(twr_cmwx1zzabz_t *self)
+{
+    return self->_message_port;
+}
+
+#define _TWR_CMWX1ZZABZ_STRING_PROPERTY(NAME) \
+    void twr_cmwx1zzabz_set_##NAME(twr_cmwx1zzabz_t *self, const char *NAME) \
+    { \
+        strncpy(self->_##NAME, NAME, sizeof(self->_##NAME) - 1); \
+    } \
+    void twr_cmwx1zzabz_get_##NAME(twr_cmwx1zzabz_t *self, char *NAME) \
+    { \
+        strcpy(NAME, self->_##NAME); \
+    }
+
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(deveui)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(devaddr)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(nwkskey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appskey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appkey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appeui)
+
+void twr_cmwx1zzabz_set_band(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_band_t band)
+{
+    self->_band = band;
+}
+
+twr_cmwx1zzabz_config_band_t twr_cmwx1zzabz_get_band(twr_cmwx1zzabz_t *self)
+{
+    return self->_band;
+}
+
+void twr_cmwx1zzabz_set_mode(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_mode_t mode)
+{
+    self->_mode = mode;
+}
+
+twr_cmwx1zzabz_config_mode_t twr_cmwx1zzabz_get_mode(twr_cmwx1zzabz_t *self)
+{
+    return self->_mode;
+}
+
+void twr_cmwx1zzabz_set_class(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_class_t class)
+{
+    self->_class = class;
+}
+
+twr_cmwx1zzabz_config_class_t twr_cmwx1zzabz_get_class(twr_cmwx1zzabz_t *self)
+{
+    return self->_class;
+}
+
+void twr_cmwx1zzabz_set_nwk_public(twr_cmwx1zzabz_t *self, uint8_t public)
+{
+    self->_nwk_public = public;
+}
+
+uint8_t twr_cmwx1zzabz_get_nwk_public(twr_cmwx1zzabz_t *self)
+{
+    return self->_nwk_public;
+}
+
+void twr_cmwx1zzabz_set_datarate(twr_cmwx1zzabz_t *self, uint8_t datarate)
+{
+    self->_datarate = datarate;
+}
+
+uint8_t twr_cmwx1zzabz_get_datarate(twr_cmwx1zzabz_t *self)
+{
+    return self->_datarate;
+}
+
+void twr_cmwx1zzabz_set_adaptive_datarate(twr_cmwx1zzabz_t *self, bool enable)
+{
+    self->_adaptive_datarate = enable;
+}
+
+bool twr_cmwx1zzabz_get_adaptive_datarate(twr_cmwx1zzabz_t *self)
+{
+    return self->_adaptive_datarate;
+}
+
+void twr_cmwx1zzabz_join(twr_cmwx1zzabz_t *self)
+{
+    if (!self->_ready)
+    {
+        return;
+    }
+
+    self->_ready = false;
+    self->_state = _TWR_CMWX1ZZABZ_STATE_JOIN;
+
+    twr_scheduler_plan_from_now(self->_task_id, _TWR_CMWX1ZZABZ_JOIN_TIME);
+}
+
+twr_tick_t sim_lora_airtime(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length)
+{
+    int sf;
+    int bw = 125;
+
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        if (datarate >= 4)
+        {
+            sf = 8;
+            bw = 500;
+        }
+        else
+        {
+            sf = 10 - datarate;
+        }
+    }
+    else if (datarate == 6)
+    {
+        sf = band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 ? 8 : 7;
+        bw = band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 ? 500 : 250;
+    }
+    else
+    {
+        sf = 12 - (datarate > 5 ? 5 : datarate);
+    }
+
+    // Semtech AN1200.13, explicit header, CRC on, coding rate 4/5, 8 symbol preamble
+    double t_symbol = (double) (1 << sf) / bw;
+    int de = (bw == 125 && sf >= 11) ? 1 : 0;
+    int pl = length + _TWR_CMWX1ZZABZ_LORAWAN_OVERHEAD;
+    double n = ceil((8.0 * pl - 4.0 * sf + 28 + 16) / (4.0 * (sf - 2 * de))) * 5;
+
+    return (twr_tick_t) ceil((8 + 4.25 + 8 + (n > 0 ? n : 0)) * t_symbol);
+}
+
+static bool _twr_cmwx1zzabz_send(twr_cmwx1zzabz_t *self, const void *buffer, size_t length, bool confirmed)
+{
+    if (!self->_ready || length > sizeof(self->_message_buffer))
+    {
+        sim_stats.uplinks_rejected++;
+
+        return false;
+    }
+
+    memcpy(self->_message_buffer, buffer, length);
+
+    self->_message_length = length;
+    self->_confirmed = confirmed;
+    self->_message_retransmissions = 0;
+    self->_ready = false;
+    self->_state = _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_START;
+
+    twr_scheduler_plan_from_now(self->_task_id, _TWR_CMWX1ZZABZ_COMMAND_TIME);
+
+    return true;
+}
+
+static void _twr_cmwx1zzabz_event(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event)
+{
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, event, self->_event_param);
+    }
+}
+
+static void _twr_cmwx1zzabz_task(void *param)
+{
+    twr_cmwx1zzabz_t *self = param;
+
+    switch (self->_state)
+    {
+        case _TWR_CMWX1ZZABZ_STATE_BOOT:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_READY);
+
+            break;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_START:
+        {
+            if (!sim_lora_modem_up(twr_tick_get()))
+            {
+                sim_stats.uplink_errors++;
+
+                self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+                self->_ready = true;
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_ERROR);
+
+                break;
+            }
+
+            sim_uplink_t uplink = {
+                .tick = twr_tick_get(),
+                .port = self->_message_port,
+                .confirmed = self->_confirmed,
+                .datarate = self->_datarate,
+                .airtime = sim_lora_airtime(self->_band, self->_datarate, self->_message_length),
+                .length = self->_message_length
+            };
+
+            memcpy(uplink.data, self->_message_buffer, self->_message_length);
+
+            sim_uplink_record(&uplink);
+
+            self->_message_tick = uplink.tick;
+
+            self->_state = _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_DONE;
+
+            twr_scheduler_plan_current_from_now(uplink.airtime + _TWR_CMWX1ZZABZ_RX_WINDOWS_TIME);
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START);
+
+            break;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_DONE:
+        {
+            bool acknowledged = sim_lora_ack_up(self->_message_tick);
+
+            if (self->_confirmed && !acknowledged && self->_message_retransmissions < _TWR_CMWX1ZZABZ_RETRANSMISSIONS)
+            {
+                twr_tick_t airtime = sim_lora_airtime(self->_band, self->_datarate, self->_message_length);
+
+                self->_message_retransmissions++;
+                self->_message_tick = twr_tick_get();
+
+                sim_retransmission_record(self->_message_tick, airtime);
+
+                twr_scheduler_plan_current_from_now(airtime + _TWR_CMWX1ZZABZ_RX_WINDOWS_TIME);
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_MESSAGE_RETRANSMISSION);
+
+                break;
+            }
+
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            if (self->_confirmed)
+            {
+                _twr_cmwx1zzabz_event(self, acknowledged ? TWR_CMWX1ZZABZ_EVENT_MESSAGE_CONFIRMED : TWR_CMWX1ZZABZ_EVENT_MESSAGE_NOT_CONFIRMED);
+            }
+
+            sim_downlink_t downlink;
+
+            if (sim_lora_link_up(self->_message_tick) && sim_downlink_take(self->_message_tick, &downlink))
+            {
+                memcpy(self->_received_buffer, downlink.data, downlink.length);
+
+                self->_received_length = downlink.length;
+                self->_received_port = downlink.port;
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_MESSAGE_RECEIVED);
+            }
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE);
+
+            break;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_JOIN:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS);
+
+            break;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_IDLE:
+        default:
+        {
+            break;
+        }
+    }
+}
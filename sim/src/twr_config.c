@@ -0,0 +1,111 @@
+#include <twr_config.h>
+#include <twr_eeprom.h>
+
+#define _TWR_CONFIG_EEPROM_ADDRESS 0
+
+typedef struct
+{
+    uint64_t signature;
+    uint32_t size;
+    uint32_t crc;
+
+} _twr_config_header_t;
+
+static struct
+{
+    uint64_t signature;
+    void *config;
+    size_t size;
+    void *init_config;
+
+} _twr_config;
+
+static uint32_t _twr_config_crc(const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    uint32_t crc = 0xffffffff;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+
+        for (int j = 0; j < 8; j++)
+        {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+    }
+
+    return ~crc;
+}
+
+void twr_config_init(uint64_t signature, void *config, size_t size, void *init_config)
+{
+    _twr_config.signature = signature;
+    _twr_config.config = config;
+    _twr_config.size = size;
+    _twr_config.init_config = init_config;
+
+    if (!twr_config_load())
+    {
+        twr_config_reset();
+    }
+}
+
+bool twr_config_load(void)
+{
+    _twr_config_header_t header;
+
+    if (!twr_eeprom_read(_TWR_CONFIG_EEPROM_ADDRESS, &header, sizeof(header)))
+    {
+        return false;
+    }
+
+    if (header.signature != _twr_config.signature || header.size != _twr_config.size)
+    {
+        return false;
+    }
+
+    uint8_t buffer[header.size];
+
+    if (!twr_eeprom_read(_TWR_CONFIG_EEPROM_ADDRESS + sizeof(header), buffer, header.size))
+    {
+        return false;
+    }
+
+    if (header.crc != _twr_config_crc(buffer, header.size))
+    {
+        return false;
+    }
+
+    memcpy(_twr_config.config, buffer, header.size);
+
+    return true;
+}
+
+bool twr_config_save(void)
+{
+    _twr_config_header_t header = {
+        .signature = _twr_config.signature,
+        .size = _twr_config.size,
+        .crc = _twr_config_crc(_twr_config.config, _twr_config.size)
+    };
+
+    if (!twr_eeprom_write(_TWR_CONFIG_EEPROM_ADDRESS + sizeof(header), _twr_config.config, _twr_config.size))
+    {
+        return false;
+    }
+
+    return twr_eeprom_write(_TWR_CONFIG_EEPROM_ADDRESS, &header, sizeof(header));
+}
+
+void twr_config_reset(void)
+{
+    if (_twr_config.init_config != NULL)
+    {
+        memcpy(_twr_config.config, _twr_config.init_config, _twr_config.size);
+    }
+    else
+    {
+        memset(_twr_config.config, 0, _twr_config.size);
+    }
+}
@@ -0,0 +1,252 @@
+#include <twr_data_stream.h>
+
+static int _twr_data_stream_compare_float(const void *a, const void *b);
+static int _twr_data_stream_compare_int(const void *a, const void *b);
+
+void twr_data_stream_init(twr_data_stream_t *self, int min_number_of_samples, twr_data_stream_buffer_t *buffer)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_buffer = buffer;
+    self->_min_number_of_samples = min_number_of_samples;
+}
+
+void twr_data_stream_feed(twr_data_stream_t *self, void *data)
+{
+    if (data == NULL)
+    {
+        twr_data_stream_reset(self);
+
+        return;
+    }
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        if (isnan(*(float *) data) || isinf(*(float *) data))
+        {
+            twr_data_stream_reset(self);
+
+            return;
+        }
+
+        ((float *) self->_buffer->feed)[self->_feed_head] = *(float *) data;
+    }
+    else
+    {
+        ((int *) self->_buffer->feed)[self->_feed_head] = *(int *) data;
+    }
+
+    self->_counter++;
+
+    if (++self->_feed_head == self->_buffer->number_of_samples)
+    {
+        self->_feed_head = 0;
+    }
+
+    if (self->_fill_level < self->_buffer->number_of_samples)
+    {
+        self->_fill_level++;
+    }
+}
+
+void twr_data_stream_reset(twr_data_stream_t *self)
+{
+    self->_counter = 0;
+    self->_feed_head = 0;
+    self->_fill_level = 0;
+}
+
+int twr_data_stream_get_counter(twr_data_stream_t *self)
+{
+    return self->_counter;
+}
+
+int twr_data_stream_get_length(twr_data_stream_t *self)
+{
+    return self->_fill_level;
+}
+
+twr_data_stream_type_t twr_data_stream_get_type(twr_data_stream_t *self)
+{
+    return self->_buffer->type;
+}
+
+int twr_data_stream_get_number_of_samples(twr_data_stream_t *self)
+{
+    return self->_buffer->number_of_samples;
+}
+
+bool twr_data_stream_get_average(twr_data_stream_t *self, void *result)
+{
+    if (self->_fill_level == 0 || self->_counter < self->_min_number_of_samples)
+    {
+        return false;
+    }
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        float sum = 0;
+
+        for (int i = 0; i < self->_fill_level; i++)
+        {
+            sum += ((float *) self->_buffer->feed)[i];
+        }
+
+        *(float *) result = sum / self->_fill_level;
+    }
+    else
+    {
+        int64_t sum = 0;
+
+        for (int i = 0; i < self->_fill_level; i++)
+        {
+            sum += ((int *) self->_buffer->feed)[i];
+        }
+
+        *(int *) result = sum / self->_fill_level;
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_median(twr_data_stream_t *self, void *result)
+{
+    if (self->_fill_level == 0 || self->_counter < self->_min_number_of_samples)
+    {
+        return false;
+    }
+
+    int middle = self->_fill_level / 2;
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        float *sort = self->_buffer->sort;
+
+        memcpy(sort, self->_buffer->feed, self->_fill_level * sizeof(float));
+        qsort(sort, self->_fill_level, sizeof(float), _twr_data_stream_compare_float);
+
+        *(float *) result = (self->_fill_level % 2) ? sort[middle] : (sort[middle - 1] + sort[middle]) / 2.f;
+    }
+    else
+    {
+        int *sort = self->_buffer->sort;
+
+        memcpy(sort, self->_buffer->feed, self->_fill_level * sizeof(int));
+        qsort(sort, self->_fill_level, sizeof(int), _twr_data_stream_compare_int);
+
+        *(int *) result = (self->_fill_level % 2) ? sort[middle] : (sort[middle - 1] + sort[middle]) / 2;
+    }
+
+    return true;
+}
+
+static bool _twr_data_stream_get_nth(twr_data_stream_t *self, int n, void *result)
+{
+    if (self->_fill_level == 0 || self->_counter < self->_min_number_of_samples)
+    {
+        return false;
+    }
+
+    int position = self->_fill_level < self->_buffer->number_of_samples ? n : (self->_feed_head + n) % self->_fill_level;
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        *(float *) result = ((float *) self->_buffer->feed)[position];
+    }
+    else
+    {
+        *(int *) result = ((int *) self->_buffer->feed)[position];
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_first(twr_data_stream_t *self, void *result)
+{
+    return _twr_data_stream_get_nth(self, 0, result);
+}
+
+bool twr_data_stream_get_last(twr_data_stream_t *self, void *result)
+{
+    return _twr_data_stream_get_nth(self, self->_fill_level - 1, result);
+}
+
+bool twr_data_stream_get_max(twr_data_stream_t *self, void *result)
+{
+    if (self->_fill_level == 0 || self->_counter < self->_min_number_of_samples)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < self->_fill_level; i++)
+    {
+        if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+        {
+            float value = ((float *) self->_buffer->feed)[i];
+
+            if (i == 0 || value > *(float *) result)
+            {
+                *(float *) result = value;
+            }
+        }
+        else
+        {
+            int value = ((int *) self->_buffer->feed)[i];
+
+            if (i == 0 || value > *(int *) result)
+            {
+                *(int *) result = value;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_min(twr_data_stream_t *self, void *result)
+{
+    if (self->_fill_level == 0 || self->_counter < self->_min_number_of_samples)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < self->_fill_level; i++)
+    {
+        if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+        {
+            float value = ((float *) self->_buffer->feed)[i];
+
+            if (i == 0 || value < *(float *) result)
+            {
+                *(float *) result = value;
+            }
+        }
+        else
+        {
+            int value = ((int *) self->_buffer->feed)[i];
+
+            if (i == 0 || value < *(int *) result)
+            {
+                *(int *) result = value;
+            }
+        }
+    }
+
+    return true;
+}
+
+static int _twr_data_stream_compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *) a;
+    float fb = *(const float *) b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static int _twr_data_stream_compare_int(const void *a, const void *b)
+{
+    int ia = *(const int *) a;
+    int ib = *(const int *) b;
+
+    return (ia > ib) - (ia < ib);
+}
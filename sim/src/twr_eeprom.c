@@ -0,0 +1,91 @@
+#include <twr_eeprom.h>
+#include <sim.h>
+
+// EEPROM contents with a write counter per byte, only bytes that change are programmed
+
+static struct
+{
+    uint8_t data[TWR_EEPROM_SIZE];
+    uint32_t cycles[TWR_EEPROM_SIZE];
+
+} _twr_eeprom;
+
+bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
+{
+    if (address + length > TWR_EEPROM_SIZE)
+    {
+        return false;
+    }
+
+    const uint8_t *data = buffer;
+
+    sim_stats.eeprom_writes++;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (_twr_eeprom.data[address + i] == data[i])
+        {
+            continue;
+        }
+
+        _twr_eeprom.data[address + i] = data[i];
+
+        sim_stats.eeprom_bytes++;
+
+        if (++_twr_eeprom.cycles[address + i] > sim_stats.eeprom_cycles_max)
+        {
+            sim_stats.eeprom_cycles_max = _twr_eeprom.cycles[address + i];
+        }
+    }
+
+    return true;
+}
+
+bool twr_eeprom_read(uint32_t address, void *buffer, size_t length)
+{
+    if (address + length > TWR_EEPROM_SIZE)
+    {
+        return false;
+    }
+
+    memcpy(buffer, _twr_eeprom.data + address, length);
+
+    return true;
+}
+
+size_t twr_eeprom_get_size(void)
+{
+    return TWR_EEPROM_SIZE;
+}
+
+bool sim_eeprom_load(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    size_t length = fread(_twr_eeprom.data, 1, TWR_EEPROM_SIZE, file);
+
+    fclose(file);
+
+    return length == TWR_EEPROM_SIZE;
+}
+
+bool sim_eeprom_save(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    size_t length = fwrite(_twr_eeprom.data, 1, TWR_EEPROM_SIZE, file);
+
+    fclose(file);
+
+    return length == TWR_EEPROM_SIZE;
+}
@@ -0,0 +1,68 @@
+#include <twr_i2c.h>
+#include <sim.h>
+
+void twr_i2c_init(twr_i2c_channel_t channel, twr_i2c_speed_t speed)
+{
+    (void) channel;
+    (void) speed;
+}
+
+bool twr_i2c_write(twr_i2c_channel_t channel, const twr_i2c_transfer_t *transfer)
+{
+    return sim_i2c_transaction(channel, transfer->device_address);
+}
+
+bool twr_i2c_read(twr_i2c_channel_t channel, const twr_i2c_transfer_t *transfer)
+{
+    if (!sim_i2c_transaction(channel, transfer->device_address))
+    {
+        return false;
+    }
+
+    memset(transfer->buffer, 0, transfer->length);
+
+    return true;
+}
+
+bool twr_i2c_memory_read(twr_i2c_channel_t channel, const twr_i2c_memory_transfer_t *transfer)
+{
+    if (!sim_i2c_transaction(channel, transfer->device_address))
+    {
+        return false;
+    }
+
+    sim_i2c_memory_read(channel, transfer->device_address, transfer->memory_address, transfer->buffer, transfer->length);
+
+    return true;
+}
+
+bool twr_i2c_memory_read_8b(twr_i2c_channel_t channel, uint8_t device_address, uint32_t memory_address, uint8_t *data)
+{
+    twr_i2c_memory_transfer_t transfer = {
+        .device_address = device_address,
+        .memory_address = memory_address,
+        .buffer = data,
+        .length = 1
+    };
+
+    return twr_i2c_memory_read(channel, &transfer);
+}
+
+bool twr_i2c_memory_read_16b(twr_i2c_channel_t channel, uint8_t device_address, uint32_t memory_address, uint16_t *data)
+{
+    twr_i2c_memory_transfer_t transfer = {
+        .device_address = device_address,
+        .memory_address = memory_address,
+        .buffer = data,
+        .length = 2
+    };
+
+    if (!twr_i2c_memory_read(channel, &transfer))
+    {
+        return false;
+    }
+
+    *data = (uint16_t) (((uint8_t *) data)[0] << 8 | ((uint8_t *) data)[1]);
+
+    return true;
+}
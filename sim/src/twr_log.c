@@ -0,0 +1,120 @@
+#include <twr_log.h>
+#include <sim.h>
+
+static struct
+{
+    bool initialized;
+    twr_log_level_t level;
+    twr_log_timestamp_t timestamp;
+    twr_tick_t tick_last;
+
+} _twr_log = { .level = TWR_LOG_LEVEL_OFF };
+
+static void _twr_log_message(twr_log_level_t level, char id, const char *format, va_list ap);
+
+void twr_log_init(twr_log_level_t level, twr_log_timestamp_t timestamp)
+{
+    _twr_log.initialized = true;
+    _twr_log.level = level;
+    _twr_log.timestamp = timestamp;
+}
+
+void twr_log_dump(const void *buffer, size_t length, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_log_message(TWR_LOG_LEVEL_DUMP, 'X', format, ap);
+    va_end(ap);
+
+    if (_twr_log.initialized && _twr_log.level <= TWR_LOG_LEVEL_DUMP)
+    {
+        char line[4];
+
+        for (size_t i = 0; i < length; i++)
+        {
+            int n = snprintf(line, sizeof(line), "%02X ", ((const uint8_t *) buffer)[i]);
+
+            sim_uart_write(line, n);
+        }
+
+        sim_uart_write("\r\n", 2);
+    }
+}
+
+void twr_log_debug(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_log_message(TWR_LOG_LEVEL_DEBUG, 'D', format, ap);
+    va_end(ap);
+}
+
+void twr_log_info(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_log_message(TWR_LOG_LEVEL_INFO, 'I', format, ap);
+    va_end(ap);
+}
+
+void twr_log_warning(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_log_message(TWR_LOG_LEVEL_WARNING, 'W', format, ap);
+    va_end(ap);
+}
+
+void twr_log_error(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_log_message(TWR_LOG_LEVEL_ERROR, 'E', format, ap);
+    va_end(ap);
+}
+
+static void _twr_log_message(twr_log_level_t level, char id, const char *format, va_list ap)
+{
+    if (!_twr_log.initialized || level < _twr_log.level)
+    {
+        return;
+    }
+
+    char buffer[256];
+    int offset = 0;
+    twr_tick_t tick = twr_tick_get();
+
+    if (_twr_log.timestamp == TWR_LOG_TIMESTAMP_ABS)
+    {
+        offset = snprintf(buffer, sizeof(buffer), "# %llu.%03u <%c> ", (unsigned long long) (tick / 1000), (unsigned) (tick % 1000), id);
+    }
+    else if (_twr_log.timestamp == TWR_LOG_TIMESTAMP_REL)
+    {
+        twr_tick_t delta = tick - _twr_log.tick_last;
+
+        _twr_log.tick_last = tick;
+
+        offset = snprintf(buffer, sizeof(buffer), "# +%llu.%03u <%c> ", (unsigned long long) (delta / 1000), (unsigned) (delta % 1000), id);
+    }
+    else
+    {
+        offset = snprintf(buffer, sizeof(buffer), "# <%c> ", id);
+    }
+
+    offset += vsnprintf(buffer + offset, sizeof(buffer) - offset, format, ap);
+
+    if (offset > (int) sizeof(buffer) - 3)
+    {
+        offset = sizeof(buffer) - 3;
+    }
+
+    buffer[offset++] = '\r';
+    buffer[offset++] = '\n';
+
+    sim_uart_write(buffer, offset);
+}
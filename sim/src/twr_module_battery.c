@@ -0,0 +1,109 @@
+#include <twr_module_battery.h>
+#include <sim.h>
+
+// Load enable, ADC settle and conversion, no bus traffic
+static const twr_tick_t _twr_module_battery_phase_delay[] = { 0, 100 };
+
+// Default thresholds of the SDK in percent, the level events precede the update of the measurement
+#define _TWR_MODULE_BATTERY_LEVEL_LOW 10
+#define _TWR_MODULE_BATTERY_LEVEL_CRITICAL 5
+
+static const sim_sensor_profile_t _twr_module_battery_profile = {
+    .name = "battery",
+    .phase_delay = _twr_module_battery_phase_delay,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_module_battery_phase_delay),
+    .transactions_per_phase = 0
+};
+
+static struct
+{
+    sim_sensor_t sensor;
+    void (*event_handler)(twr_module_battery_event_t, void *);
+    void *event_param;
+    float voltage;
+
+} _twr_module_battery;
+
+static void _twr_module_battery_complete(sim_sensor_t *sensor, bool ok);
+
+void twr_module_battery_init(void)
+{
+    memset(&_twr_module_battery, 0, sizeof(_twr_module_battery));
+
+    _twr_module_battery.voltage = NAN;
+
+    sim_sensor_init(&_twr_module_battery.sensor, &_twr_module_battery_profile, TWR_I2C_I2C0, 0, _twr_module_battery_complete, NULL);
+}
+
+void twr_module_battery_set_event_handler(void (*event_handler)(twr_module_battery_event_t, void *), void *event_param)
+{
+    _twr_module_battery.event_handler = event_handler;
+    _twr_module_battery.event_param = event_param;
+}
+
+void twr_module_battery_set_update_interval(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_battery.sensor, interval);
+}
+
+bool twr_module_battery_measure(void)
+{
+    return sim_sensor_measure(&_twr_module_battery.sensor);
+}
+
+bool twr_module_battery_get_voltage(float *voltage)
+{
+    if (isnan(_twr_module_battery.voltage))
+    {
+        return false;
+    }
+
+    *voltage = _twr_module_battery.voltage;
+
+    return true;
+}
+
+bool twr_module_battery_get_charge_level(int *percentage)
+{
+    if (isnan(_twr_module_battery.voltage))
+    {
+        return false;
+    }
+
+    // Two AAA cells, linear between 1.8 V and 3.2 V
+    float level = (_twr_module_battery.voltage - 1.8f) / (3.2f - 1.8f) * 100.f;
+
+    *percentage = level < 0 ? 0 : level > 100 ? 100 : (int) level;
+
+    return true;
+}
+
+static void _twr_module_battery_complete(sim_sensor_t *sensor, bool ok)
+{
+    (void) sensor;
+    (void) ok;
+
+    sim_stats.adc_reads++;
+
+    _twr_module_battery.voltage = sim_scenario_get()->voltage(twr_tick_get());
+
+    if (sim_lora_transmitting(twr_tick_get()))
+    {
+        _twr_module_battery.voltage -= sim_scenario_get()->voltage_tx_drop;
+    }
+
+    if (_twr_module_battery.event_handler == NULL)
+    {
+        return;
+    }
+
+    int level;
+
+    if (twr_module_battery_get_charge_level(&level) && level <= _TWR_MODULE_BATTERY_LEVEL_LOW)
+    {
+        _twr_module_battery.event_handler(level <= _TWR_MODULE_BATTERY_LEVEL_CRITICAL ? TWR_MODULE_BATTERY_EVENT_LEVEL_CRITICAL : TWR_MODULE_BATTERY_EVENT_LEVEL_LOW,
+                                          _twr_module_battery.event_param);
+    }
+
+    _twr_module_battery.event_handler(isnan(_twr_module_battery.voltage) ? TWR_MODULE_BATTERY_EVENT_ERROR : TWR_MODULE_BATTERY_EVENT_UPDATE, _twr_module_battery.event_param);
+}
@@ -0,0 +1,92 @@
+#include <twr_module_co2.h>
+#include <sim.h>
+
+// LP8 behind the SC16IS740 UART bridge on I2C0: charge, boot, measure and read back
+#define _TWR_MODULE_CO2_I2C_ADDRESS 0x4d
+
+static const twr_tick_t _twr_module_co2_phase_delay[] = { 0, 40, 150, 250 };
+
+static const sim_sensor_profile_t _twr_module_co2_profile = {
+    .name = "co2",
+    .phase_delay = _twr_module_co2_phase_delay,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_module_co2_phase_delay),
+    .transactions_per_phase = 2
+};
+
+static struct
+{
+    sim_sensor_t sensor;
+    void (*event_handler)(twr_module_co2_event_t, void *);
+    void *event_param;
+    bool valid;
+    float ppm;
+    twr_lp8_calibration_t calibration;
+    bool calibration_request;
+
+} _twr_module_co2;
+
+static void _twr_module_co2_complete(sim_sensor_t *sensor, bool ok);
+
+void twr_module_co2_init(void)
+{
+    memset(&_twr_module_co2, 0, sizeof(_twr_module_co2));
+
+    sim_sensor_init(&_twr_module_co2.sensor, &_twr_module_co2_profile, TWR_I2C_I2C0, _TWR_MODULE_CO2_I2C_ADDRESS, _twr_module_co2_complete, NULL);
+}
+
+void twr_module_co2_set_event_handler(void (*event_handler)(twr_module_co2_event_t, void *), void *event_param)
+{
+    _twr_module_co2.event_handler = event_handler;
+    _twr_module_co2.event_param = event_param;
+}
+
+void twr_module_co2_set_update_interval(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_co2.sensor, interval);
+}
+
+bool twr_module_co2_measure(void)
+{
+    return sim_sensor_measure(&_twr_module_co2.sensor);
+}
+
+bool twr_module_co2_get_concentration_ppm(float *ppm)
+{
+    if (!_twr_module_co2.valid)
+    {
+        return false;
+    }
+
+    *ppm = _twr_module_co2.ppm;
+
+    return true;
+}
+
+bool twr_module_co2_get_error(twr_lp8_error_t *error)
+{
+    *error = TWR_LP8_ERROR_MODBUS_TIMEOUT;
+
+    return !_twr_module_co2.valid;
+}
+
+void twr_module_co2_calibration(twr_lp8_calibration_t calibration)
+{
+    _twr_module_co2.calibration = calibration;
+    _twr_module_co2.calibration_request = true;
+}
+
+static void _twr_module_co2_complete(sim_sensor_t *sensor, bool ok)
+{
+    (void) sensor;
+
+    sim_stats.co2_measurements++;
+
+    _twr_module_co2.ppm = ok ? sim_scenario_get()->co2_ppm(twr_tick_get()) : NAN;
+    _twr_module_co2.valid = !isnan(_twr_module_co2.ppm);
+    _twr_module_co2.calibration_request = false;
+
+    if (_twr_module_co2.event_handler != NULL)
+    {
+        _twr_module_co2.event_handler(_twr_module_co2.valid ? TWR_MODULE_CO2_EVENT_UPDATE : TWR_MODULE_CO2_EVENT_ERROR, _twr_module_co2.event_param);
+    }
+}
@@ -0,0 +1,164 @@
+#include <twr_scheduler.h>
+#include <sim.h>
+
+static struct
+{
+    struct
+    {
+        twr_tick_t tick_execution;
+        void (*task)(void *);
+        void *param;
+
+    } pool[TWR_SCHEDULER_MAX_TASKS];
+
+    twr_tick_t tick;
+    twr_tick_t tick_spin;
+    twr_scheduler_task_id_t current_task_id;
+    twr_scheduler_task_id_t max_task_id;
+
+} _twr_scheduler;
+
+twr_tick_t twr_tick_get(void)
+{
+    return _twr_scheduler.tick;
+}
+
+void sim_tick_set(twr_tick_t tick)
+{
+    _twr_scheduler.tick = tick;
+}
+
+void twr_scheduler_init(void)
+{
+    memset(&_twr_scheduler, 0, sizeof(_twr_scheduler));
+}
+
+void sim_scheduler_run(twr_tick_t until)
+{
+    for (;;)
+    {
+        twr_tick_t next = TWR_TICK_INFINITY;
+
+        for (size_t i = 0; i <= _twr_scheduler.max_task_id; i++)
+        {
+            if (_twr_scheduler.pool[i].task != NULL && _twr_scheduler.pool[i].tick_execution < next)
+            {
+                next = _twr_scheduler.pool[i].tick_execution;
+            }
+        }
+
+        if (next > until)
+        {
+            // The caller injects an AT command or a button event, on the unit its driver task runs in a pass of its own
+            _twr_scheduler.tick = until;
+            _twr_scheduler.tick_spin = until;
+
+            return;
+        }
+
+        // Sleeping until the next planned task costs one wakeup
+        if (next > _twr_scheduler.tick)
+        {
+            _twr_scheduler.tick = next;
+
+            sim_stats.wakeups++;
+        }
+
+        _twr_scheduler.tick_spin = _twr_scheduler.tick;
+
+        for (size_t i = 0; i <= _twr_scheduler.max_task_id; i++)
+        {
+            if (_twr_scheduler.pool[i].task == NULL || _twr_scheduler.pool[i].tick_execution > _twr_scheduler.tick_spin)
+            {
+                continue;
+            }
+
+            _twr_scheduler.current_task_id = i;
+            _twr_scheduler.pool[i].tick_execution = TWR_TICK_INFINITY;
+
+            sim_stats.dispatches++;
+
+            _twr_scheduler.pool[i].task(_twr_scheduler.pool[i].param);
+        }
+    }
+}
+
+twr_scheduler_task_id_t twr_scheduler_register(void (*task)(void *), void *param, twr_tick_t tick)
+{
+    for (size_t i = 0; i < TWR_SCHEDULER_MAX_TASKS; i++)
+    {
+        if (_twr_scheduler.pool[i].task == NULL)
+        {
+            _twr_scheduler.pool[i].tick_execution = tick;
+            _twr_scheduler.pool[i].task = task;
+            _twr_scheduler.pool[i].param = param;
+
+            if (_twr_scheduler.max_task_id < i)
+            {
+                _twr_scheduler.max_task_id = i;
+            }
+
+            return i;
+        }
+    }
+
+    fprintf(stderr, "sim: scheduler pool exhausted (TWR_SCHEDULER_MAX_TASKS %d)\n", TWR_SCHEDULER_MAX_TASKS);
+
+    abort();
+}
+
+void twr_scheduler_unregister(twr_scheduler_task_id_t task_id)
+{
+    _twr_scheduler.pool[task_id].task = NULL;
+    _twr_scheduler.pool[task_id].tick_execution = TWR_TICK_INFINITY;
+}
+
+twr_scheduler_task_id_t twr_scheduler_get_current_task_id(void)
+{
+    return _twr_scheduler.current_task_id;
+}
+
+twr_tick_t twr_scheduler_get_spin_tick(void)
+{
+    return _twr_scheduler.tick_spin;
+}
+
+void twr_scheduler_plan_now(twr_scheduler_task_id_t task_id)
+{
+    _twr_scheduler.pool[task_id].tick_execution = 0;
+}
+
+void twr_scheduler_plan_absolute(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick_execution = tick;
+}
+
+void twr_scheduler_plan_relative(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick_execution = _twr_scheduler.tick_spin + tick;
+}
+
+void twr_scheduler_plan_from_now(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick_execution = _twr_scheduler.tick + tick;
+}
+
+void twr_scheduler_plan_current_now(void)
+{
+    twr_scheduler_plan_now(_twr_scheduler.current_task_id);
+}
+
+void twr_scheduler_plan_current_absolute(twr_tick_t tick)
+{
+    twr_scheduler_plan_absolute(_twr_scheduler.current_task_id, tick);
+}
+
+void twr_scheduler_plan_current_relative(twr_tick_t tick)
+{
+    twr_scheduler_plan_relative(_twr_scheduler.current_task_id, tick);
+}
+
+void twr_scheduler_plan_current_from_now(twr_tick_t tick)
+{
+    twr_scheduler_plan_from_now(_twr_scheduler.current_task_id, tick);
+}
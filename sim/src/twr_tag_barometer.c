@@ -0,0 +1,65 @@
+#include <twr_tag_barometer.h>
+#include <sim.h>
+
+// MPL3115A2 one-shot altitude and pressure conversions
+static const twr_tick_t _twr_tag_barometer_phase_delay[] = { 0, 550, 550 };
+
+static const sim_sensor_profile_t _twr_tag_barometer_profile = {
+    .name = "barometer",
+    .phase_delay = _twr_tag_barometer_phase_delay,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_tag_barometer_phase_delay),
+    .transactions_per_phase = 2
+};
+
+static void _twr_tag_barometer_complete(sim_sensor_t *sensor, bool ok);
+
+void twr_tag_barometer_init(twr_tag_barometer_t *self, twr_i2c_channel_t i2c_channel)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_pascal = NAN;
+
+    sim_sensor_init(&self->_sensor, &_twr_tag_barometer_profile, i2c_channel, TWR_TAG_BAROMETER_I2C_ADDRESS_DEFAULT, _twr_tag_barometer_complete, self);
+}
+
+void twr_tag_barometer_set_event_handler(twr_tag_barometer_t *self, void (*event_handler)(twr_tag_barometer_t *, twr_tag_barometer_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_tag_barometer_set_update_interval(twr_tag_barometer_t *self, twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool twr_tag_barometer_measure(twr_tag_barometer_t *self)
+{
+    return sim_sensor_measure(&self->_sensor);
+}
+
+bool twr_tag_barometer_get_pressure_pascal(twr_tag_barometer_t *self, float *pascal)
+{
+    if (isnan(self->_pascal))
+    {
+        return false;
+    }
+
+    *pascal = self->_pascal;
+
+    return true;
+}
+
+static void _twr_tag_barometer_complete(sim_sensor_t *sensor, bool ok)
+{
+    twr_tag_barometer_t *self = sensor->_owner;
+
+    sim_stats.barometer_measurements++;
+
+    self->_pascal = ok ? sim_scenario_get()->pressure(twr_tick_get()) : NAN;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, isnan(self->_pascal) ? TWR_TAG_BAROMETER_EVENT_ERROR : TWR_TAG_BAROMETER_EVENT_UPDATE, self->_event_param);
+    }
+}
@@ -0,0 +1,101 @@
+#include <twr_tag_humidity.h>
+#include <sim.h>
+
+// HTS221 (R1), HDC2080 (R2), SHT20 (R3) and SHT30 (R4)
+static const uint8_t _twr_tag_humidity_i2c_address[][2] = {
+    [TWR_TAG_HUMIDITY_REVISION_R1] = { 0x5f, 0x5f },
+    [TWR_TAG_HUMIDITY_REVISION_R2] = { 0x40, 0x41 },
+    [TWR_TAG_HUMIDITY_REVISION_R3] = { 0x40, 0x40 },
+    [TWR_TAG_HUMIDITY_REVISION_R4] = { 0x44, 0x45 }
+};
+
+static const twr_tick_t _twr_tag_humidity_phase_delay[] = { 0, 50 };
+
+static const twr_tick_t _twr_tag_humidity_phase_delay_sht20[] = { 0, 30, 85 };
+
+static const sim_sensor_profile_t _twr_tag_humidity_profile = {
+    .name = "humidity",
+    .phase_delay = _twr_tag_humidity_phase_delay,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_tag_humidity_phase_delay),
+    .transactions_per_phase = 1
+};
+
+static const sim_sensor_profile_t _twr_tag_humidity_profile_sht20 = {
+    .name = "humidity",
+    .phase_delay = _twr_tag_humidity_phase_delay_sht20,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_tag_humidity_phase_delay_sht20),
+    .transactions_per_phase = 1
+};
+
+static void _twr_tag_humidity_complete(sim_sensor_t *sensor, bool ok);
+
+void twr_tag_humidity_init(twr_tag_humidity_t *self, twr_tag_humidity_revision_t revision, twr_i2c_channel_t i2c_channel, twr_tag_humidity_i2c_address_t i2c_address)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_revision = revision;
+    self->_humidity = NAN;
+    self->_temperature = NAN;
+
+    sim_sensor_init(&self->_sensor, revision == TWR_TAG_HUMIDITY_REVISION_R3 ? &_twr_tag_humidity_profile_sht20 : &_twr_tag_humidity_profile,
+                    i2c_channel, _twr_tag_humidity_i2c_address[revision][i2c_address], _twr_tag_humidity_complete, self);
+}
+
+void twr_tag_humidity_set_event_handler(twr_tag_humidity_t *self, void (*event_handler)(twr_tag_humidity_t *, twr_tag_humidity_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_tag_humidity_set_update_interval(twr_tag_humidity_t *self, twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool twr_tag_humidity_measure(twr_tag_humidity_t *self)
+{
+    return sim_sensor_measure(&self->_sensor);
+}
+
+bool twr_tag_humidity_get_humidity_percentage(twr_tag_humidity_t *self, float *percentage)
+{
+    if (isnan(self->_humidity))
+    {
+        return false;
+    }
+
+    *percentage = self->_humidity;
+
+    return true;
+}
+
+bool twr_tag_humidity_get_temperature_celsius(twr_tag_humidity_t *self, float *celsius)
+{
+    if (isnan(self->_temperature))
+    {
+        return false;
+    }
+
+    *celsius = self->_temperature;
+
+    return true;
+}
+
+static void _twr_tag_humidity_complete(sim_sensor_t *sensor, bool ok)
+{
+    twr_tag_humidity_t *self = sensor->_owner;
+    const sim_scenario_t *scenario = sim_scenario_get();
+
+    // A different chip answering on a shared address fails the identification
+    ok = ok && sensor->_i2c_channel <= TWR_I2C_I2C1 && scenario->humidity_revision[sensor->_i2c_channel] == (int) self->_revision;
+
+    sim_stats.humidity_measurements++;
+
+    self->_humidity = ok ? scenario->humidity(twr_tick_get(), sensor->_i2c_channel) : NAN;
+    self->_temperature = ok ? scenario->temperature(twr_tick_get(), sensor->_i2c_channel) : NAN;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, ok ? TWR_TAG_HUMIDITY_EVENT_UPDATE : TWR_TAG_HUMIDITY_EVENT_ERROR, self->_event_param);
+    }
+}
@@ -0,0 +1,65 @@
+#include <twr_tag_voc_lp.h>
+#include <sim.h>
+
+// SGP40 raw signal command, conversion and read back
+static const twr_tick_t _twr_tag_voc_lp_phase_delay[] = { 0, 30 };
+
+static const sim_sensor_profile_t _twr_tag_voc_lp_profile = {
+    .name = "voc_lp",
+    .phase_delay = _twr_tag_voc_lp_phase_delay,
+    .phase_count = TWR_ARRAY_LENGTH(_twr_tag_voc_lp_phase_delay),
+    .transactions_per_phase = 1
+};
+
+static void _twr_tag_voc_lp_complete(sim_sensor_t *sensor, bool ok);
+
+void twr_tag_voc_lp_init(twr_tag_voc_lp_t *self, twr_i2c_channel_t i2c_channel)
+{
+    memset(self, 0, sizeof(*self));
+
+    sim_sensor_init(&self->_sensor, &_twr_tag_voc_lp_profile, i2c_channel, TWR_TAG_VOC_LP_I2C_ADDRESS_DEFAULT, _twr_tag_voc_lp_complete, self);
+}
+
+void twr_tag_voc_lp_set_event_handler(twr_tag_voc_lp_t *self, void (*event_handler)(twr_tag_voc_lp_t *, twr_tag_voc_lp_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_tag_voc_lp_set_update_interval(twr_tag_voc_lp_t *self, twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&self->_sensor, interval);
+}
+
+bool twr_tag_voc_lp_measure(twr_tag_voc_lp_t *self)
+{
+    return sim_sensor_measure(&self->_sensor);
+}
+
+bool twr_tag_voc_lp_get_tvoc_ppb(twr_tag_voc_lp_t *self, uint16_t *tvoc)
+{
+    if (!self->_valid)
+    {
+        return false;
+    }
+
+    *tvoc = self->_tvoc;
+
+    return true;
+}
+
+static void _twr_tag_voc_lp_complete(sim_sensor_t *sensor, bool ok)
+{
+    twr_tag_voc_lp_t *self = sensor->_owner;
+    float value = ok ? sim_scenario_get()->tvoc_ppb(twr_tick_get()) : NAN;
+
+    sim_stats.voc_measurements++;
+
+    self->_valid = !isnan(value);
+    self->_tvoc = self->_valid ? (uint16_t) value : 0;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, self->_valid ? TWR_TAG_VOC_LP_EVENT_UPDATE : TWR_TAG_VOC_LP_EVENT_ERROR, self->_event_param);
+    }
+}
@@ -0,0 +1,91 @@
+#include <twr_uart.h>
+#include <sim.h>
+
+// Transmit FIFO of the console is drained at 115200 Bd, 8N1
+#define _TWR_UART_BYTES_PER_SECOND (115200 / 10)
+
+static struct
+{
+    twr_fifo_t *write_fifo;
+    size_t level;
+    twr_tick_t tick;
+    bool full;
+
+} _twr_uart;
+
+void twr_fifo_init(twr_fifo_t *fifo, void *buffer, size_t size)
+{
+    fifo->buffer = buffer;
+    fifo->size = size;
+    fifo->head = 0;
+    fifo->tail = 0;
+}
+
+void twr_uart_set_async_fifo(twr_uart_channel_t channel, twr_fifo_t *write_fifo, twr_fifo_t *read_fifo)
+{
+    if (channel == TWR_UART_UART2)
+    {
+        _twr_uart.write_fifo = write_fifo;
+    }
+}
+
+// Bytes left in the transmit FIFO after draining it for the time since the last call
+static void _twr_uart_drain(void)
+{
+    twr_tick_t now = twr_tick_get();
+    size_t drained = (size_t) ((now - _twr_uart.tick) * _TWR_UART_BYTES_PER_SECOND / 1000);
+
+    _twr_uart.level = drained < _twr_uart.level ? _twr_uart.level - drained : 0;
+    _twr_uart.full = _twr_uart.full && now == _twr_uart.tick;
+    _twr_uart.tick = now;
+}
+
+size_t twr_uart_write(twr_uart_channel_t channel, const void *buffer, size_t length)
+{
+    if (channel != TWR_UART_UART2)
+    {
+        return 0;
+    }
+
+    _twr_uart_drain();
+
+    if (_twr_uart.level > 0)
+    {
+        sim_stats.uart_refused += length;
+
+        return 0;
+    }
+
+    sim_uart_write(buffer, length);
+
+    return length;
+}
+
+size_t twr_uart_async_write(twr_uart_channel_t channel, const void *buffer, size_t length)
+{
+    if (channel != TWR_UART_UART2 || _twr_uart.write_fifo == NULL)
+    {
+        return 0;
+    }
+
+    _twr_uart_drain();
+
+    if (_twr_uart.full)
+    {
+        _twr_uart.level = 0;
+    }
+
+    size_t free = _twr_uart.write_fifo->size - _twr_uart.level;
+
+    if (length > free)
+    {
+        length = free;
+    }
+
+    _twr_uart.level += length;
+    _twr_uart.full = _twr_uart.level == _twr_uart.write_fifo->size;
+
+    sim_uart_write(buffer, length);
+
+    return length;
+}
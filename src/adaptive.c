@@ -0,0 +1,68 @@
+#include <adaptive.h>
+
+void adaptive_init(adaptive_t *self, const adaptive_config_t *config)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_config = config;
+
+    adaptive_reset(self);
+}
+
+void adaptive_reset(adaptive_t *self)
+{
+    self->_interval = self->_config->interval_min;
+    self->_has_last = false;
+}
+
+twr_tick_t adaptive_update(adaptive_t *self, int32_t value, twr_tick_t tick)
+{
+    const adaptive_config_t *config = self->_config;
+
+    if (self->_has_last && tick > self->_last_tick)
+    {
+        // Rates are per minute, compared as products with the elapsed ms
+        int64_t elapsed = tick - self->_last_tick;
+        int64_t delta = (int64_t) value - self->_last_value;
+        int64_t stable = config->stable_rate * elapsed / (60 * 1000);
+
+        if (stable < config->noise)
+        {
+            stable = config->noise;
+        }
+
+        if (delta > config->noise && delta * (60 * 1000) >= config->rise_rate * elapsed)
+        {
+            self->_interval = config->interval_min;
+        }
+        else if ((delta < 0 ? -delta : delta) <= stable)
+        {
+            self->_interval *= 2;
+        }
+        else
+        {
+            self->_interval /= 2;
+        }
+    }
+
+    if (self->_interval > config->interval_max)
+    {
+        self->_interval = config->interval_max;
+    }
+
+    if (self->_interval < config->interval_min)
+    {
+        self->_interval = config->interval_min;
+    }
+
+    self->_has_last = true;
+    self->_last_value = value;
+    self->_last_tick = tick;
+
+    return self->_interval;
+}
+
+twr_tick_t adaptive_get_interval(adaptive_t *self)
+{
+    return self->_interval;
+}
@@ -0,0 +1,45 @@
+#ifndef _ADAPTIVE_H
+#define _ADAPTIVE_H
+
+#include <twr.h>
+
+// Measurement interval driven by the rate of change of the measured value
+//
+// Stable readings double the interval up to the upper bound, a rise faster than
+// rise_rate drops it straight to the lower bound, anything in between halves it.
+// Values and rates are in the fixed point of the window statistics (see payload_field_fixed()).
+
+typedef struct
+{
+    twr_tick_t interval_min;
+    twr_tick_t interval_max;
+    // Change always treated as stable, covers sensor noise
+    int32_t noise;
+    // Change per minute still treated as stable
+    int32_t stable_rate;
+    // Increase per minute that switches to the lower bound
+    int32_t rise_rate;
+
+} adaptive_config_t;
+
+typedef struct
+{
+    const adaptive_config_t *_config;
+    twr_tick_t _interval;
+    bool _has_last;
+    int32_t _last_value;
+    twr_tick_t _last_tick;
+
+} adaptive_t;
+
+void adaptive_init(adaptive_t *self, const adaptive_config_t *config);
+
+// Restart from the lower bound, e.g. after the bounds changed or sampling was paused
+void adaptive_reset(adaptive_t *self);
+
+// Account a new reading and return the interval until the next one
+twr_tick_t adaptive_update(adaptive_t *self, int32_t value, twr_tick_t tick);
+
+twr_tick_t adaptive_get_interval(adaptive_t *self);
+
+#endif // _ADAPTIVE_H
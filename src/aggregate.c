@@ -0,0 +1,125 @@
+#include <aggregate.h>
+
+void aggregate_reset(aggregate_t *self)
+{
+    memset(self, 0, sizeof(*self));
+}
+
+void aggregate_feed(aggregate_t *self, int32_t value)
+{
+    if (self->count == 0)
+    {
+        self->shift = value;
+        self->min = value;
+        self->max = value;
+    }
+
+    int64_t delta = (int64_t) value - self->shift;
+
+    self->count++;
+    self->sum += delta;
+    self->sum_squares += (uint64_t) (delta * delta);
+
+    if (value < self->min)
+    {
+        self->min = value;
+    }
+
+    if (value > self->max)
+    {
+        self->max = value;
+    }
+}
+
+uint32_t aggregate_get_count(aggregate_t *self)
+{
+    return self->count;
+}
+
+int64_t aggregate_get_sum(aggregate_t *self)
+{
+    return (int64_t) self->shift * self->count + self->sum;
+}
+
+bool aggregate_get_mean(aggregate_t *self, int32_t *mean)
+{
+    if (self->count == 0)
+    {
+        return false;
+    }
+
+    int64_t half = self->count / 2;
+
+    *mean = self->shift + (int32_t) (self->sum >= 0 ? (self->sum + half) / self->count : -((-self->sum + half) / self->count));
+
+    return true;
+}
+
+bool aggregate_get_min(aggregate_t *self, int32_t *min)
+{
+    if (self->count == 0)
+    {
+        return false;
+    }
+
+    *min = self->min;
+
+    return true;
+}
+
+bool aggregate_get_max(aggregate_t *self, int32_t *max)
+{
+    if (self->count == 0)
+    {
+        return false;
+    }
+
+    *max = self->max;
+
+    return true;
+}
+
+// Bit by bit square root, floor(sqrt(value))
+static uint32_t _aggregate_sqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (uint32_t) root;
+}
+
+bool aggregate_get_stddev(aggregate_t *self, int32_t *stddev)
+{
+    if (self->count == 0)
+    {
+        return false;
+    }
+
+    // sum^2 / count never exceeds the sum of squares, the difference is the variance times count
+    uint64_t magnitude = self->sum >= 0 ? (uint64_t) self->sum : (uint64_t) -self->sum;
+    uint64_t variance = (self->sum_squares - magnitude * magnitude / self->count) / self->count;
+
+    *stddev = _aggregate_sqrt(variance);
+
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef _AGGREGATE_H
+#define _AGGREGATE_H
+
+#include <twr.h>
+
+// Running statistics of one quantity since the last reset, every operation is O(1)
+//
+// Samples are integers, the application feeds them in fixed point of the wire unit (see
+// payload_field_quantize()) so the statistics need no floating point, which the Cortex-M0+
+// only has in software. Sums are kept relative to the first sample so the squares of large
+// values (e.g. pressure) stay small.
+
+typedef struct
+{
+    uint32_t count;
+    int32_t shift;
+    int64_t sum;
+    uint64_t sum_squares;
+    int32_t min;
+    int32_t max;
+
+} aggregate_t;
+
+void aggregate_reset(aggregate_t *self);
+
+void aggregate_feed(aggregate_t *self, int32_t value);
+
+uint32_t aggregate_get_count(aggregate_t *self);
+
+// Sum of all samples, divided by the count it gives the exact mean
+int64_t aggregate_get_sum(aggregate_t *self);
+
+// Mean rounded to the nearest integer
+bool aggregate_get_mean(aggregate_t *self, int32_t *mean);
+
+bool aggregate_get_min(aggregate_t *self, int32_t *min);
+
+bool aggregate_get_max(aggregate_t *self, int32_t *max);
+
+// Population standard deviation of the samples, rounded down
+bool aggregate_get_stddev(aggregate_t *self, int32_t *stddev);
+
+#endif // _AGGREGATE_H
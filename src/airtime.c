@@ -0,0 +1,122 @@
+#include <airtime.h>
+
+// The bucket counts airtime in thousandths of a ms so the refill of a single ms at a duty cycle
+// given in per mille is a whole number
+#define _AIRTIME_SCALE 1000
+
+static struct
+{
+    uint16_t duty_cycle;
+    int64_t credit;
+    int64_t capacity;
+    twr_tick_t tick;
+    twr_tick_t total;
+
+} _airtime;
+
+twr_tick_t airtime_calculate(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length)
+{
+    int sf;
+    int bw = 125;
+
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        if (datarate >= 4)
+        {
+            sf = 8;
+            bw = 500;
+        }
+        else
+        {
+            sf = 10 - datarate;
+        }
+    }
+    else if (datarate == 6)
+    {
+        sf = band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 ? 8 : 7;
+        bw = band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 ? 500 : 250;
+    }
+    else
+    {
+        sf = 12 - (datarate > 5 ? 5 : datarate);
+    }
+
+    // Semtech AN1200.13, explicit header, CRC on, coding rate 4/5, 8 symbol preamble, in integers
+    uint32_t symbol_us = (1UL << sf) * 1000 / bw;
+    int de = (bw == 125 && sf >= 11) ? 1 : 0;
+    int32_t bits = 8 * (int32_t) (length + AIRTIME_LORAWAN_OVERHEAD) - 4 * sf + 28 + 16;
+    int32_t bits_per_block = 4 * (sf - 2 * de);
+    int32_t payload = bits > 0 ? (bits + bits_per_block - 1) / bits_per_block * 5 : 0;
+
+    // Preamble of 12.25 symbols and 8 header symbols, counted in quarters of a symbol
+    uint32_t us = symbol_us * (81 + 4 * payload) / 4;
+
+    return (us + 999) / 1000;
+}
+
+void airtime_init(uint16_t duty_cycle, twr_tick_t capacity)
+{
+    memset(&_airtime, 0, sizeof(_airtime));
+
+    _airtime.duty_cycle = duty_cycle;
+    _airtime.capacity = (int64_t) capacity * _AIRTIME_SCALE;
+    _airtime.credit = _airtime.capacity;
+    _airtime.tick = twr_tick_get();
+}
+
+static void _airtime_refill(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    _airtime.credit += (int64_t) (now - _airtime.tick) * _airtime.duty_cycle;
+    _airtime.tick = now;
+
+    if (_airtime.credit > _airtime.capacity)
+    {
+        _airtime.credit = _airtime.capacity;
+    }
+}
+
+twr_tick_t airtime_get_budget(void)
+{
+    _airtime_refill();
+
+    return _airtime.credit > 0 ? _airtime.credit / _AIRTIME_SCALE : 0;
+}
+
+twr_tick_t airtime_get_capacity(void)
+{
+    return _airtime.capacity / _AIRTIME_SCALE;
+}
+
+twr_tick_t airtime_get_wait(twr_tick_t airtime)
+{
+    _airtime_refill();
+
+    int64_t missing = (int64_t) airtime * _AIRTIME_SCALE - _airtime.credit;
+
+    if (missing <= 0)
+    {
+        return 0;
+    }
+
+    if (_airtime.duty_cycle == 0)
+    {
+        return TWR_TICK_INFINITY;
+    }
+
+    return (missing + _airtime.duty_cycle - 1) / _airtime.duty_cycle;
+}
+
+void airtime_take(twr_tick_t airtime)
+{
+    _airtime_refill();
+
+    _airtime.credit -= (int64_t) airtime * _AIRTIME_SCALE;
+    _airtime.total += airtime;
+}
+
+twr_tick_t airtime_get_total(void)
+{
+    return _airtime.total;
+}
@@ -0,0 +1,36 @@
+#ifndef _AIRTIME_H
+#define _AIRTIME_H
+
+#include <twr.h>
+
+// Time on air of the uplinks and their duty cycle budget
+//
+// The budget is a token bucket of airtime refilled at the duty cycle, so a burst of uplinks may
+// use up to the capacity at once and then has to wait until the bucket fills again. The
+// application checks the budget before it builds a frame and takes the airtime of the frame
+// that was actually sent.
+
+// Bytes the LoRaWAN MAC adds to the application payload, MHDR, FHDR without options, FPort and MIC
+#define AIRTIME_LORAWAN_OVERHEAD 13
+
+// Time on air in ms of an uplink with length bytes of application payload
+twr_tick_t airtime_calculate(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length);
+
+// Duty cycle in per mille and capacity of the bucket in ms of airtime, the bucket starts full
+void airtime_init(uint16_t duty_cycle, twr_tick_t capacity);
+
+// Remaining airtime in ms
+twr_tick_t airtime_get_budget(void);
+
+twr_tick_t airtime_get_capacity(void);
+
+// Time until the bucket holds airtime, 0 when it does already
+twr_tick_t airtime_get_wait(twr_tick_t airtime);
+
+// Account an uplink, the budget may go negative when it was not checked before
+void airtime_take(twr_tick_t airtime);
+
+// Airtime taken since boot in ms
+twr_tick_t airtime_get_total(void);
+
+#endif // _AIRTIME_H
@@ -0,0 +1,46 @@
+#include <alarm.h>
+
+void alarm_init(alarm_t *self, const alarm_config_t *config)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_config = config;
+}
+
+bool alarm_update(alarm_t *self, int32_t value)
+{
+    const alarm_config_t *config = self->_config;
+
+    if (config->threshold <= 0)
+    {
+        if (self->_active)
+        {
+            self->_active = false;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    if (!self->_active && value > config->threshold)
+    {
+        self->_active = true;
+
+        return true;
+    }
+
+    if (self->_active && value < config->threshold - config->hysteresis)
+    {
+        self->_active = false;
+
+        return true;
+    }
+
+    return false;
+}
+
+bool alarm_is_active(alarm_t *self)
+{
+    return self->_active;
+}
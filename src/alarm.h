@@ -0,0 +1,33 @@
+#ifndef _ALARM_H
+#define _ALARM_H
+
+#include <twr.h>
+
+// Threshold alarm with hysteresis
+//
+// Raised when the value exceeds threshold, cleared when it falls below threshold - hysteresis.
+// A threshold of 0 disables the alarm. Values are in the fixed point of the window statistics
+// (see payload_field_fixed()), so a sample is compared without float.
+
+typedef struct
+{
+    int32_t threshold;
+    int32_t hysteresis;
+
+} alarm_config_t;
+
+typedef struct
+{
+    const alarm_config_t *_config;
+    bool _active;
+
+} alarm_t;
+
+void alarm_init(alarm_t *self, const alarm_config_t *config);
+
+// Account a new value, returns true when the alarm was raised or cleared by it
+bool alarm_update(alarm_t *self, int32_t value);
+
+bool alarm_is_active(alarm_t *self);
+
+#endif // _ALARM_H
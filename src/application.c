@@ -1,14 +1,147 @@
 #include <application.h>
 #include <at.h>
-
+#include <adaptive.h>
+#include <aggregate.h>
+#include <airtime.h>
+#include <alarm.h>
+#include <converge.h>
+#include <coordinator.h>
+#include <discovery.h>
+#include <downlink.h>
+#include <energy.h>
+#include <payload.h>
+#include <profile.h>
+#include <retry.h>
+#include <sensor.h>
+#include <store.h>
+#include <stream.h>
+#include <trace.h>
+
+// Defaults of the intervals, AT$INTERVAL changes them at runtime
+#ifndef SEND_DATA_INTERVAL
 #define SEND_DATA_INTERVAL          (15 * 60 * 1000)
+#endif
+#ifndef MEASURE_INTERVAL
 #define MEASURE_INTERVAL            (1 * 60 * 1000)
+#endif
+#ifndef MEASURE_INTERVAL_BAROMETER
 #define MEASURE_INTERVAL_BAROMETER  (5 * 60 * 1000)
+#endif
+#ifndef MEASURE_INTERVAL_CO2
 #define MEASURE_INTERVAL_CO2        (5 * 60 * 1000)
+#endif
+// Upper bound of the adaptive CO2 interval, MEASURE_INTERVAL_CO2 is the lower bound
+#ifndef MEASURE_INTERVAL_CO2_MAX
+#define MEASURE_INTERVAL_CO2_MAX    (30 * 60 * 1000)
+#endif
+#ifndef MEASURE_INTERVAL_VOC
 #define MEASURE_INTERVAL_VOC        (5 * 60 * 1000)
+#endif
+
+#define CO2_ADAPTIVE_NOISE_PPM           20
+#define CO2_ADAPTIVE_STABLE_PPM_PER_MIN  1
+#define CO2_ADAPTIVE_RISE_PPM_PER_MIN    5
+
+// Alarm thresholds and hysteresis in ppm and ppb, a threshold of 0 disables the alarm
+#ifndef ALARM_CO2_THRESHOLD
+#define ALARM_CO2_THRESHOLD         1200
+#endif
+#define ALARM_CO2_HYSTERESIS        100
+#ifndef ALARM_VOC_THRESHOLD
+#define ALARM_VOC_THRESHOLD         500
+#endif
+#define ALARM_VOC_HYSTERESIS        50
+// Minimum spacing of alarm uplinks, later crossings are sent when it expires
+#define ALARM_MIN_SPACING           (10 * 60 * 1000)
+
+#ifndef PAYLOAD_FORMAT
+#define PAYLOAD_FORMAT              PAYLOAD_FORMAT_FIXED
+#endif
+
+#ifndef PAYLOAD_BATCH_SIZE
+#define PAYLOAD_BATCH_SIZE          4
+#endif
+
+// Every n-th regular uplink is confirmed to check the link, about 6 acknowledges a day at the default
+// send interval. The windows of an unconfirmed uplink are done when it leaves the modem, a confirmed
+// uplink that is not acknowledged marks the link lost and the following ones are confirmed until an
+// acknowledge comes back, so the windows sent during an outage stay pending for backfill. 1 confirms
+// every uplink, which exceeds the downlink fair use of public networks.
+#ifndef UPLINK_CONFIRM_EVERY
+#define UPLINK_CONFIRM_EVERY        16
+#endif
+// Alarm and button frames are sent confirmed and retried when the network does not acknowledge them
+#ifndef UPLINK_CONFIRM_URGENT
+#define UPLINK_CONFIRM_URGENT       0
+#endif
+// Attempts of a frame the modem failed to send, the delay doubles from SEND_RETRY_DELAY up to SEND_RETRY_DELAY_MAX
+#ifndef SEND_RETRY_ATTEMPTS
+#define SEND_RETRY_ATTEMPTS         4
+#endif
+#ifndef SEND_RETRY_DELAY
+#define SEND_RETRY_DELAY            (15 * 1000)
+#endif
+#ifndef SEND_RETRY_DELAY_MAX
+#define SEND_RETRY_DELAY_MAX        (2 * 60 * 1000)
+#endif
+// Random part of a retry delay in percent
+#define SEND_RETRY_JITTER           25
+// Spacing of backfill frames, the airtime budget may delay them further
+#ifndef BACKFILL_INTERVAL
+#define BACKFILL_INTERVAL           (10 * 60 * 1000)
+#endif
+// Duty cycle of the uplinks in per mille, 1 % of EU868
+#ifndef AIRTIME_DUTY_CYCLE
+#define AIRTIME_DUTY_CYCLE          10
+#endif
+// Airtime a burst of uplinks may use at once, the duty cycle of one hour
+#ifndef AIRTIME_BUDGET
+#define AIRTIME_BUDGET              (36 * 1000)
+#endif
+// Time to wait for a busy modem before the window goes to the store for backfill
+#define SEND_READY_TIMEOUT          (60 * 1000)
+
+// Level of the SDK log on the console, DUMP also prints the modem AT traffic, application events go to the trace
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                   TWR_LOG_LEVEL_WARNING
+#endif
+
+// Period of probing for tags not found at boot
+#ifndef DISCOVERY_INTERVAL
+#define DISCOVERY_INTERVAL          (60 * 60 * 1000)
+#endif
+
+// Identifies the layout of config_t in EEPROM, change it when the layout changes
+#define CONFIG_SIGNATURE 0x4941510100000005ULL
+
+// twr_config keeps a 16 B header in front of config_t
+_Static_assert(16 + sizeof(config_t) <= STORE_CONFIG_SPACE, "config does not fit in front of the store");
+
+// Downlink opcodes, see README
+#define DOWNLINK_INTERVAL     0x01
+#define DOWNLINK_ALARM        0x02
+#define DOWNLINK_PAYLOAD      0x03
+#define DOWNLINK_CALIBRATION  0x04
+#define DOWNLINK_SEND         0x05
 
 #define CALIBRATION_START_DELAY (15 * 60 * 1000)
+// Time to carry the unit outside, readings before it do not count towards convergence
+#define CALIBRATION_FLUSH_MIN (5 * 60 * 1000)
 #define CALIBRATION_MEASURE_INTERVAL (2 * 60 * 1000)
+#define CALIBRATION_ROUNDS 32
+// A stage ends early when the last readings spread less than the tolerance, the outdoor air
+// reached the sensor or the calibration rounds stopped moving the reading
+#ifndef CALIBRATION_TOLERANCE
+#define CALIBRATION_TOLERANCE 10
+#endif
+// Readings are judged in tenths of ppm
+#define CALIBRATION_SCALE 10
+#define CALIBRATION_FLUSH_WINDOW 4
+#define CALIBRATION_ROUNDS_WINDOW 5
+
+#define CALIBRATION_STAGE_NONE 0
+#define CALIBRATION_STAGE_FLUSH 1
+#define CALIBRATION_STAGE_ROUNDS 2
 
 // LED instance
 twr_led_t led;
@@ -23,42 +156,206 @@ twr_tag_humidity_t humidity_tag;
 // Barometer tag instance
 twr_tag_barometer_t barometer;
 
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_temperature_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_co2_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL_CO2))
-TWR_DATA_STREAM_INT_BUFFER(sm_voc_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL_VOC))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_humidity_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_pressure_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL_BAROMETER))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_voltage_buffer, 8)
+static const config_t config_default = {
+    .send_interval = SEND_DATA_INTERVAL,
+    .measure_interval = MEASURE_INTERVAL,
+    .co2_interval_min = MEASURE_INTERVAL_CO2,
+    .co2_interval_max = MEASURE_INTERVAL_CO2_MAX,
+    .voc_interval = MEASURE_INTERVAL_VOC,
+    .barometer_interval = MEASURE_INTERVAL_BAROMETER,
+    // CO2 and VOC are whole ppm and ppb on the wire, the fixed point of the statistics is 1/1024 of it
+    .alarm_co2 = { .threshold = ALARM_CO2_THRESHOLD << PAYLOAD_FRACTION_BITS, .hysteresis = ALARM_CO2_HYSTERESIS << PAYLOAD_FRACTION_BITS },
+    .alarm_voc = { .threshold = ALARM_VOC_THRESHOLD << PAYLOAD_FRACTION_BITS, .hysteresis = ALARM_VOC_HYSTERESIS << PAYLOAD_FRACTION_BITS },
+    .payload_format = PAYLOAD_FORMAT,
+    .payload_batch_size = PAYLOAD_BATCH_SIZE,
+};
+config_t config;
+
+// Humidity tag slots, one per revision and bus, attached only when discovered
+humidity_tag_t humidity_tags[] = {
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R1, .i2c_channel = TWR_I2C_I2C0},
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R2, .i2c_channel = TWR_I2C_I2C0},
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R3, .i2c_channel = TWR_I2C_I2C0},
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R1, .i2c_channel = TWR_I2C_I2C1},
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R2, .i2c_channel = TWR_I2C_I2C1},
+    {.revision = TWR_TAG_HUMIDITY_REVISION_R3, .i2c_channel = TWR_I2C_I2C1},
+};
+
+// Measurement points, one per bus so a tag keeps its fields whichever other tag is missing at boot,
+// a second tag on a bus is not measured
+humidity_channel_t humidity_channels[] = {
+    {.i2c_channel = TWR_I2C_I2C0, .temperature = PAYLOAD_FIELD_TEMPERATURE, .humidity = PAYLOAD_FIELD_HUMIDITY},
+    {.i2c_channel = TWR_I2C_I2C1, .temperature = PAYLOAD_FIELD_TEMPERATURE_2, .humidity = PAYLOAD_FIELD_HUMIDITY_2},
+};
+
+#define _APPLICATION_SENSOR_AGGREGATE(id, name, label, width, sign, num, den, round, precision) aggregate_t sm_##name;
+#define _APPLICATION_SENSOR_WINDOW(id, name, label, width, sign, num, den, round, precision) [PAYLOAD_FIELD_##id] = &sm_##name,
+#define _APPLICATION_SENSOR_STATUS(id, name, label, width, sign, num, den, round, precision) [PAYLOAD_FIELD_##id] = {label, precision, num, den},
+
+// Statistics of each quantity since the last send, sm_voltage, sm_temperature, ... as listed in SENSOR_TABLE
+SENSOR_TABLE(_APPLICATION_SENSOR_AGGREGATE)
+
+aggregate_t *const sm_window[PAYLOAD_FIELD_COUNT] = {
+    SENSOR_TABLE(_APPLICATION_SENSOR_WINDOW)
+};
+
+// Samples enter the window in fixed point of their wire unit
+static void _application_feed(payload_field_t field, int32_t fixed)
+{
+    aggregate_feed(sm_window[field], fixed);
+}
+
+// Reading of a driver that reports float, a failed one is NAN
+static void _application_feed_float(payload_field_t field, float value)
+{
+    if (!isnan(value))
+    {
+        _application_feed(field, payload_field_quantize(field, value));
+    }
+}
+
+// Unsigned fixed point value of the given unit, rounded to the decimals and formatted without float
+static void _application_decimal_format(char *buffer, size_t size, uint64_t value, uint32_t unit, int decimals)
+{
+    uint32_t scale = 1;
+
+    for (int i = 0; i < decimals; i++)
+    {
+        scale *= 10;
+    }
+
+    uint64_t scaled = (value * scale + unit / 2) / unit;
 
-twr_data_stream_t sm_temperature;
-twr_data_stream_t sm_co2;
-twr_data_stream_t sm_voc;
-twr_data_stream_t sm_humidity;
-twr_data_stream_t sm_pressure;
-twr_data_stream_t sm_voltage;
+    if (decimals == 0)
+    {
+        snprintf(buffer, size, "%lu", (unsigned long) scaled);
+    }
+    else
+    {
+        snprintf(buffer, size, "%lu.%0*lu", (unsigned long) (scaled / scale), decimals, (unsigned long) (scaled % scale));
+    }
+}
 
-twr_scheduler_task_id_t battery_measure_task_id;
+// The running battery measurement was started by a transmission
+bool battery_loaded;
 
 enum {
     HEADER_BOOT         = 0x00,
     HEADER_UPDATE       = 0x01,
     HEADER_BUTTON_CLICK = 0x02,
     HEADER_BUTTON_HOLD  = 0x03,
+    HEADER_ALARM        = 0x04,
+    HEADER_BACKFILL     = 0x05,
+    HEADER_DOWNLINK     = 0x06,
 
 } header = HEADER_BOOT;
 
+// Windows collected by the batch format before they are sent
+payload_batch_t payload_batch;
+// Sequence number of the oldest window in payload_batch
+uint16_t payload_batch_sequence;
+
+uint32_t uplink_counter;
+// The last confirmed uplink was not acknowledged
+bool link_lost;
+// Frames that waited for the airtime budget
+uint32_t airtime_deferred;
+
+// Last frame handed to the modem, sent again after a failure
+struct
+{
+    uint8_t header;
+    uint8_t buffer[PAYLOAD_MAX_LENGTH];
+    size_t length;
+    bool confirmed;
+    // Not acknowledged is a failure too
+    bool acknowledge;
+
+} send_frame;
+const retry_config_t send_retry_config = {
+    .attempts = SEND_RETRY_ATTEMPTS,
+    .delay_min = SEND_RETRY_DELAY,
+    .delay_max = SEND_RETRY_DELAY_MAX,
+    .jitter = SEND_RETRY_JITTER,
+};
+retry_t send_retry;
+twr_scheduler_task_id_t send_retry_task_id;
+bool send_retry_wait;
+// Start of waiting for the modem, 0 when application_task does not wait
+twr_tick_t send_wait_tick;
+twr_scheduler_task_id_t backfill_task_id;
+bool backfill_wait;
+
 twr_scheduler_task_id_t calibration_task_id = 0;
-int calibration_counter;
+const converge_config_t calibration_flush_config = {
+    .window = CALIBRATION_FLUSH_WINDOW,
+    .tolerance = CALIBRATION_TOLERANCE * CALIBRATION_SCALE,
+};
+const converge_config_t calibration_rounds_config = {
+    .window = CALIBRATION_ROUNDS_WINDOW,
+    .tolerance = CALIBRATION_TOLERANCE * CALIBRATION_SCALE,
+};
+converge_t calibration_converge;
+// Tick up to which config.calibration_flush_elapsed counts
+twr_tick_t calibration_flush_saved;
+twr_tick_t calibration_flush_tick;
+
+adaptive_config_t co2_adaptive_config = {
+    .interval_min = MEASURE_INTERVAL_CO2,
+    .interval_max = MEASURE_INTERVAL_CO2_MAX,
+    .noise = CO2_ADAPTIVE_NOISE_PPM << PAYLOAD_FRACTION_BITS,
+    .stable_rate = CO2_ADAPTIVE_STABLE_PPM_PER_MIN << PAYLOAD_FRACTION_BITS,
+    .rise_rate = CO2_ADAPTIVE_RISE_PPM_PER_MIN << PAYLOAD_FRACTION_BITS,
+};
+adaptive_t co2_adaptive;
+
+// Ids in the measurement coordinator
+int co2_sensor_id;
+int battery_sensor_id;
+int voc_lp_sensor_id = -1;
+int barometer_sensor_id = -1;
+
+alarm_t alarm_co2;
+alarm_t alarm_voc;
+twr_scheduler_task_id_t alarm_task_id;
+twr_tick_t alarm_sent_tick;
+bool alarm_sent;
 
 
 void calibration_task(void *param);
+void backfill_task(void *param);
+void send_retry_task(void *param);
+static void _application_downlink(void);
+static void _application_send_failed(void);
+static twr_tick_t _application_airtime(size_t length);
+
+// Runs the stage kept in config, a flush resumed after a reboot keeps the time it already spent
+static void _calibration_run(void)
+{
+    bool flush = config.calibration_stage == CALIBRATION_STAGE_FLUSH;
+
+    twr_tick_t elapsed = (twr_tick_t) config.calibration_flush_elapsed * 1000;
+
+    converge_init(&calibration_converge, flush ? &calibration_flush_config : &calibration_rounds_config);
+    calibration_flush_saved = twr_tick_get();
+    calibration_flush_tick = calibration_flush_saved + (elapsed < CALIBRATION_FLUSH_MIN ? CALIBRATION_FLUSH_MIN - elapsed : 0);
+
+    // The module measures on its own fixed interval so the readings can be judged
+    coordinator_set_interval(co2_sensor_id, TWR_TICK_INFINITY);
+    twr_module_co2_set_update_interval(CALIBRATION_MEASURE_INTERVAL);
+
+    twr_led_set_mode(&led, flush ? TWR_LED_MODE_BLINK_FAST : TWR_LED_MODE_BLINK_SLOW);
+    calibration_task_id = twr_scheduler_register(calibration_task, NULL, flush ? calibration_flush_saved + (elapsed < CALIBRATION_START_DELAY ? CALIBRATION_START_DELAY - elapsed : 0) : 0);
+}
 
 void calibration_start()
 {
-    calibration_counter = 32;
+    config.calibration_stage = CALIBRATION_STAGE_FLUSH;
+    config.calibration_rounds = 0;
+    config.calibration_flush_elapsed = 0;
+    twr_config_save();
 
-    twr_led_set_mode(&led, TWR_LED_MODE_BLINK_FAST);
-    calibration_task_id = twr_scheduler_register(calibration_task, NULL, twr_tick_get() + CALIBRATION_START_DELAY);
+    _calibration_run();
     twr_atci_printf("$CO2_CALIBRATION: \"START\"");
 
 }
@@ -74,35 +371,92 @@ void calibration_stop()
     twr_scheduler_unregister(calibration_task_id);
     calibration_task_id = 0;
 
-    twr_module_co2_set_update_interval(MEASURE_INTERVAL_CO2);
+    config.calibration_stage = CALIBRATION_STAGE_NONE;
+    twr_config_save();
+
+    // Hand measurements back to the adaptive schedule
+    twr_module_co2_set_update_interval(TWR_TICK_INFINITY);
+    adaptive_reset(&co2_adaptive);
+    coordinator_set_interval(co2_sensor_id, adaptive_get_interval(&co2_adaptive));
+
     twr_atci_printf("$CO2_CALIBRATION: \"STOP\"");
 
 }
 
 void calibration_task(void *param)
 {
-    (void) param;
+    PROFILE_SCOPE(PROFILE_SECTION_CALIBRATION);
 
-    twr_led_set_mode(&led, TWR_LED_MODE_BLINK_SLOW);
-
-    twr_atci_printf("$CO2_CALIBRATION_COUNTER: \"%d\"", calibration_counter);
+    (void) param;
 
+    if (config.calibration_stage == CALIBRATION_STAGE_FLUSH)
+    {
+        // Outdoor air reached the sensor, the readings settled or the delay expired
+        config.calibration_stage = CALIBRATION_STAGE_ROUNDS;
 
-    twr_module_co2_set_update_interval(CALIBRATION_MEASURE_INTERVAL);
-    twr_module_co2_calibration(TWR_LP8_CALIBRATION_BACKGROUND_FILTERED);
+        converge_init(&calibration_converge, &calibration_rounds_config);
+        twr_led_set_mode(&led, TWR_LED_MODE_BLINK_SLOW);
+    }
+    else if (converge_is_done(&calibration_converge))
+    {
+        twr_atci_printf("$CO2_CALIBRATION: \"CONVERGED\"");
 
-    calibration_counter--;
+        calibration_stop();
 
-    if (calibration_counter == 0)
+        return;
+    }
+    else if (config.calibration_rounds >= CALIBRATION_ROUNDS)
     {
         calibration_stop();
+
+        return;
     }
 
+    twr_module_co2_calibration(TWR_LP8_CALIBRATION_BACKGROUND_FILTERED);
+
+    config.calibration_rounds++;
+    twr_config_save();
+
     twr_scheduler_plan_current_relative(CALIBRATION_MEASURE_INTERVAL);
 }
   
+void alarm_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_ALARM);
+
+    (void) param;
+
+    if (header == HEADER_ALARM)
+    {
+        twr_scheduler_plan_now(0);
+    }
+}
+
+// Request an out-of-band uplink, spaced at least ALARM_MIN_SPACING from the previous alarm uplink
+void alarm_send(void)
+{
+    // Boot frame goes out shortly and carries the values anyway
+    if (header == HEADER_BOOT)
+    {
+        return;
+    }
+
+    header = HEADER_ALARM;
+
+    if (alarm_sent && twr_tick_get() < alarm_sent_tick + ALARM_MIN_SPACING)
+    {
+        twr_scheduler_plan_absolute(alarm_task_id, alarm_sent_tick + ALARM_MIN_SPACING);
+
+        return;
+    }
+
+    twr_scheduler_plan_now(0);
+}
+
 void button_event_handler(twr_button_t *self, twr_button_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_BUTTON);
+
     if (event == TWR_BUTTON_EVENT_CLICK)
     {
         header = HEADER_BUTTON_CLICK;
@@ -122,138 +476,407 @@ void button_event_handler(twr_button_t *self, twr_button_event_t event, void *ev
     }
 }
 
+// Active time of a subsystem runs from a started measurement to the event of its driver
+static bool _application_measure_started(energy_subsystem_t subsystem, bool started)
+{
+    if (started)
+    {
+        energy_begin(subsystem);
+    }
+
+    return started;
+}
+
+static bool _application_co2_measure(void *param)
+{
+    (void) param;
+
+    return _application_measure_started(ENERGY_SUBSYSTEM_CO2, twr_module_co2_measure());
+}
+
+static bool _application_battery_measure(void *param)
+{
+    (void) param;
+
+    return _application_measure_started(ENERGY_SUBSYSTEM_BATTERY, twr_module_battery_measure());
+}
+
+static bool _application_humidity_measure(void *param)
+{
+    return _application_measure_started(ENERGY_SUBSYSTEM_HUMIDITY, twr_tag_humidity_measure(&((humidity_tag_t *) param)->self));
+}
+
+static bool _application_voc_lp_measure(void *param)
+{
+    (void) param;
+
+    return _application_measure_started(ENERGY_SUBSYSTEM_VOC, twr_tag_voc_lp_measure(&voc_lp));
+}
+
+static bool _application_barometer_measure(void *param)
+{
+    (void) param;
+
+    return _application_measure_started(ENERGY_SUBSYSTEM_BAROMETER, twr_tag_barometer_measure(&barometer));
+}
+
 void co2_module_event_handler(twr_module_co2_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_CO2);
+
     (void) event;
     (void) event_param;
 
     float value;
 
-    twr_log_debug("CO2 MEASSUREMENT");
+    energy_end(ENERGY_SUBSYSTEM_CO2);
 
     if (twr_module_co2_get_concentration_ppm(&value))
     {
-        twr_data_stream_feed(&sm_co2, &value);
+        // The module measures whole ppm, the float of the driver is converted once
+        int32_t ppm = (int32_t) value;
+        int32_t fixed = payload_field_fixed(PAYLOAD_FIELD_CO2, ppm);
+
+        TRACE_DEBUG(TRACE_EVENT_CO2, 0, ppm);
+
+        _application_feed(PAYLOAD_FIELD_CO2, fixed);
+        stream_sample(PAYLOAD_FIELD_CO2, value);
+
+        if (alarm_update(&alarm_co2, fixed))
+        {
+            TRACE_INFO(TRACE_EVENT_CO2_ALARM, alarm_is_active(&alarm_co2), ppm);
+
+            alarm_send();
+        }
+
+        // Calibration runs the module on its own fixed interval
+        if (!calibration_task_id)
+        {
+            coordinator_set_interval(co2_sensor_id, adaptive_update(&co2_adaptive, fixed, twr_tick_get()));
+        }
+        else
+        {
+            bool settling = config.calibration_stage == CALIBRATION_STAGE_FLUSH && twr_tick_get() < calibration_flush_tick;
+
+            if (config.calibration_stage == CALIBRATION_STAGE_FLUSH)
+            {
+                twr_tick_t seconds = (twr_tick_get() - calibration_flush_saved) / 1000;
+
+                config.calibration_flush_elapsed += seconds;
+                calibration_flush_saved += seconds * 1000;
+                twr_config_save();
+            }
+
+            // A converged stage ends without waiting for its delay or the remaining rounds
+            if (!settling && converge_feed(&calibration_converge, ppm * CALIBRATION_SCALE))
+            {
+                twr_scheduler_plan_now(calibration_task_id);
+            }
+
+            int32_t statistics[2];
+            char text[2][16] = { "", "" };
+
+            if (converge_get_mean(&calibration_converge, &statistics[0]) && converge_get_stddev(&calibration_converge, &statistics[1]))
+            {
+                for (int i = 0; i < 2; i++)
+                {
+                    _application_decimal_format(text[i], sizeof(text[i]), statistics[i] < 0 ? 0 : statistics[i], CALIBRATION_SCALE, 1);
+                }
+            }
+
+            twr_atci_printf("$CO2_CALIBRATION_COUNTER: \"%d\",%d,%s,%s", CALIBRATION_ROUNDS - config.calibration_rounds,
+                            converge_get_count(&calibration_converge), text[0], text[1]);
+        }
     }
     else
     {
-        twr_data_stream_reset(&sm_co2);
+        TRACE_WARNING(TRACE_EVENT_CO2, 1, 0);
+
+        aggregate_reset(&sm_co2);
+        stream_sample(PAYLOAD_FIELD_CO2, NAN);
     }
 }
 
 void voc_lp_tag_event_handler(twr_tag_voc_lp_t *self, twr_tag_voc_lp_event_t event, void *event_param)
 {
-    
+    PROFILE_SCOPE(PROFILE_SECTION_VOC);
+
+    energy_end(ENERGY_SUBSYSTEM_VOC);
+
     if (event == TWR_TAG_VOC_LP_EVENT_UPDATE)
     {
-        twr_log_debug("VOC MEASUREMENT");
         uint16_t value;
 
         if (twr_tag_voc_lp_get_tvoc_ppb(self, &value))
         {
-            int retyped_value = value;
-            twr_data_stream_feed(&sm_voc, &retyped_value);
+            int32_t fixed = payload_field_fixed(PAYLOAD_FIELD_VOC, value);
+
+            TRACE_DEBUG(TRACE_EVENT_VOC, 0, value);
+
+            _application_feed(PAYLOAD_FIELD_VOC, fixed);
+            stream_sample(PAYLOAD_FIELD_VOC, value);
+
+            if (alarm_update(&alarm_voc, fixed))
+            {
+                TRACE_INFO(TRACE_EVENT_VOC_ALARM, alarm_is_active(&alarm_voc), value);
+
+                alarm_send();
+            }
+
+            return;
         }
     }
+
+    stream_sample(PAYLOAD_FIELD_VOC, NAN);
 }
 
 void battery_event_handler(twr_module_battery_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_BATTERY);
+
+    // LEVEL_LOW and LEVEL_CRITICAL come ahead of the UPDATE of the same measurement, which ends it and
+    // consumes the loaded flag
+    if (event != TWR_MODULE_BATTERY_EVENT_UPDATE && event != TWR_MODULE_BATTERY_EVENT_ERROR)
+    {
+        return;
+    }
+
+    energy_end(ENERGY_SUBSYSTEM_BATTERY);
+
     if (event == TWR_MODULE_BATTERY_EVENT_UPDATE)
     {
-        twr_log_debug("BATTERY MEASUREMENT");
         float voltage = NAN;
 
         twr_module_battery_get_voltage(&voltage);
 
-        twr_data_stream_feed(&sm_voltage, &voltage);
+        TRACE_DEBUG(TRACE_EVENT_BATTERY, battery_loaded, isnan(voltage) ? -1 : voltage * 1000.f);
+
+        _application_feed_float(battery_loaded ? PAYLOAD_FIELD_VOLTAGE : PAYLOAD_FIELD_VOLTAGE_IDLE, voltage);
+        stream_sample(battery_loaded ? PAYLOAD_FIELD_VOLTAGE : PAYLOAD_FIELD_VOLTAGE_IDLE, voltage);
+    }
+    else
+    {
+        stream_sample(battery_loaded ? PAYLOAD_FIELD_VOLTAGE : PAYLOAD_FIELD_VOLTAGE_IDLE, NAN);
+    }
+
+    battery_loaded = false;
+}
+
+static humidity_channel_t *_application_humidity_channel(uint8_t channel)
+{
+    for (size_t i = 0; i < sizeof(humidity_channels) / sizeof(humidity_channels[0]); i++)
+    {
+        if (humidity_channels[i].used && humidity_channels[i].channel == channel)
+        {
+            return &humidity_channels[i];
+        }
     }
+
+    return NULL;
 }
 
 void humidity_tag_event_handler(twr_tag_humidity_t *self, twr_tag_humidity_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_HUMIDITY);
+
+    event_param_t *param = event_param;
+    humidity_channel_t *channel = _application_humidity_channel(param->channel);
     float value;
 
+    energy_end(ENERGY_SUBSYSTEM_HUMIDITY);
+
+    if (channel == NULL)
+    {
+        return;
+    }
+
     if (event != TWR_TAG_HUMIDITY_EVENT_UPDATE)
     {
+        stream_sample(channel->humidity, NAN);
+        stream_sample(channel->temperature, NAN);
+
         return;
     }
 
     if (twr_tag_humidity_get_humidity_percentage(self, &value))
     {
-        twr_log_debug("HUMIDITY MEASUREMENT");
-        twr_data_stream_feed(&sm_humidity, &value);
+        TRACE_DEBUG(TRACE_EVENT_HUMIDITY, param->channel, value * 10.f);
+
+        _application_feed_float(channel->humidity, value);
+    }
+    else
+    {
+        value = NAN;
     }
 
+    stream_sample(channel->humidity, value);
+
     if(twr_tag_humidity_get_temperature_celsius(self, &value))
     {
-        twr_log_debug("TEMPERATURE MEASUREMENT");
+        TRACE_DEBUG(TRACE_EVENT_TEMPERATURE, param->channel, value * 10.f);
 
-        twr_data_stream_feed(&sm_temperature, &value);
+        _application_feed_float(channel->temperature, value);
     }
-    
+    else
+    {
+        value = NAN;
+    }
+
+    stream_sample(channel->temperature, value);
 }
 
 void barometer_tag_event_handler(twr_tag_barometer_t *self, twr_tag_barometer_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_BAROMETER);
+
     float pascal;
 
-    twr_log_debug("BAROMETER MEASUREMENT");
+    energy_end(ENERGY_SUBSYSTEM_BAROMETER);
 
-    if (event != TWR_TAG_BAROMETER_EVENT_UPDATE)
+    if (event != TWR_TAG_BAROMETER_EVENT_UPDATE || !twr_tag_barometer_get_pressure_pascal(self, &pascal))
     {
+        stream_sample(PAYLOAD_FIELD_PRESSURE, NAN);
+
         return;
     }
 
-    if (!twr_tag_barometer_get_pressure_pascal(self, &pascal))
+    TRACE_DEBUG(TRACE_EVENT_BAROMETER, 0, pascal / 10.f);
+
+    _application_feed_float(PAYLOAD_FIELD_PRESSURE, pascal);
+    stream_sample(PAYLOAD_FIELD_PRESSURE, pascal);
+}
+
+// Issue the sends that wait for the modem, the tasks check readiness again when they run
+static void _application_modem_ready(void)
+{
+    if (send_wait_tick != 0)
     {
-        return;
+        twr_scheduler_plan_now(0);
     }
 
-    twr_data_stream_feed(&sm_pressure, &pascal);
+    if (backfill_wait)
+    {
+        twr_scheduler_plan_now(backfill_task_id);
+    }
+
+    if (send_retry_wait)
+    {
+        twr_scheduler_plan_now(send_retry_task_id);
+    }
 }
 
 void lora_callback(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event, void *event_param)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_LORA);
+
+    TRACE_DEBUG(TRACE_EVENT_LORA, event, 0);
+
     if (event == TWR_CMWX1ZZABZ_EVENT_ERROR)
     {
         twr_led_set_mode(&led, TWR_LED_MODE_BLINK_FAST);
+
+        _application_send_failed();
     }
     else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START)
     {
         twr_led_set_mode(&led, TWR_LED_MODE_ON);
+
+        energy_begin(ENERGY_SUBSYSTEM_LORA);
+
+        // Voltage under the transmit current, a measurement of the idle voltage in progress keeps its result
+        battery_loaded = _application_measure_started(ENERGY_SUBSYSTEM_BATTERY, twr_module_battery_measure());
     }
     else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE)
     {
         twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+
+        energy_end(ENERGY_SUBSYSTEM_LORA);
+
+        // Confirmed frames are done by the acknowledge, an unconfirmed one is done when it is sent
+        if (!send_frame.confirmed)
+        {
+            retry_done(&send_retry);
+
+            store_confirm();
+        }
+
+        _application_modem_ready();
     }
     else if (event == TWR_CMWX1ZZABZ_EVENT_READY)
     {
         twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+
+        _application_modem_ready();
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_RETRANSMISSION)
+    {
+        // The modem sent a confirmed frame again without its acknowledge, that airtime counts as well
+        airtime_take(_application_airtime(send_frame.length));
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_CONFIRMED)
+    {
+        retry_done(&send_retry);
+
+        link_lost = false;
+
+        store_confirm();
+
+        // Network is back, send what it missed
+        if (store_get_pending_count() > 0)
+        {
+            twr_scheduler_plan_from_now(backfill_task_id, BACKFILL_INTERVAL);
+        }
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_NOT_CONFIRMED)
+    {
+        // Backfill covers the regular windows, urgent frames are retried when they ask for the acknowledge
+        if (send_frame.acknowledge)
+        {
+            _application_send_failed();
+        }
+        else
+        {
+            retry_done(&send_retry);
+
+            store_release();
+        }
+
+        link_lost = true;
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_RECEIVED)
+    {
+        _application_downlink();
     }
     else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS)
     {
         twr_atci_printf("$JOIN_OK");
+
+        _application_modem_ready();
     }
     else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_ERROR)
     {
         twr_atci_printf("$JOIN_ERROR");
+
+        _application_modem_ready();
     }
 }
 
-static void humidity_tag_init(twr_tag_humidity_revision_t revision, twr_i2c_channel_t i2c_channel, humidity_tag_t *tag)
+static void humidity_tag_attach(void *param)
 {
-    memset(tag, 0, sizeof(*tag));
+    humidity_tag_t *tag = param;
+
+    memset(&tag->self, 0, sizeof(tag->self));
+    memset(&tag->param, 0, sizeof(tag->param));
 
-    if (revision == TWR_TAG_HUMIDITY_REVISION_R1)
+    if (tag->revision == TWR_TAG_HUMIDITY_REVISION_R1)
     {
         tag->param.channel = TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT;
     }
-    else if (revision == TWR_TAG_HUMIDITY_REVISION_R2)
+    else if (tag->revision == TWR_TAG_HUMIDITY_REVISION_R2)
     {
         tag->param.channel = TWR_RADIO_PUB_CHANNEL_R2_I2C0_ADDRESS_DEFAULT;
     }
-    else if (revision == TWR_TAG_HUMIDITY_REVISION_R3)
+    else if (tag->revision == TWR_TAG_HUMIDITY_REVISION_R3)
     {
         tag->param.channel = TWR_RADIO_PUB_CHANNEL_R3_I2C0_ADDRESS_DEFAULT;
     }
@@ -262,20 +885,67 @@ static void humidity_tag_init(twr_tag_humidity_revision_t revision, twr_i2c_chan
         return;
     }
 
-    if (i2c_channel == TWR_I2C_I2C1)
+    if (tag->i2c_channel == TWR_I2C_I2C1)
     {
         tag->param.channel |= 0x80;
     }
 
-    twr_tag_humidity_init(&tag->self, revision, i2c_channel, TWR_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+    int slot = -1;
+
+    for (size_t i = 0; i < sizeof(humidity_channels) / sizeof(humidity_channels[0]); i++)
+    {
+        if (humidity_channels[i].i2c_channel != tag->i2c_channel)
+        {
+            continue;
+        }
+
+        if (!humidity_channels[i].used || humidity_channels[i].channel == tag->param.channel)
+        {
+            humidity_channels[i].used = true;
+            humidity_channels[i].channel = tag->param.channel;
+
+            slot = i;
+
+            break;
+        }
+    }
+
+    if (slot < 0)
+    {
+        TRACE_WARNING(TRACE_EVENT_HUMIDITY_CHANNEL, tag->param.channel, -1);
+
+        return;
+    }
+
+    TRACE_INFO(TRACE_EVENT_HUMIDITY_CHANNEL, tag->param.channel, slot);
 
-    twr_tag_humidity_set_update_interval(&tag->self, MEASURE_INTERVAL);
+    twr_tag_humidity_init(&tag->self, tag->revision, tag->i2c_channel, TWR_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
 
     twr_tag_humidity_set_event_handler(&tag->self, humidity_tag_event_handler, &tag->param);
+
+    tag->sensor_id = coordinator_add(_application_humidity_measure, tag, config.measure_interval);
+}
+
+static void voc_lp_tag_attach(void *param)
+{
+    twr_tag_voc_lp_init(&voc_lp, TWR_I2C_I2C0);
+    twr_tag_voc_lp_set_event_handler(&voc_lp, voc_lp_tag_event_handler, NULL);
+
+    voc_lp_sensor_id = coordinator_add(_application_voc_lp_measure, NULL, config.voc_interval);
+}
+
+static void barometer_tag_attach(void *param)
+{
+    twr_tag_barometer_init(&barometer, TWR_I2C_I2C0);
+    twr_tag_barometer_set_event_handler(&barometer, barometer_tag_event_handler, NULL);
+
+    barometer_sensor_id = coordinator_add(_application_barometer_measure, NULL, config.barometer_interval);
 }
 
 bool at_send(void)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
     twr_scheduler_plan_now(0);
 
     return true;
@@ -283,6 +953,8 @@ bool at_send(void)
 
 bool at_calibration(void)
 {
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
     if (calibration_task_id)
     {
         calibration_stop();
@@ -295,60 +967,790 @@ bool at_calibration(void)
     return true;
 }
 
-bool at_status(void)
+static bool _application_payload_valid(long format)
 {
-    float value_avg = NAN;
+    return format >= 0 && format < PAYLOAD_FORMAT_COUNT;
+}
 
-    static const struct {
-        twr_data_stream_t *stream;
-        const char *name;
-        int precision;
-    } values[] = {
-            {&sm_voltage, "Voltage", 1},
-            {&sm_temperature, "Temperature", 1},
-            {&sm_humidity, "Humidity", 1},
-            {&sm_voc, "VOC", 1},
-            {&sm_pressure, "Pressure", 0},
-            {&sm_co2, "CO2", 0},
-    };
+static bool _application_batch_valid(long size)
+{
+    return size >= 1 && size <= PAYLOAD_BATCH_MAX;
+}
 
-    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+static bool _application_payload_set(long format)
+{
+    if (!_application_payload_valid(format))
     {
-        value_avg = NAN;
-
-        if (twr_data_stream_get_average(values[i].stream, &value_avg))
-        {
-            twr_atci_printf("$STATUS: \"%s\",%.*f", values[i].name, values[i].precision, value_avg);
-        }
-        else
-        {
-            twr_atci_printf("$STATUS: \"%s\",", values[i].name);
-        }
+        return false;
     }
 
-    return true;
+    config.payload_format = format;
+
+    payload_batch_reset(&payload_batch);
+
+    return true;
+}
+
+static bool _application_batch_set(long size)
+{
+    if (!_application_batch_valid(size))
+    {
+        return false;
+    }
+
+    config.payload_batch_size = size;
+
+    return true;
+}
+
+bool at_payload_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$PAYLOAD: %d", config.payload_format);
+
+    return true;
+}
+
+bool at_payload_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    if (param->length != 1 || !isdigit((unsigned char) param->txt[0]))
+    {
+        return false;
+    }
+
+    return _application_payload_set(param->txt[0] - '0') && twr_config_save();
+}
+
+bool at_batch_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$BATCH: %d", config.payload_batch_size);
+
+    return true;
+}
+
+bool at_batch_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char *end;
+    long size = strtol(param->txt, &end, 10);
+
+    if (end == param->txt || *end != '\0')
+    {
+        return false;
+    }
+
+    return _application_batch_set(size) && twr_config_save();
+}
+
+// Window period of the coordinator, the greatest common divisor of the configured intervals so
+// every one of them is a multiple of it; the adaptive CO2 interval doubles from its lower bound and
+// stops at its upper one, so it stays a multiple as well
+static twr_tick_t _application_window_period(void)
+{
+    const uint32_t intervals[] = {
+        config.send_interval, config.measure_interval, config.co2_interval_min,
+        config.co2_interval_max, config.voc_interval, config.barometer_interval
+    };
+
+    twr_tick_t period = 0;
+
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(intervals); i++)
+    {
+        twr_tick_t a = period;
+        twr_tick_t b = intervals[i];
+
+        while (b != 0)
+        {
+            twr_tick_t r = a % b;
+
+            a = b;
+            b = r;
+        }
+
+        period = a;
+    }
+
+    return period;
+}
+
+// Hand the intervals in config to the drivers and the schedule
+static void _application_intervals_apply(void)
+{
+    coordinator_set_period(_application_window_period());
+    coordinator_set_interval(battery_sensor_id, config.send_interval);
+
+    for (size_t i = 0; i < discovery_get_count(); i++)
+    {
+        const discovery_candidate_t *candidate = discovery_get_candidate(i);
+
+        if (!candidate->attached)
+        {
+            continue;
+        }
+
+        if (candidate->attach == humidity_tag_attach)
+        {
+            coordinator_set_interval(((humidity_tag_t *) candidate->param)->sensor_id, config.measure_interval);
+        }
+        else if (candidate->attach == voc_lp_tag_attach)
+        {
+            coordinator_set_interval(voc_lp_sensor_id, config.voc_interval);
+        }
+        else if (candidate->attach == barometer_tag_attach)
+        {
+            coordinator_set_interval(barometer_sensor_id, config.barometer_interval);
+        }
+    }
+
+    co2_adaptive_config.interval_min = config.co2_interval_min;
+    co2_adaptive_config.interval_max = config.co2_interval_max;
+
+    adaptive_reset(&co2_adaptive);
+
+    if (!calibration_task_id)
+    {
+        coordinator_set_interval(co2_sensor_id, adaptive_get_interval(&co2_adaptive));
+    }
+
+    // Requested frames and a send waiting for the modem keep their plan
+    if (send_wait_tick == 0 && header == HEADER_UPDATE)
+    {
+        twr_scheduler_plan_from_now(0, config.send_interval);
+    }
+}
+
+static const struct
+{
+    const char *name;
+    uint32_t *value;
+    uint32_t min;
+
+} _application_intervals[] = {
+    {"send", &config.send_interval, 60},
+    {"measure", &config.measure_interval, 10},
+    {"co2", &config.co2_interval_min, 60},
+    {"voc", &config.voc_interval, 10},
+    {"barometer", &config.barometer_interval, 10},
+    {"co2_max", &config.co2_interval_max, 60},
+};
+
+static bool _application_interval_set(size_t index, long seconds)
+{
+    if (index >= TWR_ARRAY_LENGTH(_application_intervals) || seconds < _application_intervals[index].min || seconds > 24 * 60 * 60)
+    {
+        return false;
+    }
+
+    // Adaptive CO2 bounds stay ordered, a lower bound above the upper one raises it
+    if (_application_intervals[index].value == &config.co2_interval_max && seconds * 1000 < config.co2_interval_min)
+    {
+        return false;
+    }
+
+    *_application_intervals[index].value = seconds * 1000;
+
+    if (config.co2_interval_max < config.co2_interval_min)
+    {
+        config.co2_interval_max = config.co2_interval_min;
+    }
+
+    return true;
+}
+
+bool at_interval_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_application_intervals); i++)
+    {
+        twr_atci_printf("$INTERVAL: \"%s\",%lu", _application_intervals[i].name, (unsigned long) (*_application_intervals[i].value / 1000));
+    }
+
+    return true;
+}
+
+bool at_interval_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char *comma = strchr(param->txt, ',');
+
+    if (comma == NULL)
+    {
+        return false;
+    }
+
+    char *end;
+    long seconds = strtol(comma + 1, &end, 10);
+
+    if (end == comma + 1 || *end != '\0')
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < TWR_ARRAY_LENGTH(_application_intervals); i++)
+    {
+        if (strlen(_application_intervals[i].name) != (size_t) (comma - param->txt) || strncmp(param->txt, _application_intervals[i].name, comma - param->txt) != 0)
+        {
+            continue;
+        }
+
+        if (!_application_interval_set(i, seconds))
+        {
+            return false;
+        }
+
+        _application_intervals_apply();
+
+        return twr_config_save();
+    }
+
+    return false;
+}
+
+bool at_co2_interval_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$CO2_INTERVAL: %lu,%lu,%lu", (unsigned long) (adaptive_get_interval(&co2_adaptive) / 1000),
+                    (unsigned long) (co2_adaptive_config.interval_min / 1000), (unsigned long) (co2_adaptive_config.interval_max / 1000));
+
+    return true;
+}
+
+bool at_co2_interval_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char *end;
+    long min = strtol(param->txt, &end, 10);
+
+    if (end == param->txt || *end != ',')
+    {
+        return false;
+    }
+
+    long max = strtol(end + 1, &end, 10);
+
+    if (*end != '\0' || min < 60 || max < min || max > 24 * 60 * 60)
+    {
+        return false;
+    }
+
+    config.co2_interval_min = min * 1000;
+    config.co2_interval_max = max * 1000;
+
+    _application_intervals_apply();
+
+    return twr_config_save();
+}
+
+static bool _at_alarm_read(const char *name, alarm_t *alarm, alarm_config_t *alarm_config, payload_field_t field)
+{
+    // Thresholds are set as integers of the unit of the field, kept in its fixed point
+    int32_t unit = payload_field_fixed(field, 1);
+
+    twr_atci_printf("$ALARM_%s: %ld,%ld,%d", name, (long) (alarm_config->threshold / unit), (long) (alarm_config->hysteresis / unit), alarm_is_active(alarm));
+
+    return true;
+}
+
+static bool _application_alarm_set(alarm_config_t *alarm_config, payload_field_t field, long threshold, long hysteresis)
+{
+    if (threshold < 0 || threshold > 0xffff || hysteresis < 0 || hysteresis > threshold)
+    {
+        return false;
+    }
+
+    alarm_config->threshold = payload_field_fixed(field, threshold);
+    alarm_config->hysteresis = payload_field_fixed(field, hysteresis);
+
+    return true;
+}
+
+static bool _at_alarm_set(twr_atci_param_t *param, alarm_config_t *alarm_config, payload_field_t field)
+{
+    char *end;
+    long threshold = strtol(param->txt, &end, 10);
+
+    if (end == param->txt || *end != ',')
+    {
+        return false;
+    }
+
+    long hysteresis = strtol(end + 1, &end, 10);
+
+    if (*end != '\0')
+    {
+        return false;
+    }
+
+    return _application_alarm_set(alarm_config, field, threshold, hysteresis) && twr_config_save();
+}
+
+bool at_alarm_co2_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    return _at_alarm_read("CO2", &alarm_co2, &config.alarm_co2, PAYLOAD_FIELD_CO2);
+}
+
+bool at_alarm_co2_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    return _at_alarm_set(param, &config.alarm_co2, PAYLOAD_FIELD_CO2);
+}
+
+bool at_alarm_voc_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    return _at_alarm_read("VOC", &alarm_voc, &config.alarm_voc, PAYLOAD_FIELD_VOC);
+}
+
+bool at_alarm_voc_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    return _at_alarm_set(param, &config.alarm_voc, PAYLOAD_FIELD_VOC);
+}
+
+bool at_airtime_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$AIRTIME: %lu,%lu,%lu,%lu,%lu", (unsigned long) airtime_get_budget(), (unsigned long) airtime_get_capacity(),
+                    (unsigned long) _application_airtime(PAYLOAD_FIXED_LENGTH), (unsigned long) airtime_get_total(), (unsigned long) airtime_deferred);
+
+    return true;
+}
+
+bool at_retry_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$RETRY: %lu,%lu,%lu,%lu", (unsigned long) retry_get_attempts(&send_retry), (unsigned long) retry_get_failures(&send_retry),
+                    (unsigned long) retry_get_retries(&send_retry), (unsigned long) retry_get_dropped(&send_retry));
+
+    return true;
+}
+
+bool at_stream_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    if (param->length != 1 || (param->txt[0] != '0' && param->txt[0] != '1'))
+    {
+        return false;
+    }
+
+    stream_set_enabled(param->txt[0] == '1');
+
+    return true;
+}
+
+bool at_stream_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$STREAM: %d,%lu,%lu", stream_is_enabled(), (unsigned long) stream_get_count(), (unsigned long) stream_get_dropped());
+
+    return true;
+}
+
+bool at_store_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$STORE: %u,%d", store_get_sequence(), store_get_pending_count());
+
+    return true;
+}
+
+// Events are formatted only here, oldest first
+bool at_trace(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    trace_record_t record;
+    char line[64];
+
+    for (int i = 0; trace_get(i, &record); i++)
+    {
+        trace_format(&record, line, sizeof(line));
+
+        twr_atci_printf("$TRACE: %s", line);
+    }
+
+    return true;
+}
+
+bool at_trace_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    if (param->length != 1 || param->txt[0] != '0')
+    {
+        return false;
+    }
+
+    trace_clear();
+
+    return true;
+}
+
+bool at_trace_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    twr_atci_printf("$TRACE: %d,%lu", trace_get_count(), (unsigned long) trace_get_total());
+
+    return true;
+}
+
+// Bucket counts separated by spaces, see profile_get_bucket_min()
+static void _at_profile_histogram(const uint16_t histogram[PROFILE_BUCKETS], char *buffer, size_t size)
+{
+    size_t length = 0;
+
+    for (int i = 0; i < PROFILE_BUCKETS && length < size; i++)
+    {
+        length += snprintf(buffer + length, size - length, i == 0 ? "%u" : " %u", histogram[i]);
+    }
+}
+
+bool at_profile_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char run[PROFILE_BUCKETS * 6 + 1];
+    char latency[PROFILE_BUCKETS * 6 + 1];
+
+    for (int i = 0; i < PROFILE_SECTION_COUNT; i++)
+    {
+        const profile_stats_t *stats = profile_get_stats(i);
+
+        _at_profile_histogram(stats->run, run, sizeof(run));
+        _at_profile_histogram(stats->latency, latency, sizeof(latency));
+
+        twr_atci_printf("$PROFILE: \"%s\",%lu,%lu,%u,%u,%s,%s", profile_get_name(i), (unsigned long) stats->count,
+                        (unsigned long) stats->run_total, stats->run_max, stats->latency_max, run, latency);
+    }
+
+    return true;
+}
+
+bool at_profile_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    if (param->length != 1 || param->txt[0] != '0')
+    {
+        return false;
+    }
+
+    profile_clear();
+
+    return true;
+}
+
+bool at_tags(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    int attached = discovery_scan(true);
+
+    twr_atci_printf("$TAGS: %d", attached);
+
+    return true;
+}
+
+bool at_tags_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    for (size_t i = 0; i < discovery_get_count(); i++)
+    {
+        const discovery_candidate_t *candidate = discovery_get_candidate(i);
+
+        twr_atci_printf("$TAGS: \"%s\",%d,%d", candidate->name, candidate->i2c_channel, candidate->present);
+    }
+
+    return true;
+}
+
+bool at_energy_read(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char text[2][24];
+
+    for (int i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++)
+    {
+        const energy_coefficient_t *coefficient = energy_get_coefficient(i);
+
+        // Active time in s and charge in mC
+        _application_decimal_format(text[0], sizeof(text[0]), energy_get_active(i), 1000, 1);
+        _application_decimal_format(text[1], sizeof(text[1]), energy_get_charge(i), 1000000, 1);
+
+        twr_atci_printf("$ENERGY: \"%s\",%lu,%s,%lu,%lu,%s", energy_get_name(i), (unsigned long) energy_get_count(i),
+                        text[0], (unsigned long) coefficient->charge, (unsigned long) coefficient->current, text[1]);
+    }
+
+    _application_decimal_format(text[0], sizeof(text[0]), twr_tick_get(), 1000, 1);
+    _application_decimal_format(text[1], sizeof(text[1]), energy_get_idle_charge(), 1000000, 1);
+
+    twr_atci_printf("$ENERGY: \"Idle\",,%s,,%lu,%s", text[0], (unsigned long) energy_get_idle_current(), text[1]);
+
+    _application_decimal_format(text[0], sizeof(text[0]), energy_get_uah_per_day(), 1000, 3);
+
+    twr_atci_printf("$ENERGY: \"Total\",%s", text[0]);
+
+    return true;
+}
+
+bool at_energy_set(twr_atci_param_t *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    char *end;
+    long index = strtol(param->txt, &end, 10);
+
+    if (end == param->txt || *end != ',' || index < 0 || index > ENERGY_SUBSYSTEM_COUNT)
+    {
+        return false;
+    }
+
+    long charge = strtol(end + 1, &end, 10);
+
+    if (*end != ',' || charge < 0)
+    {
+        return false;
+    }
+
+    long current = strtol(end + 1, &end, 10);
+
+    if (*end != '\0' || current < 0)
+    {
+        return false;
+    }
+
+    energy_coefficient_t coefficient = {
+        .charge = charge,
+        .current = current,
+    };
+
+    // Index past the subsystems is the idle current of the unit
+    if (index == ENERGY_SUBSYSTEM_COUNT)
+    {
+        energy_set_idle_current(coefficient.current);
+    }
+    else
+    {
+        energy_set_coefficient(index, &coefficient);
+    }
+
+    return true;
+}
+
+// Fixed point statistic in physical units with the given decimals, formatted without float
+static void _at_status_format(char *buffer, size_t size, int32_t value, int32_t num, int32_t den, int decimals)
+{
+    uint32_t scale = 1;
+
+    for (int i = 0; i < decimals; i++)
+    {
+        scale *= 10;
+    }
+
+    int64_t divisor = (int64_t) num << PAYLOAD_FRACTION_BITS;
+    int64_t scaled = (int64_t) value * den * scale;
+    uint64_t magnitude = ((scaled < 0 ? -scaled : scaled) + divisor / 2) / divisor;
+    const char *sign = scaled < 0 && magnitude != 0 ? "-" : "";
+
+    if (decimals == 0)
+    {
+        snprintf(buffer, size, "%s%lu", sign, (unsigned long) magnitude);
+    }
+    else
+    {
+        snprintf(buffer, size, "%s%lu.%0*lu", sign, (unsigned long) (magnitude / scale), decimals, (unsigned long) (magnitude % scale));
+    }
+}
+
+bool at_status(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_AT);
+
+    static const struct {
+        const char *name;
+        int precision;
+        int32_t num;
+        int32_t den;
+    } values[PAYLOAD_FIELD_COUNT] = {
+            SENSOR_TABLE(_APPLICATION_SENSOR_STATUS)
+    };
+
+    for (size_t i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        int32_t statistics[4];
+        char text[4][16];
+        int precision = values[i].precision;
+
+        if (aggregate_get_mean(sm_window[i], &statistics[0]))
+        {
+            aggregate_get_min(sm_window[i], &statistics[1]);
+            aggregate_get_max(sm_window[i], &statistics[2]);
+            aggregate_get_stddev(sm_window[i], &statistics[3]);
+
+            for (int j = 0; j < 4; j++)
+            {
+                _at_status_format(text[j], sizeof(text[j]), statistics[j], values[i].num, values[i].den, j == 3 ? precision + 1 : precision);
+            }
+
+            twr_atci_printf("$STATUS: \"%s\",%s,%s,%s,%s,%lu", values[i].name, text[0], text[1], text[2], text[3],
+                            (unsigned long) aggregate_get_count(sm_window[i]));
+        }
+        else
+        {
+            twr_atci_printf("$STATUS: \"%s\",", values[i].name);
+        }
+    }
+
+    return true;
+}
+
+// Interval index as in AT$INTERVAL, seconds uint16
+static bool _downlink_interval(const uint8_t *arguments)
+{
+    return _application_interval_set(arguments[0], downlink_get_uint16(arguments, 1));
+}
+
+// 0 CO2, 1 VOC, threshold uint16, hysteresis uint16
+static bool _downlink_alarm(const uint8_t *arguments)
+{
+    alarm_config_t *alarm_config = arguments[0] == 0 ? &config.alarm_co2 : arguments[0] == 1 ? &config.alarm_voc : NULL;
+
+    if (alarm_config == NULL)
+    {
+        return false;
+    }
+
+    return _application_alarm_set(alarm_config, arguments[0] == 0 ? PAYLOAD_FIELD_CO2 : PAYLOAD_FIELD_VOC,
+                                  downlink_get_uint16(arguments, 1), downlink_get_uint16(arguments, 3));
+}
+
+// Payload format, windows per batch frame, both are checked before either is applied
+static bool _downlink_payload(const uint8_t *arguments)
+{
+    if (!_application_payload_valid(arguments[0]) || !_application_batch_valid(arguments[1]))
+    {
+        return false;
+    }
+
+    return _application_payload_set(arguments[0]) && _application_batch_set(arguments[1]);
+}
+
+// 1 starts, 0 stops the calibration
+static bool _downlink_calibration(const uint8_t *arguments)
+{
+    if (arguments[0] == 1 && !calibration_task_id)
+    {
+        calibration_start();
+    }
+    else if (arguments[0] == 0 && calibration_task_id)
+    {
+        calibration_stop();
+    }
+
+    return arguments[0] <= 1;
+}
+
+static bool _downlink_send(const uint8_t *arguments)
+{
+    if (header == HEADER_UPDATE)
+    {
+        header = HEADER_DOWNLINK;
+    }
+
+    twr_scheduler_plan_now(0);
+
+    return true;
 }
 
+static void _application_downlink(void)
+{
+    static const downlink_command_t commands[] = {
+            {DOWNLINK_INTERVAL, 3, _downlink_interval},
+            {DOWNLINK_ALARM, 5, _downlink_alarm},
+            {DOWNLINK_PAYLOAD, 2, _downlink_payload},
+            {DOWNLINK_CALIBRATION, 1, _downlink_calibration},
+            {DOWNLINK_SEND, 0, _downlink_send},
+    };
+
+    static uint8_t buffer[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+    static char tmp[sizeof(buffer) * 2 + 1];
+
+    uint32_t length = twr_cmwx1zzabz_get_received_message_data(&lora, buffer, sizeof(buffer));
+
+    for (size_t i = 0; i < length; i++)
+    {
+        sprintf(tmp + i * 2, "%02x", buffer[i]);
+    }
+
+    tmp[length * 2] = '\0';
+
+    int executed = downlink_execute(commands, TWR_ARRAY_LENGTH(commands), buffer, length);
+
+    twr_atci_printf("$DOWNLINK: %u,%s,%d", twr_cmwx1zzabz_get_received_message_port(&lora), tmp, executed);
+
+    if (executed > 0)
+    {
+        _application_intervals_apply();
+
+        twr_config_save();
+    }
+}
 
 void application_init(void)
 {
 
-    twr_log_init(TWR_LOG_LEVEL_DUMP, TWR_LOG_TIMESTAMP_ABS);
-    twr_data_stream_init(&sm_temperature, 1, &sm_temperature_buffer);
-    twr_data_stream_init(&sm_co2, 1, &sm_co2_buffer);
-    twr_data_stream_init(&sm_voc, 1, &sm_voc_buffer);
-    twr_data_stream_init(&sm_humidity, 1, &sm_humidity_buffer);
-    twr_data_stream_init(&sm_pressure, 1, &sm_pressure_buffer);
-    twr_data_stream_init(&sm_voltage, 1, &sm_voltage_buffer);
+    twr_log_init(LOG_LEVEL, TWR_LOG_TIMESTAMP_ABS);
 
     // Initialize LED
     twr_led_init(&led, TWR_GPIO_LED, false, false);
     twr_led_set_mode(&led, TWR_LED_MODE_ON);
 
+    energy_init();
+    profile_init();
+
+    twr_config_init(CONFIG_SIGNATURE, &config, sizeof(config), (void *) &config_default);
+
+    store_init();
+    airtime_init(AIRTIME_DUTY_CYCLE, AIRTIME_BUDGET);
+    coordinator_init(_application_window_period());
+    backfill_task_id = twr_scheduler_register(backfill_task, NULL, TWR_TICK_INFINITY);
+    retry_init(&send_retry, &send_retry_config);
+    send_retry_task_id = twr_scheduler_register(send_retry_task, NULL, TWR_TICK_INFINITY);
+
     // Initilize CO2
     twr_module_co2_init();
-    twr_module_co2_set_update_interval(MEASURE_INTERVAL_CO2);
     twr_module_co2_set_event_handler(co2_module_event_handler, NULL);
+    co2_adaptive_config.interval_min = config.co2_interval_min;
+    co2_adaptive_config.interval_max = config.co2_interval_max;
+    adaptive_init(&co2_adaptive, &co2_adaptive_config);
+    co2_sensor_id = coordinator_add(_application_co2_measure, NULL, adaptive_get_interval(&co2_adaptive));
+
+    alarm_init(&alarm_co2, &config.alarm_co2);
+    alarm_init(&alarm_voc, &config.alarm_voc);
+    alarm_task_id = twr_scheduler_register(alarm_task, NULL, TWR_TICK_INFINITY);
 
     // Initialize button
     twr_button_init(&button, TWR_GPIO_BUTTON, TWR_GPIO_PULL_DOWN, false);
@@ -357,36 +1759,20 @@ void application_init(void)
     // Initialize battery
     twr_module_battery_init();
     twr_module_battery_set_event_handler(battery_event_handler, NULL);
-    twr_module_battery_set_update_interval(MEASURE_INTERVAL);
-
-    // Initialize VOC-LP Tag
-    twr_tag_voc_lp_init(&voc_lp, TWR_I2C_I2C0);
-    twr_tag_voc_lp_set_event_handler(&voc_lp, voc_lp_tag_event_handler, NULL);
-    twr_tag_voc_lp_set_update_interval(&voc_lp, MEASURE_INTERVAL_VOC);
-
-    // Initialize Barometer Tag
-    twr_tag_barometer_init(&barometer, TWR_I2C_I2C0);
-    twr_tag_barometer_set_update_interval(&barometer, MEASURE_INTERVAL_BAROMETER);
-    twr_tag_barometer_set_event_handler(&barometer, barometer_tag_event_handler, NULL);
-
-    // Hudmidity
-    static humidity_tag_t humidity_tag_0_0;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R1, TWR_I2C_I2C0, &humidity_tag_0_0);
-
-    static humidity_tag_t humidity_tag_0_2;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R2, TWR_I2C_I2C0, &humidity_tag_0_2);
-
-    static humidity_tag_t humidity_tag_0_4;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R3, TWR_I2C_I2C0, &humidity_tag_0_4);
-
-    static humidity_tag_t humidity_tag_1_0;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R1, TWR_I2C_I2C1, &humidity_tag_1_0);
-
-    static humidity_tag_t humidity_tag_1_2;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R2, TWR_I2C_I2C1, &humidity_tag_1_2);
-
-    static humidity_tag_t humidity_tag_1_4;
-    humidity_tag_init(TWR_TAG_HUMIDITY_REVISION_R3, TWR_I2C_I2C1, &humidity_tag_1_4);
+    battery_sensor_id = coordinator_add(_application_battery_measure, NULL, config.send_interval);
+
+    // Attach only the tags that answer, VOC-LP, Barometer and Humidity
+    static discovery_candidate_t candidates[] = {
+            {.name = "VOC-LP", .i2c_channel = TWR_I2C_I2C0, .probe = discovery_probe_sgp40, .attach = voc_lp_tag_attach},
+            {.name = "Barometer", .i2c_channel = TWR_I2C_I2C0, .probe = discovery_probe_mpl3115a2, .attach = barometer_tag_attach},
+            {.name = "Humidity R1", .i2c_channel = TWR_I2C_I2C0, .probe = discovery_probe_hts221, .attach = humidity_tag_attach, .param = &humidity_tags[0]},
+            {.name = "Humidity R2", .i2c_channel = TWR_I2C_I2C0, .probe = discovery_probe_hdc2080, .attach = humidity_tag_attach, .param = &humidity_tags[1]},
+            {.name = "Humidity R3", .i2c_channel = TWR_I2C_I2C0, .probe = discovery_probe_sht20, .attach = humidity_tag_attach, .param = &humidity_tags[2]},
+            {.name = "Humidity R1", .i2c_channel = TWR_I2C_I2C1, .probe = discovery_probe_hts221, .attach = humidity_tag_attach, .param = &humidity_tags[3]},
+            {.name = "Humidity R2", .i2c_channel = TWR_I2C_I2C1, .probe = discovery_probe_hdc2080, .attach = humidity_tag_attach, .param = &humidity_tags[4]},
+            {.name = "Humidity R3", .i2c_channel = TWR_I2C_I2C1, .probe = discovery_probe_sht20, .attach = humidity_tag_attach, .param = &humidity_tags[5]},
+    };
+    discovery_init(candidates, TWR_ARRAY_LENGTH(candidates), DISCOVERY_INTERVAL);
 
     // Initialize lora module
     twr_cmwx1zzabz_init(&lora, TWR_UART_UART1);
@@ -400,108 +1786,406 @@ void application_init(void)
             {"$SEND", at_send, NULL, NULL, NULL, "Immediately send packet"},
             {"$CALIBRATION", at_calibration, NULL, NULL, NULL, "Immediately send packet"},
             {"$STATUS", at_status, NULL, NULL, NULL, "Show status"},
+            {"$PAYLOAD", NULL, at_payload_set, at_payload_read, NULL, "Payload format 0:fixed, 1:compact, 2:batch"},
+            {"$INTERVAL", NULL, at_interval_set, at_interval_read, NULL, "Intervals in seconds, set send|measure|co2|voc|barometer,seconds"},
+            {"$CO2_INTERVAL", NULL, at_co2_interval_set, at_co2_interval_read, NULL, "CO2 interval current,min,max in seconds, set min,max"},
+            {"$ALARM_CO2", NULL, at_alarm_co2_set, at_alarm_co2_read, NULL, "CO2 alarm threshold,hysteresis in ppm, 0 disables"},
+            {"$ALARM_VOC", NULL, at_alarm_voc_set, at_alarm_voc_read, NULL, "VOC alarm threshold,hysteresis in ppb, 0 disables"},
+            {"$BATCH", NULL, at_batch_set, at_batch_read, NULL, "Windows per batch frame 1-8"},
+            {"$ENERGY", NULL, at_energy_set, at_energy_read, NULL, "Read name,count,active s,uC/op,uA,mC and mAh/day, set index,uC/op,uA"},
+            {"$AIRTIME", NULL, NULL, at_airtime_read, NULL, "Read remaining,capacity,fixed frame,used ms of airtime and deferred frames"},
+            {"$RETRY", NULL, NULL, at_retry_read, NULL, "Read attempts,failures,retries,dropped frames"},
+            {"$PROFILE", NULL, at_profile_set, at_profile_read, NULL, "Read name,runs,run ms,max run ms,max latency ms,run and latency histograms, set 0 clears"},
+            {"$STORE", NULL, NULL, at_store_read, NULL, "Read next sequence,pending records"},
+            {"$STREAM", NULL, at_stream_set, at_stream_read, NULL, "Raw samples on the console 1:on, 0:off, read enabled,samples,dropped"},
+            {"$TAGS", at_tags, NULL, at_tags_read, NULL, "Probe for missing tags, read name,i2c,present"},
+            {"$TRACE", at_trace, at_trace_set, at_trace_read, NULL, "Print seconds,event,arg,value, set 0 clears, read events,total"},
             AT_LED_COMMANDS,
             TWR_ATCI_COMMAND_CLAC,
             TWR_ATCI_COMMAND_HELP
     };
     twr_atci_init(commands, TWR_ATCI_COMMANDS_LENGTH(commands));
+    stream_init();
+
+    // Calibration interrupted by a reboot goes on with its stage
+    if (config.calibration_stage == CALIBRATION_STAGE_FLUSH || config.calibration_stage == CALIBRATION_STAGE_ROUNDS)
+    {
+        _calibration_run();
+        twr_atci_printf("$CO2_CALIBRATION: \"RESUME\"");
+    }
 
-    twr_log_debug("INIT");
+    TRACE_INFO(TRACE_EVENT_INIT, 0, 0);
     twr_scheduler_plan_current_relative(10 * 1000);
 }
 
-void application_task(void)
+// Write the window to the store and start a new one so the next frame carries the statistics since this send
+static uint16_t _application_window_close(void)
 {
-    if (!twr_cmwx1zzabz_is_ready(&lora))
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+    payload_window_raw(sm_window, raw);
+
+    uint16_t sequence = store_append(raw);
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        aggregate_reset(sm_window[i]);
+    }
+
+    return sequence;
+}
+
+static twr_tick_t _application_airtime(size_t length)
+{
+    return airtime_calculate(twr_cmwx1zzabz_get_band(&lora), twr_cmwx1zzabz_get_datarate(&lora), length);
+}
+
+// Longest frame of a single window in the configured format
+static size_t _application_window_length(void)
+{
+    return config.payload_format == PAYLOAD_FORMAT_FIXED ? PAYLOAD_FIXED_LENGTH : PAYLOAD_COMPACT_MAX_LENGTH;
+}
+
+// Time until the budget allows a frame of at most length bytes, regular and backfill frames leave room for an urgent one
+static twr_tick_t _application_airtime_wait(uint8_t frame_header, size_t length)
+{
+    twr_tick_t airtime = _application_airtime(length);
+
+    if (frame_header == HEADER_UPDATE || frame_header == HEADER_BACKFILL)
+    {
+        airtime += _application_airtime(_application_window_length());
+    }
+
+    twr_tick_t wait = airtime_get_wait(airtime);
+
+    if (wait > 0)
+    {
+        TRACE_WARNING(TRACE_EVENT_AIRTIME, frame_header, wait / 1000 > INT16_MAX ? INT16_MAX : wait / 1000);
+
+        airtime_deferred++;
+    }
+
+    return wait;
+}
+
+// Hand send_frame to the modem
+static void _application_transmit(void)
+{
+    bool accepted;
+
+    airtime_take(_application_airtime(send_frame.length));
+
+    if (send_frame.confirmed)
+    {
+        accepted = twr_cmwx1zzabz_send_message_confirmed(&lora, send_frame.buffer, send_frame.length);
+    }
+    else
+    {
+        accepted = twr_cmwx1zzabz_send_message(&lora, send_frame.buffer, send_frame.length);
+    }
+
+    static char tmp[PAYLOAD_MAX_LENGTH * 2 + 1];
+    for (size_t i = 0; i < send_frame.length; i++)
+    {
+        sprintf(tmp + i * 2, "%02x", send_frame.buffer[i]);
+    }
+
+    twr_atci_printf("$SEND: %s", tmp);
+
+    if (!accepted)
+    {
+        _application_send_failed();
+    }
+}
+
+static void _application_send(uint8_t frame_header, const uint8_t *buffer, size_t length, bool confirmed)
+{
+    send_frame.header = frame_header;
+    send_frame.acknowledge = UPLINK_CONFIRM_URGENT && (frame_header == HEADER_ALARM || frame_header == HEADER_BUTTON_CLICK);
+    send_frame.confirmed = confirmed || send_frame.acknowledge;
+    send_frame.length = length;
+
+    memcpy(send_frame.buffer, buffer, length);
+
+    retry_start(&send_retry);
+
+    _application_transmit();
+}
+
+// FNV-1a of the DevEUI the modem reports, it tells the units apart in the retry delays; taken at
+// a failure, when the modem has long reported it and a new one set over AT counts as well
+static void _application_retry_seed(void)
+{
+    char deveui[16 + 1];
+    uint32_t hash = 2166136261u;
+
+    twr_cmwx1zzabz_get_deveui(&lora, deveui);
+
+    for (const char *c = deveui; *c != '\0'; c++)
+    {
+        hash = (hash ^ (uint8_t) *c) * 16777619u;
+    }
+
+    retry_seed(&send_retry, hash);
+}
+
+// The last frame failed, it is sent again later or its windows go back to the store for backfill
+static void _application_send_failed(void)
+{
+    if (!retry_is_active(&send_retry))
+    {
+        store_release();
+
+        return;
+    }
+
+    _application_retry_seed();
+
+    twr_tick_t delay = retry_fail(&send_retry);
+
+    if (delay == TWR_TICK_INFINITY)
     {
-        twr_scheduler_plan_current_relative(100);
+        TRACE_WARNING(TRACE_EVENT_RETRY, send_frame.header, -1);
+
+        store_release();
+
+        return;
+    }
 
+    TRACE_INFO(TRACE_EVENT_RETRY, send_frame.header, delay / 1000);
+
+    twr_scheduler_plan_from_now(send_retry_task_id, delay);
+}
+
+// A newer frame replaces the one waiting for its retry
+static void _application_send_drop(void)
+{
+    if (!retry_is_active(&send_retry))
+    {
         return;
     }
-    twr_log_debug("TASK");
 
-    static uint8_t buffer[16];
+    TRACE_WARNING(TRACE_EVENT_RETRY, send_frame.header, -1);
+
+    retry_drop(&send_retry);
+
+    store_release();
+
+    send_retry_wait = false;
 
-    memset(buffer, 0xff, sizeof(buffer));
+    twr_scheduler_plan_absolute(send_retry_task_id, TWR_TICK_INFINITY);
+}
+
+void send_retry_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_SEND_RETRY);
+
+    (void) param;
+
+    if (!retry_is_active(&send_retry))
+    {
+        return;
+    }
 
-    buffer[0] = header;
+    // Sent when lora_callback reports the modem ready
+    send_retry_wait = !twr_cmwx1zzabz_is_ready(&lora);
 
-    float voltage_avg = NAN;
+    if (send_retry_wait)
+    {
+        return;
+    }
 
-    twr_data_stream_get_average(&sm_voltage, &voltage_avg);
+    twr_tick_t wait = _application_airtime_wait(send_frame.header, send_frame.length);
 
-    if (!isnan(voltage_avg))
+    if (wait > 0)
     {
-        buffer[1] = ceil(voltage_avg * 10.f);
+        twr_scheduler_plan_current_from_now(wait);
+
+        return;
     }
 
-    float temperature_avg = NAN;
+    retry_attempt(&send_retry);
+
+    _application_transmit();
+}
+
+void backfill_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_BACKFILL);
+
+    (void) param;
+
+    // Sent when lora_callback reports the modem ready
+    backfill_wait = !twr_cmwx1zzabz_is_ready(&lora);
+
+    if (backfill_wait)
+    {
+        return;
+    }
 
-    twr_data_stream_get_average(&sm_temperature, &temperature_avg);
+    twr_tick_t wait = _application_airtime_wait(HEADER_BACKFILL, PAYLOAD_MAX_LENGTH);
 
-    if (!isnan(temperature_avg))
+    if (wait > 0)
     {
-        int16_t temperature_i16 = (int16_t) (temperature_avg * 10.f);
+        twr_scheduler_plan_current_from_now(wait);
 
-        buffer[2] = temperature_i16 >> 8;
-        buffer[3] = temperature_i16;
+        return;
     }
 
-    float humidity_avg = NAN;
+    _application_send_drop();
 
-    twr_data_stream_get_average(&sm_humidity, &humidity_avg);
+    // Windows still waiting in the batch go out with it
+    uint16_t before = payload_batch_get_count(&payload_batch) > 0 ? payload_batch_sequence : store_get_sequence();
+    uint16_t raw[PAYLOAD_BATCH_MAX][PAYLOAD_FIELD_COUNT];
+    uint16_t sequence;
 
-    if (!isnan(humidity_avg))
+    int count = store_get_pending(&sequence, raw, PAYLOAD_BATCH_MAX, before);
+
+    if (count == 0)
     {
-        buffer[4] = humidity_avg * 2;
+        return;
     }
 
-    float voc_avg = NAN;
+    static payload_batch_t batch;
+    static uint8_t buffer[PAYLOAD_MAX_LENGTH];
 
-    twr_data_stream_get_average(&sm_voc, &voc_avg);
+    payload_batch_reset(&batch);
 
-    if (!isnan(voc_avg))
+    for (int i = 0; i < count; i++)
     {
-        uint16_t value = (uint16_t) voc_avg;
-        buffer[5] = value >> 8;
-        buffer[6] = value;
+        payload_batch_add_raw(&batch, raw[i]);
     }
 
-    float pressure_avg = NAN;
+    size_t length = payload_backfill_encode(&batch, HEADER_BACKFILL, sequence, store_get_sequence() - sequence, buffer, sizeof(buffer));
+
+    store_queue(sequence, count - payload_batch_get_count(&batch));
+
+    TRACE_INFO(TRACE_EVENT_BACKFILL, count - payload_batch_get_count(&batch), sequence);
+
+    _application_send(HEADER_BACKFILL, buffer, length, true);
+}
 
-    twr_data_stream_get_average(&sm_pressure, &pressure_avg);
+void application_task(void)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_APPLICATION);
 
-    if (!isnan(pressure_avg))
+    if (!twr_cmwx1zzabz_is_ready(&lora))
     {
-        uint16_t value = pressure_avg / 2.f;
-        buffer[7] = value >> 8;
-        buffer[8] = value;
+        if (send_wait_tick == 0)
+        {
+            send_wait_tick = twr_tick_get();
+        }
+
+        // lora_callback plans the task as soon as the modem is ready, the timeout is the fallback
+        if (twr_tick_get() - send_wait_tick < SEND_READY_TIMEOUT)
+        {
+            twr_scheduler_plan_current_absolute(send_wait_tick + SEND_READY_TIMEOUT);
+
+            return;
+        }
+
+        // Modem is down, the window waits in the store for backfill
+        TRACE_WARNING(TRACE_EVENT_TASK_MODEM_NOT_READY, header, 0);
+
+        _application_window_close();
+
+        payload_batch_reset(&payload_batch);
+
+        send_wait_tick = 0;
+
+        header = HEADER_UPDATE;
+        twr_scheduler_plan_current_relative(config.send_interval);
+
+        return;
     }
 
-    float co2_avg = NAN;
+    send_wait_tick = 0;
 
-    twr_data_stream_get_average(&sm_co2, &co2_avg);
+    TRACE_DEBUG(TRACE_EVENT_TASK, header, 0);
 
-    if (!isnan(co2_avg))
+    // A frame going out now waits for the airtime budget, a window that only joins the batch does not
+    bool batched = config.payload_format == PAYLOAD_FORMAT_BATCH && header == HEADER_UPDATE &&
+                   payload_batch_get_count(&payload_batch) + 1 < config.payload_batch_size;
+
+    if (!batched)
     {
-        uint16_t value = co2_avg;
-        buffer[9] = value >> 8;
-        buffer[10] = value;
+        twr_tick_t wait = _application_airtime_wait(header, config.payload_format == PAYLOAD_FORMAT_BATCH ? PAYLOAD_MAX_LENGTH : _application_window_length());
+
+        if (wait > 0)
+        {
+            // Regular window runs on and goes out with the next one, requested frames are deferred
+            if (header == HEADER_UPDATE)
+            {
+                twr_scheduler_plan_current_relative(config.send_interval);
+            }
+            else
+            {
+                twr_scheduler_plan_current_from_now(wait);
+            }
+
+            return;
+        }
+
+        _application_send_drop();
     }
 
-    twr_cmwx1zzabz_send_message(&lora, buffer, sizeof(buffer));
+    static uint8_t buffer[PAYLOAD_MAX_LENGTH];
 
-    static char tmp[sizeof(buffer) * 2 + 1];
-    for (size_t i = 0; i < sizeof(buffer); i++)
+    size_t length;
+
+    if (config.payload_format == PAYLOAD_FORMAT_BATCH)
     {
-        sprintf(tmp + i * 2, "%02x", buffer[i]);
+        uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+        payload_window_raw(sm_window, raw);
+
+        if (payload_batch_get_count(&payload_batch) == 0)
+        {
+            payload_batch_sequence = store_get_sequence();
+        }
+
+        payload_batch_add_raw(&payload_batch, raw);
+
+        _application_window_close();
+
+        // Regular windows wait for a full batch, boot and button frames flush it right away
+        if (header == HEADER_UPDATE && payload_batch_get_count(&payload_batch) < config.payload_batch_size)
+        {
+            TRACE_DEBUG(TRACE_EVENT_TASK_BATCHED, payload_batch_get_count(&payload_batch), 0);
+
+            twr_scheduler_plan_current_relative(config.send_interval);
+
+            return;
+        }
+
+        int count = payload_batch_get_count(&payload_batch);
+
+        length = payload_batch_encode(&payload_batch, header, buffer, sizeof(buffer));
+
+        count -= payload_batch_get_count(&payload_batch);
+
+        store_queue(payload_batch_sequence, count);
+
+        payload_batch_sequence += count;
     }
+    else
+    {
+        length = payload_encode(config.payload_format, header, sm_window, buffer, sizeof(buffer));
 
-    twr_atci_printf("$SEND: %s", tmp);
+        store_queue(_application_window_close(), 1);
+    }
 
-    twr_log_debug("TASK DONE");
+    _application_send(header, buffer, length, uplink_counter++ % UPLINK_CONFIRM_EVERY == 0 || link_lost);
+
+    TRACE_DEBUG(TRACE_EVENT_TASK_DONE, header, length);
+
+    if (header == HEADER_ALARM)
+    {
+        alarm_sent = true;
+        alarm_sent_tick = twr_tick_get();
+    }
 
     header = HEADER_UPDATE;
-    twr_scheduler_plan_current_relative(SEND_DATA_INTERVAL);
+    twr_scheduler_plan_current_relative(config.send_interval);
 
 }
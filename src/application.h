@@ -6,6 +6,8 @@
 #endif
 
 #include <twr.h>
+#include <alarm.h>
+#include <payload.h>
 
 typedef struct
 {
@@ -19,7 +21,42 @@ typedef struct
 {
     twr_tag_humidity_t self;
     event_param_t param;
+    twr_tag_humidity_revision_t revision;
+    twr_i2c_channel_t i2c_channel;
+    int sensor_id;
 
 } humidity_tag_t;
 
+// Measurement point of the humidity tag on a bus, keyed by event_param_t.channel of the tag
+typedef struct
+{
+    twr_i2c_channel_t i2c_channel;
+    bool used;
+    uint8_t channel;
+    payload_field_t temperature;
+    payload_field_t humidity;
+
+} humidity_channel_t;
+
+// Settings kept in EEPROM, intervals in ms
+typedef struct
+{
+    uint32_t send_interval;
+    uint32_t measure_interval;
+    uint32_t co2_interval_min;
+    uint32_t co2_interval_max;
+    uint32_t voc_interval;
+    uint32_t barometer_interval;
+    alarm_config_t alarm_co2;
+    alarm_config_t alarm_voc;
+    uint8_t payload_format;
+    uint8_t payload_batch_size;
+    // Progress of a running CO2 calibration, resumed after a reboot
+    uint8_t calibration_stage;
+    uint8_t calibration_rounds;
+    // Seconds of the flush stage done at its last reading
+    uint16_t calibration_flush_elapsed;
+
+} config_t;
+
 #endif // _APPLICATION_H
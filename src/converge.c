@@ -0,0 +1,82 @@
+#include <converge.h>
+
+void converge_init(converge_t *self, const converge_config_t *config)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_config = config;
+}
+
+void converge_reset(converge_t *self)
+{
+    self->_count = 0;
+}
+
+static int _converge_window(converge_t *self)
+{
+    int window = self->_config->window;
+
+    return window < 1 ? 1 : window > CONVERGE_WINDOW_MAX ? CONVERGE_WINDOW_MAX : window;
+}
+
+// Statistics of the readings in the window
+static void _converge_aggregate(converge_t *self, aggregate_t *aggregate)
+{
+    aggregate_reset(aggregate);
+
+    for (int i = 0; i < self->_count; i++)
+    {
+        aggregate_feed(aggregate, self->_values[i]);
+    }
+}
+
+bool converge_feed(converge_t *self, int32_t value)
+{
+    int window = _converge_window(self);
+
+    if (self->_count == window)
+    {
+        memmove(self->_values, self->_values + 1, (window - 1) * sizeof(self->_values[0]));
+
+        self->_count--;
+    }
+
+    self->_values[self->_count++] = value;
+
+    return converge_is_done(self);
+}
+
+bool converge_is_done(converge_t *self)
+{
+    int32_t stddev;
+
+    if (self->_count < _converge_window(self) || !converge_get_stddev(self, &stddev))
+    {
+        return false;
+    }
+
+    return stddev <= self->_config->tolerance;
+}
+
+int converge_get_count(converge_t *self)
+{
+    return self->_count;
+}
+
+bool converge_get_mean(converge_t *self, int32_t *mean)
+{
+    aggregate_t aggregate;
+
+    _converge_aggregate(self, &aggregate);
+
+    return aggregate_get_mean(&aggregate, mean);
+}
+
+bool converge_get_stddev(converge_t *self, int32_t *stddev)
+{
+    aggregate_t aggregate;
+
+    _converge_aggregate(self, &aggregate);
+
+    return aggregate_get_stddev(&aggregate, stddev);
+}
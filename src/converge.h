@@ -0,0 +1,51 @@
+#ifndef _CONVERGE_H
+#define _CONVERGE_H
+
+#include <aggregate.h>
+
+// Convergence of successive readings
+//
+// Keeps the last window readings and reports convergence once the window is full and their
+// standard deviation is within the tolerance, so a reading that is still drifting or noisy
+// keeps it open. Readings are integers in a fixed point unit of the caller, e.g. tenths of ppm,
+// the statistics are computed by aggregate_t without floating point.
+
+#define CONVERGE_WINDOW_MAX 8
+
+typedef struct
+{
+    // Readings judged together, up to CONVERGE_WINDOW_MAX
+    int window;
+    // Standard deviation of the window still treated as converged, in the unit of the readings
+    int32_t tolerance;
+
+} converge_config_t;
+
+typedef struct
+{
+    const converge_config_t *_config;
+    int32_t _values[CONVERGE_WINDOW_MAX];
+    int _count;
+
+} converge_t;
+
+void converge_init(converge_t *self, const converge_config_t *config);
+
+// Forget the readings, e.g. when the conditions changed
+void converge_reset(converge_t *self);
+
+// Account a new reading, returns true when the window converged
+bool converge_feed(converge_t *self, int32_t value);
+
+bool converge_is_done(converge_t *self);
+
+// Readings in the window
+int converge_get_count(converge_t *self);
+
+// Mean rounded to the nearest integer and standard deviation rounded down of the readings in
+// the window, false when it is empty
+bool converge_get_mean(converge_t *self, int32_t *mean);
+
+bool converge_get_stddev(converge_t *self, int32_t *stddev);
+
+#endif // _CONVERGE_H
@@ -0,0 +1,120 @@
+#include <coordinator.h>
+#include <profile.h>
+
+typedef struct
+{
+    coordinator_measure_t measure;
+    void *param;
+    twr_tick_t interval;
+    twr_tick_t due;
+
+} coordinator_sensor_t;
+
+static struct
+{
+    coordinator_sensor_t sensors[COORDINATOR_SENSORS_MAX];
+    int count;
+    twr_tick_t period;
+    twr_scheduler_task_id_t task_id;
+
+} _coordinator;
+
+static void _coordinator_task(void *param);
+
+void coordinator_init(twr_tick_t period)
+{
+    memset(&_coordinator, 0, sizeof(_coordinator));
+
+    _coordinator.period = period;
+    _coordinator.task_id = twr_scheduler_register(_coordinator_task, NULL, TWR_TICK_INFINITY);
+}
+
+void coordinator_set_period(twr_tick_t period)
+{
+    _coordinator.period = period;
+}
+
+// Window nearest to tick, but not before the next one so a late handler does not measure twice
+static twr_tick_t _coordinator_window(twr_tick_t tick)
+{
+    twr_tick_t now = twr_tick_get();
+    twr_tick_t window = (tick + _coordinator.period / 2) / _coordinator.period * _coordinator.period;
+    twr_tick_t next = (now / _coordinator.period + 1) * _coordinator.period;
+
+    return window < next ? next : window;
+}
+
+static void _coordinator_plan(void)
+{
+    twr_tick_t due = TWR_TICK_INFINITY;
+
+    for (int i = 0; i < _coordinator.count; i++)
+    {
+        if (_coordinator.sensors[i].due < due)
+        {
+            due = _coordinator.sensors[i].due;
+        }
+    }
+
+    twr_scheduler_plan_absolute(_coordinator.task_id, due);
+}
+
+int coordinator_add(coordinator_measure_t measure, void *param, twr_tick_t interval)
+{
+    if (_coordinator.count == COORDINATOR_SENSORS_MAX)
+    {
+        return -1;
+    }
+
+    coordinator_sensor_t *sensor = &_coordinator.sensors[_coordinator.count];
+
+    sensor->measure = measure;
+    sensor->param = param;
+    sensor->interval = interval;
+    sensor->due = twr_tick_get();
+
+    _coordinator_plan();
+
+    return _coordinator.count++;
+}
+
+void coordinator_set_interval(int id, twr_tick_t interval)
+{
+    if (id < 0 || id >= _coordinator.count)
+    {
+        return;
+    }
+
+    coordinator_sensor_t *sensor = &_coordinator.sensors[id];
+
+    sensor->interval = interval;
+    sensor->due = interval == TWR_TICK_INFINITY ? TWR_TICK_INFINITY : _coordinator_window(twr_tick_get() + interval);
+
+    _coordinator_plan();
+}
+
+static void _coordinator_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_COORDINATOR);
+
+    (void) param;
+
+    twr_tick_t now = twr_tick_get();
+
+    for (int i = 0; i < _coordinator.count; i++)
+    {
+        coordinator_sensor_t *sensor = &_coordinator.sensors[i];
+
+        if (sensor->due > now)
+        {
+            continue;
+        }
+
+        // Planned before the call, the event handler of a synchronous driver may plan it again
+        sensor->due = sensor->interval == TWR_TICK_INFINITY ? TWR_TICK_INFINITY : _coordinator_window(now + sensor->interval);
+
+        sensor->measure(sensor->param);
+    }
+
+    _coordinator_plan();
+}
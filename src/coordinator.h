@@ -0,0 +1,30 @@
+#ifndef _COORDINATOR_H
+#define _COORDINATOR_H
+
+#include <twr.h>
+
+// Measurement coordinator
+//
+// Sensors are started from one task instead of the update timers of their drivers. The next
+// measurement of every sensor is rounded to a multiple of the window period, so sensors whose
+// intervals are multiples of it start in the same wakeup, back to back on the bus, instead of
+// each at its own drifting phase.
+
+// CO2, battery, VOC-LP, Barometer and six Humidity tags
+#define COORDINATOR_SENSORS_MAX 10
+
+// Starts a measurement, the driver reports the result by its event handler
+typedef bool (*coordinator_measure_t)(void *param);
+
+void coordinator_init(twr_tick_t period);
+
+// Window period, the intervals of the sensors are rounded to its multiples so it should divide all of them
+void coordinator_set_period(twr_tick_t period);
+
+// Register a sensor measured in the next window and then every interval, returns its id or -1 when full
+int coordinator_add(coordinator_measure_t measure, void *param, twr_tick_t interval);
+
+// Next measurement in the window nearest to interval from now and then every interval, TWR_TICK_INFINITY stops the sensor
+void coordinator_set_interval(int id, twr_tick_t interval);
+
+#endif // _COORDINATOR_H
@@ -0,0 +1,181 @@
+#include <discovery.h>
+#include <profile.h>
+#include <trace.h>
+
+#define _DISCOVERY_HTS221_ADDRESS        0x5f
+#define _DISCOVERY_HTS221_WHO_AM_I       0x0f
+#define _DISCOVERY_HTS221_ID             0xbc
+#define _DISCOVERY_HDC2080_ADDRESS       0x40
+#define _DISCOVERY_HDC2080_MANUFACTURER  0xfc
+#define _DISCOVERY_HDC2080_ID            0x4954
+#define _DISCOVERY_SHT20_ADDRESS         0x40
+#define _DISCOVERY_SHT20_READ_USER       0xe7
+#define _DISCOVERY_SGP40_ADDRESS         0x59
+#define _DISCOVERY_MPL3115A2_ADDRESS     0x60
+#define _DISCOVERY_MPL3115A2_WHO_AM_I    0x0c
+#define _DISCOVERY_MPL3115A2_ID          0xc4
+
+static struct
+{
+    discovery_candidate_t *candidates;
+    size_t count;
+    twr_tick_t interval;
+    twr_scheduler_task_id_t task_id;
+
+} _discovery;
+
+static void _discovery_task(void *param);
+
+void discovery_init(discovery_candidate_t *candidates, size_t count, twr_tick_t interval)
+{
+    memset(&_discovery, 0, sizeof(_discovery));
+
+    _discovery.candidates = candidates;
+    _discovery.count = count;
+    _discovery.interval = interval;
+
+    twr_i2c_init(TWR_I2C_I2C0, TWR_I2C_SPEED_400_KHZ);
+    twr_i2c_init(TWR_I2C_I2C1, TWR_I2C_SPEED_100_KHZ);
+
+    _discovery.task_id = twr_scheduler_register(_discovery_task, NULL, TWR_TICK_INFINITY);
+
+    discovery_scan(false);
+}
+
+int discovery_scan(bool all)
+{
+    int attached = 0;
+    size_t missing = 0;
+
+    for (size_t i = 0; i < _discovery.count; i++)
+    {
+        discovery_candidate_t *candidate = &_discovery.candidates[i];
+
+        if (candidate->present && !all)
+        {
+            continue;
+        }
+
+        if (!candidate->probe(candidate->i2c_channel))
+        {
+            if (candidate->present)
+            {
+                TRACE_WARNING(TRACE_EVENT_DISCOVERY, candidate->i2c_channel, i);
+            }
+
+            candidate->present = false;
+
+            missing++;
+
+            continue;
+        }
+
+        candidate->present = true;
+
+        if (candidate->attached)
+        {
+            continue;
+        }
+
+        TRACE_INFO(TRACE_EVENT_DISCOVERY, candidate->i2c_channel, i);
+
+        candidate->attached = true;
+
+        candidate->attach(candidate->param);
+
+        attached++;
+    }
+
+    if (missing > 0)
+    {
+        twr_scheduler_plan_from_now(_discovery.task_id, _discovery.interval);
+    }
+    else
+    {
+        twr_scheduler_plan_absolute(_discovery.task_id, TWR_TICK_INFINITY);
+    }
+
+    return attached;
+}
+
+size_t discovery_get_count(void)
+{
+    return _discovery.count;
+}
+
+const discovery_candidate_t *discovery_get_candidate(size_t index)
+{
+    return index < _discovery.count ? &_discovery.candidates[index] : NULL;
+}
+
+static void _discovery_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_DISCOVERY);
+
+    (void) param;
+
+    discovery_scan(false);
+}
+
+bool discovery_probe_hts221(twr_i2c_channel_t i2c_channel)
+{
+    uint8_t id;
+
+    if (!twr_i2c_memory_read_8b(i2c_channel, _DISCOVERY_HTS221_ADDRESS, _DISCOVERY_HTS221_WHO_AM_I, &id))
+    {
+        return false;
+    }
+
+    return id == _DISCOVERY_HTS221_ID;
+}
+
+bool discovery_probe_hdc2080(twr_i2c_channel_t i2c_channel)
+{
+    uint16_t id;
+
+    if (!twr_i2c_memory_read_16b(i2c_channel, _DISCOVERY_HDC2080_ADDRESS, _DISCOVERY_HDC2080_MANUFACTURER, &id))
+    {
+        return false;
+    }
+
+    return id == _DISCOVERY_HDC2080_ID;
+}
+
+bool discovery_probe_sht20(twr_i2c_channel_t i2c_channel)
+{
+    uint8_t user;
+
+    // Shares the address with HDC2080, which has no ID to check against on SHT20
+    if (!twr_i2c_memory_read_8b(i2c_channel, _DISCOVERY_SHT20_ADDRESS, _DISCOVERY_SHT20_READ_USER, &user))
+    {
+        return false;
+    }
+
+    return !discovery_probe_hdc2080(i2c_channel);
+}
+
+bool discovery_probe_sgp40(twr_i2c_channel_t i2c_channel)
+{
+    // Serial number readout, only the acknowledge of the command matters
+    uint8_t command[2] = { 0x36, 0x82 };
+
+    twr_i2c_transfer_t transfer = {
+        .device_address = _DISCOVERY_SGP40_ADDRESS,
+        .buffer = command,
+        .length = sizeof(command)
+    };
+
+    return twr_i2c_write(i2c_channel, &transfer);
+}
+
+bool discovery_probe_mpl3115a2(twr_i2c_channel_t i2c_channel)
+{
+    uint8_t id;
+
+    if (!twr_i2c_memory_read_8b(i2c_channel, _DISCOVERY_MPL3115A2_ADDRESS, _DISCOVERY_MPL3115A2_WHO_AM_I, &id))
+    {
+        return false;
+    }
+
+    return id == _DISCOVERY_MPL3115A2_ID;
+}
@@ -0,0 +1,56 @@
+#ifndef _DISCOVERY_H
+#define _DISCOVERY_H
+
+#include <twr.h>
+
+// Discovery of optional tags on the I2C buses
+//
+// Each candidate is probed once at boot and attached only when its chip answers, so absent
+// tags cost no bus traffic afterwards. Candidates still missing are probed again every
+// interval to pick up a tag plugged in later. The SDK drivers cannot be detached, a tag is
+// attached once and its driver keeps measuring when the tag is unplugged, the failed
+// measurements are sent as missing values. A scan of all candidates notices the unplugged
+// tag, it is then probed every interval like a missing one and goes on when plugged back.
+
+typedef struct
+{
+    const char *name;
+    twr_i2c_channel_t i2c_channel;
+
+    // Returns true when the chip of the candidate answers on the bus
+    bool (*probe)(twr_i2c_channel_t i2c_channel);
+
+    // Initializes the driver of the candidate, called once on discovery
+    void (*attach)(void *param);
+    void *param;
+
+    // The driver was initialized
+    bool attached;
+
+    // The chip answered the last probe
+    bool present;
+
+} discovery_candidate_t;
+
+// Probes all candidates now and then every interval until all of them are present
+void discovery_init(discovery_candidate_t *candidates, size_t count, twr_tick_t interval);
+
+// Probes the missing candidates now, with all also the present ones, returns the number of newly attached ones
+int discovery_scan(bool all);
+
+size_t discovery_get_count(void);
+
+const discovery_candidate_t *discovery_get_candidate(size_t index);
+
+// Chip probes for the tags of the SDK, all of them use the default I2C address
+bool discovery_probe_hts221(twr_i2c_channel_t i2c_channel);
+
+bool discovery_probe_hdc2080(twr_i2c_channel_t i2c_channel);
+
+bool discovery_probe_sht20(twr_i2c_channel_t i2c_channel);
+
+bool discovery_probe_sgp40(twr_i2c_channel_t i2c_channel);
+
+bool discovery_probe_mpl3115a2(twr_i2c_channel_t i2c_channel);
+
+#endif // _DISCOVERY_H
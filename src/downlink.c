@@ -0,0 +1,58 @@
+#include <downlink.h>
+#include <trace.h>
+
+static const downlink_command_t *_downlink_find(const downlink_command_t *commands, size_t count, uint8_t opcode)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (commands[i].opcode == opcode)
+        {
+            return &commands[i];
+        }
+    }
+
+    return NULL;
+}
+
+int downlink_execute(const downlink_command_t *commands, size_t count, const uint8_t *buffer, size_t length)
+{
+    int executed = 0;
+    size_t offset = 0;
+
+    while (offset < length)
+    {
+        const downlink_command_t *command = _downlink_find(commands, count, buffer[offset]);
+
+        if (command == NULL)
+        {
+            TRACE_WARNING(TRACE_EVENT_DOWNLINK_UNKNOWN, buffer[offset], offset);
+
+            break;
+        }
+
+        if (offset + 1 + command->length > length)
+        {
+            TRACE_WARNING(TRACE_EVENT_DOWNLINK_TRUNCATED, command->opcode, offset);
+
+            break;
+        }
+
+        if (!command->handler(buffer + offset + 1))
+        {
+            TRACE_WARNING(TRACE_EVENT_DOWNLINK_FAILED, command->opcode, offset);
+
+            break;
+        }
+
+        executed++;
+
+        offset += 1 + command->length;
+    }
+
+    return executed;
+}
+
+uint16_t downlink_get_uint16(const uint8_t *arguments, size_t offset)
+{
+    return (uint16_t) (arguments[offset] << 8 | arguments[offset + 1]);
+}
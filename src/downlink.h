@@ -0,0 +1,29 @@
+#ifndef _DOWNLINK_H
+#define _DOWNLINK_H
+
+#include <twr.h>
+
+// Binary command channel over LoRaWAN downlinks
+//
+// A downlink carries one or more commands back to back, each an opcode byte followed by
+// its fixed-length arguments in big endian. Commands run in order, the rest of the frame
+// is dropped at an unknown opcode, truncated arguments or a command that fails.
+
+typedef struct
+{
+    uint8_t opcode;
+
+    // Length of the arguments in bytes
+    uint8_t length;
+
+    bool (*handler)(const uint8_t *arguments);
+
+} downlink_command_t;
+
+// Execute the commands of a downlink, returns the number of commands that succeeded
+int downlink_execute(const downlink_command_t *commands, size_t count, const uint8_t *buffer, size_t length);
+
+// Big endian argument at offset
+uint16_t downlink_get_uint16(const uint8_t *arguments, size_t offset);
+
+#endif // _DOWNLINK_H
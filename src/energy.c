@@ -0,0 +1,133 @@
+#include <energy.h>
+
+#ifndef ENERGY_IDLE_CURRENT
+#define ENERGY_IDLE_CURRENT 20
+#endif
+
+// nC per uAh is 3600 * 1000 and a day 24 * 3600 * 1000 ms, so uAh per day = nC * 24 / ms
+#define _ENERGY_HOURS_PER_DAY 24
+
+static const char *_energy_names[ENERGY_SUBSYSTEM_COUNT] = {
+    [ENERGY_SUBSYSTEM_CO2] = "CO2",
+    [ENERGY_SUBSYSTEM_VOC] = "VOC",
+    [ENERGY_SUBSYSTEM_BAROMETER] = "Barometer",
+    [ENERGY_SUBSYSTEM_HUMIDITY] = "Humidity",
+    [ENERGY_SUBSYSTEM_BATTERY] = "Battery",
+    [ENERGY_SUBSYSTEM_LORA] = "LoRa",
+};
+
+// LP8 lamp and capacitor charge, SGP40 heater, one-shot conversions, ADC divider and the
+// modem wakeup, the radio at 14 dBm is accounted over SEND_MESSAGE_START to SEND_MESSAGE_DONE
+static const energy_coefficient_t _energy_coefficients[ENERGY_SUBSYSTEM_COUNT] = {
+    [ENERGY_SUBSYSTEM_CO2] = { 1200, 0 },
+    [ENERGY_SUBSYSTEM_VOC] = { 100, 0 },
+    [ENERGY_SUBSYSTEM_BAROMETER] = { 30, 0 },
+    [ENERGY_SUBSYSTEM_HUMIDITY] = { 30, 0 },
+    [ENERGY_SUBSYSTEM_BATTERY] = { 5, 0 },
+    [ENERGY_SUBSYSTEM_LORA] = { 500, 44000 },
+};
+
+static struct
+{
+    energy_coefficient_t coefficient[ENERGY_SUBSYSTEM_COUNT];
+    uint32_t idle_current;
+    uint32_t count[ENERGY_SUBSYSTEM_COUNT];
+    twr_tick_t active[ENERGY_SUBSYSTEM_COUNT];
+    twr_tick_t begin[ENERGY_SUBSYSTEM_COUNT];
+    // Operations in progress, e.g. two humidity tags measured in the same wakeup
+    uint8_t running[ENERGY_SUBSYSTEM_COUNT];
+
+} _energy;
+
+void energy_init(void)
+{
+    memset(&_energy, 0, sizeof(_energy));
+
+    memcpy(_energy.coefficient, _energy_coefficients, sizeof(_energy.coefficient));
+
+    _energy.idle_current = ENERGY_IDLE_CURRENT;
+}
+
+void energy_begin(energy_subsystem_t subsystem)
+{
+    if (_energy.running[subsystem]++ == 0)
+    {
+        _energy.begin[subsystem] = twr_tick_get();
+    }
+}
+
+void energy_end(energy_subsystem_t subsystem)
+{
+    if (_energy.running[subsystem] > 0 && --_energy.running[subsystem] == 0)
+    {
+        _energy.active[subsystem] += twr_tick_get() - _energy.begin[subsystem];
+    }
+
+    _energy.count[subsystem]++;
+}
+
+const char *energy_get_name(energy_subsystem_t subsystem)
+{
+    return _energy_names[subsystem];
+}
+
+uint32_t energy_get_count(energy_subsystem_t subsystem)
+{
+    return _energy.count[subsystem];
+}
+
+twr_tick_t energy_get_active(energy_subsystem_t subsystem)
+{
+    return _energy.active[subsystem];
+}
+
+const energy_coefficient_t *energy_get_coefficient(energy_subsystem_t subsystem)
+{
+    return &_energy.coefficient[subsystem];
+}
+
+void energy_set_coefficient(energy_subsystem_t subsystem, const energy_coefficient_t *coefficient)
+{
+    _energy.coefficient[subsystem] = *coefficient;
+}
+
+uint32_t energy_get_idle_current(void)
+{
+    return _energy.idle_current;
+}
+
+void energy_set_idle_current(uint32_t current)
+{
+    _energy.idle_current = current;
+}
+
+uint64_t energy_get_charge(energy_subsystem_t subsystem)
+{
+    const energy_coefficient_t *coefficient = &_energy.coefficient[subsystem];
+
+    return (uint64_t) _energy.count[subsystem] * coefficient->charge * 1000 + _energy.active[subsystem] * coefficient->current;
+}
+
+uint64_t energy_get_idle_charge(void)
+{
+    return twr_tick_get() * _energy.idle_current;
+}
+
+uint32_t energy_get_uah_per_day(void)
+{
+    twr_tick_t uptime = twr_tick_get();
+
+    if (uptime == 0)
+    {
+        return 0;
+    }
+
+    uint64_t charge = energy_get_idle_charge();
+
+    for (int i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++)
+    {
+        charge += energy_get_charge(i);
+    }
+
+    return (charge * _ENERGY_HOURS_PER_DAY + uptime / 2) / uptime;
+}
@@ -0,0 +1,69 @@
+#ifndef _ENERGY_H
+#define _ENERGY_H
+
+#include <twr.h>
+
+// Charge accounting per subsystem
+//
+// Every subsystem counts its operations and the time it was active, where the start and end
+// of an operation are seen by the firmware. The charge of a subsystem is
+// count * charge per operation + active time * active current, the idle current of the whole
+// unit is accounted over the uptime. Coefficients are estimates to be calibrated on a unit.
+// Everything is integer, charges are kept in nC (uA * ms) so no operation loses a fraction.
+
+typedef enum
+{
+    ENERGY_SUBSYSTEM_CO2 = 0,
+    ENERGY_SUBSYSTEM_VOC = 1,
+    ENERGY_SUBSYSTEM_BAROMETER = 2,
+    ENERGY_SUBSYSTEM_HUMIDITY = 3,
+    ENERGY_SUBSYSTEM_BATTERY = 4,
+    ENERGY_SUBSYSTEM_LORA = 5,
+    ENERGY_SUBSYSTEM_COUNT
+
+} energy_subsystem_t;
+
+typedef struct
+{
+    // Charge of one operation in uC
+    uint32_t charge;
+
+    // Current while active in uA
+    uint32_t current;
+
+} energy_coefficient_t;
+
+void energy_init(void);
+
+// Mark the start of an operation, its duration is accounted by energy_end, while operations of a
+// subsystem overlap its active time is counted once
+void energy_begin(energy_subsystem_t subsystem);
+
+// Account an operation, with its duration when energy_begin preceded it
+void energy_end(energy_subsystem_t subsystem);
+
+const char *energy_get_name(energy_subsystem_t subsystem);
+
+uint32_t energy_get_count(energy_subsystem_t subsystem);
+
+// Active time in ms
+twr_tick_t energy_get_active(energy_subsystem_t subsystem);
+
+const energy_coefficient_t *energy_get_coefficient(energy_subsystem_t subsystem);
+
+void energy_set_coefficient(energy_subsystem_t subsystem, const energy_coefficient_t *coefficient);
+
+// Idle current of the unit in uA
+uint32_t energy_get_idle_current(void);
+
+void energy_set_idle_current(uint32_t current);
+
+// Charge since boot in nC
+uint64_t energy_get_charge(energy_subsystem_t subsystem);
+
+uint64_t energy_get_idle_charge(void);
+
+// Average consumption since boot extrapolated to a day in uAh, all subsystems and idle
+uint32_t energy_get_uah_per_day(void);
+
+#endif // _ENERGY_H
@@ -0,0 +1,359 @@
+#include <payload.h>
+
+// Rounding of SENSOR_TABLE applied to the exact quotient, truncf() and ceilf() in integers
+static int32_t _payload_round_truncf(int64_t dividend, int64_t divisor)
+{
+    return dividend / divisor;
+}
+
+static int32_t _payload_round_ceilf(int64_t dividend, int64_t divisor)
+{
+    return dividend > 0 ? (dividend + divisor - 1) / divisor : dividend / divisor;
+}
+
+#define _PAYLOAD_FIELD(id, name, label, width, sign, num, den, round, precision) \
+    [PAYLOAD_FIELD_##id] = { width, PAYLOAD_OFFSET_##id, sign, (float) ((num) << PAYLOAD_FRACTION_BITS) / (den), \
+                             ((num) << PAYLOAD_FRACTION_BITS) / (den), _payload_round_##round },
+
+#define _PAYLOAD_FIELD_EXACT(id, name, label, width, sign, num, den, round, precision) \
+    _Static_assert(((num) << PAYLOAD_FRACTION_BITS) % (den) == 0, "fixed point of " #id " is not exact");
+
+SENSOR_TABLE(_PAYLOAD_FIELD_EXACT)
+
+// Wire format of every field expanded from SENSOR_TABLE
+static const struct
+{
+    uint8_t width;
+    uint8_t offset;
+    bool sign;
+    // Sample to fixed point of the wire unit
+    float scale;
+    int32_t scale_fixed;
+    int32_t (*round)(int64_t, int64_t);
+
+} _payload_field[PAYLOAD_FIELD_COUNT] = {
+    SENSOR_TABLE(_PAYLOAD_FIELD)
+};
+
+int32_t payload_field_quantize(payload_field_t field, float value)
+{
+    float fixed = value * _payload_field[field].scale;
+
+    return (int32_t) (fixed >= 0.f ? fixed + 0.5f : fixed - 0.5f);
+}
+
+int32_t payload_field_fixed(payload_field_t field, int32_t value)
+{
+    return value * _payload_field[field].scale_fixed;
+}
+
+static uint16_t _payload_field_missing(payload_field_t field)
+{
+    return _payload_field[field].width == 1 ? 0xff : 0xffff;
+}
+
+// Wire value of the window mean, all ones when the window has no samples
+static uint16_t _payload_field_raw(payload_field_t field, aggregate_t *aggregate)
+{
+    uint32_t count = aggregate_get_count(aggregate);
+
+    if (count == 0)
+    {
+        return _payload_field_missing(field);
+    }
+
+    // Mean of the fixed point samples in the wire unit
+    int32_t value = _payload_field[field].round(aggregate_get_sum(aggregate), (int64_t) count << PAYLOAD_FRACTION_BITS);
+
+    return (uint16_t) value & _payload_field_missing(field);
+}
+
+// Numeric value of a raw field for delta computation, sign extended for the signed fields
+static int32_t _payload_field_signed(payload_field_t field, uint16_t raw)
+{
+    if (!_payload_field[field].sign)
+    {
+        return raw;
+    }
+
+    return _payload_field[field].width == 1 ? (int8_t) raw : (int16_t) raw;
+}
+
+static size_t _payload_write_raw(payload_field_t field, uint16_t raw, uint8_t *buffer)
+{
+    if (_payload_field[field].width == 1)
+    {
+        buffer[0] = raw;
+
+        return 1;
+    }
+
+    buffer[0] = raw >> 8;
+    buffer[1] = raw;
+
+    return 2;
+}
+
+// Bytes of the presence bitmap, as many as its highest field needs
+static size_t _payload_bitmap_length(uint16_t bitmap)
+{
+    size_t length = 1;
+
+    while ((bitmap >>= PAYLOAD_BITMAP_FIELDS) != 0)
+    {
+        length++;
+    }
+
+    return length;
+}
+
+// The fields of the first byte keep their bits, so frames without the newer fields are unchanged
+static size_t _payload_write_bitmap(uint16_t bitmap, uint8_t *buffer)
+{
+    size_t length = _payload_bitmap_length(bitmap);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        buffer[i] = (bitmap >> (i * PAYLOAD_BITMAP_FIELDS)) & ~PAYLOAD_BITMAP_MORE;
+
+        if (i + 1 < length)
+        {
+            buffer[i] |= PAYLOAD_BITMAP_MORE;
+        }
+    }
+
+    return length;
+}
+
+size_t payload_encode(payload_format_t format, uint8_t header, aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT], uint8_t *buffer, size_t size)
+{
+    if (format == PAYLOAD_FORMAT_FIXED)
+    {
+        if (size < PAYLOAD_FIXED_LENGTH)
+        {
+            return 0;
+        }
+
+        memset(buffer, 0xff, PAYLOAD_FIXED_LENGTH);
+
+        buffer[0] = header;
+
+        for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+        {
+            _payload_write_raw(i, _payload_field_raw(i, aggregates[i]), buffer + _payload_field[i].offset);
+        }
+
+        return PAYLOAD_FIXED_LENGTH;
+    }
+
+    // Compact layout: header, presence bitmap and only the fields with a value
+    uint16_t bitmap = 0;
+    size_t length = 1;
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        if (aggregate_get_count(aggregates[i]) != 0)
+        {
+            bitmap |= 1 << i;
+            length += _payload_field[i].width;
+        }
+    }
+
+    length += _payload_bitmap_length(bitmap);
+
+    if (length > size)
+    {
+        return 0;
+    }
+
+    buffer[0] = header | PAYLOAD_HEADER_COMPACT;
+
+    length = 1 + _payload_write_bitmap(bitmap, buffer + 1);
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        if (bitmap & (1 << i))
+        {
+            length += _payload_write_raw(i, _payload_field_raw(i, aggregates[i]), buffer + length);
+        }
+    }
+
+    return length;
+}
+
+void payload_batch_reset(payload_batch_t *self)
+{
+    self->count = 0;
+}
+
+void payload_window_raw(aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT], uint16_t raw[PAYLOAD_FIELD_COUNT])
+{
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        raw[i] = _payload_field_raw(i, aggregates[i]);
+    }
+}
+
+bool payload_batch_add(payload_batch_t *self, aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT])
+{
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+    payload_window_raw(aggregates, raw);
+
+    return payload_batch_add_raw(self, raw);
+}
+
+bool payload_batch_add_raw(payload_batch_t *self, const uint16_t raw[PAYLOAD_FIELD_COUNT])
+{
+    if (self->count == PAYLOAD_BATCH_MAX)
+    {
+        return false;
+    }
+
+    memcpy(self->raw[self->count], raw, sizeof(self->raw[0]));
+
+    self->count++;
+
+    return true;
+}
+
+int payload_batch_get_count(payload_batch_t *self)
+{
+    return self->count;
+}
+
+// Delta of one field against the previous window, escaped to the full value when missing or out of range
+static size_t _payload_batch_write_delta(payload_field_t field, uint16_t previous, uint16_t current, uint8_t *buffer)
+{
+    uint16_t missing = _payload_field_missing(field);
+
+    if (previous != missing && current != missing)
+    {
+        int32_t delta = _payload_field_signed(field, current) - _payload_field_signed(field, previous);
+
+        if (delta >= -127 && delta <= 127)
+        {
+            buffer[0] = (int8_t) delta;
+
+            return 1;
+        }
+    }
+
+    buffer[0] = PAYLOAD_BATCH_ESCAPE;
+
+    return 1 + _payload_write_raw(field, current, buffer + 1);
+}
+
+// Record count, presence bitmap, the first window with absolute values and the following as deltas
+static size_t _payload_batch_encode_records(payload_batch_t *self, uint8_t *buffer, size_t size)
+{
+    uint16_t bitmap = 0;
+    size_t length = 1;
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        for (int j = 0; j < self->count; j++)
+        {
+            if (self->raw[j][i] != _payload_field_missing(i))
+            {
+                bitmap |= 1 << i;
+                length += _payload_field[i].width;
+
+                break;
+            }
+        }
+    }
+
+    length += _payload_bitmap_length(bitmap);
+
+    if (self->count == 0 || length > size)
+    {
+        return 0;
+    }
+
+    length = 1 + _payload_write_bitmap(bitmap, buffer + 1);
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        if (bitmap & (1 << i))
+        {
+            length += _payload_write_raw(i, self->raw[0][i], buffer + length);
+        }
+    }
+
+    // Following windows as deltas, a window is only taken if it fits completely
+    int count = 1;
+    uint8_t record[PAYLOAD_FIELD_COUNT * 3];
+
+    for (; count < self->count; count++)
+    {
+        size_t record_length = 0;
+
+        for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+        {
+            if (bitmap & (1 << i))
+            {
+                record_length += _payload_batch_write_delta(i, self->raw[count - 1][i], self->raw[count][i], record + record_length);
+            }
+        }
+
+        if (length + record_length > size)
+        {
+            break;
+        }
+
+        memcpy(buffer + length, record, record_length);
+
+        length += record_length;
+    }
+
+    buffer[0] = count;
+
+    self->count -= count;
+
+    memmove(self->raw[0], self->raw[count], self->count * sizeof(self->raw[0]));
+
+    return length;
+}
+
+size_t payload_batch_encode(payload_batch_t *self, uint8_t header, uint8_t *buffer, size_t size)
+{
+    if (size < 1)
+    {
+        return 0;
+    }
+
+    size_t length = _payload_batch_encode_records(self, buffer + 1, size - 1);
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = header | PAYLOAD_HEADER_COMPACT | PAYLOAD_HEADER_BATCH;
+
+    return 1 + length;
+}
+
+size_t payload_backfill_encode(payload_batch_t *self, uint8_t header, uint16_t sequence, uint16_t age, uint8_t *buffer, size_t size)
+{
+    if (size < 1 + PAYLOAD_BACKFILL_PREFIX_LENGTH)
+    {
+        return 0;
+    }
+
+    size_t length = _payload_batch_encode_records(self, buffer + 1 + PAYLOAD_BACKFILL_PREFIX_LENGTH, size - 1 - PAYLOAD_BACKFILL_PREFIX_LENGTH);
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = header | PAYLOAD_HEADER_COMPACT | PAYLOAD_HEADER_BATCH;
+    buffer[1] = sequence >> 8;
+    buffer[2] = sequence;
+    buffer[3] = age >> 8;
+    buffer[4] = age;
+
+    return 1 + PAYLOAD_BACKFILL_PREFIX_LENGTH + length;
+}
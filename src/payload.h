@@ -0,0 +1,115 @@
+#ifndef _PAYLOAD_H
+#define _PAYLOAD_H
+
+#include <twr.h>
+#include <aggregate.h>
+#include <sensor.h>
+
+// Fixed layout, every field is always present and missing values are 0xff
+#define PAYLOAD_FIXED_LENGTH 16
+
+// Header flag of the compact layout, a presence bitmap follows the header
+#define PAYLOAD_HEADER_COMPACT 0x80
+
+// Presence bitmap of the compact and batch layouts, 7 fields per byte, bit 7 announces another byte
+#define PAYLOAD_BITMAP_FIELDS 7
+#define PAYLOAD_BITMAP_MORE 0x80
+
+// Header flag of the batch layout, set together with PAYLOAD_HEADER_COMPACT
+#define PAYLOAD_HEADER_BATCH 0x40
+
+// Window statistics are kept in fixed point with this many fraction bits of the wire unit
+#define PAYLOAD_FRACTION_BITS 10
+
+// Largest application payload accepted at every data rate (EU868 DR0)
+#define PAYLOAD_MAX_LENGTH 51
+
+// Most windows kept for a single batch frame
+#define PAYLOAD_BATCH_MAX 8
+
+// Delta byte announcing that the full-width value follows
+#define PAYLOAD_BATCH_ESCAPE 0x80
+
+// Sequence number and age that precede the batch of a backfill frame
+#define PAYLOAD_BACKFILL_PREFIX_LENGTH 4
+
+typedef enum
+{
+    PAYLOAD_FORMAT_FIXED = 0,
+    PAYLOAD_FORMAT_COMPACT = 1,
+    PAYLOAD_FORMAT_BATCH = 2,
+
+    PAYLOAD_FORMAT_COUNT
+
+} payload_format_t;
+
+#define _PAYLOAD_FIELD_ID(id, name, label, width, sign, num, den, round, precision) PAYLOAD_FIELD_##id,
+
+// Order of the fields in the frame and bit position in the presence bitmap, see SENSOR_TABLE
+typedef enum
+{
+    SENSOR_TABLE(_PAYLOAD_FIELD_ID)
+
+    PAYLOAD_FIELD_COUNT
+
+} payload_field_t;
+
+// Byte offset of every field in the fixed layout, each one follows the previous field
+#define _PAYLOAD_FIELD_OFFSET(id, name, label, width, sign, num, den, round, precision) \
+    PAYLOAD_OFFSET_##id, _PAYLOAD_OFFSET_LAST_##id = PAYLOAD_OFFSET_##id + (width) - 1,
+
+enum
+{
+    _PAYLOAD_OFFSET_HEADER = 0,
+
+    SENSOR_TABLE(_PAYLOAD_FIELD_OFFSET)
+
+    PAYLOAD_FIXED_USED_LENGTH
+};
+
+_Static_assert(PAYLOAD_FIXED_USED_LENGTH <= PAYLOAD_FIXED_LENGTH, "fields do not fit the fixed layout");
+
+// Compact frame with every field present, the header and fields of the fixed layout and the full presence bitmap
+#define PAYLOAD_COMPACT_MAX_LENGTH (PAYLOAD_FIXED_USED_LENGTH + (PAYLOAD_FIELD_COUNT + PAYLOAD_BITMAP_FIELDS - 1) / PAYLOAD_BITMAP_FIELDS)
+
+_Static_assert(PAYLOAD_COMPACT_MAX_LENGTH <= PAYLOAD_MAX_LENGTH, "fields do not fit the compact layout");
+
+_Static_assert(PAYLOAD_FIELD_COUNT <= 16, "fields do not fit the presence bitmap");
+
+// Consecutive window results waiting for a batch frame, raw wire values with all ones when missing
+typedef struct
+{
+    uint8_t count;
+    uint16_t raw[PAYLOAD_BATCH_MAX][PAYLOAD_FIELD_COUNT];
+
+} payload_batch_t;
+
+// Sample in fixed point of the wire unit of the field, the only float operation from a handler to the frame
+int32_t payload_field_quantize(payload_field_t field, float value);
+
+// Integer sample in the unit of SENSOR_TABLE in the same fixed point, without float
+int32_t payload_field_fixed(payload_field_t field, int32_t value);
+
+// Encode the header and the window statistics of every field into buffer, returns frame length or 0 if it does not fit
+size_t payload_encode(payload_format_t format, uint8_t header, aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT], uint8_t *buffer, size_t size);
+
+// Wire values of the window statistics, all ones when a field has no samples
+void payload_window_raw(aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT], uint16_t raw[PAYLOAD_FIELD_COUNT]);
+
+void payload_batch_reset(payload_batch_t *self);
+
+// Append one window, returns false if the batch is already full
+bool payload_batch_add(payload_batch_t *self, aggregate_t *const aggregates[PAYLOAD_FIELD_COUNT]);
+
+// Append one window of wire values, returns false if the batch is already full
+bool payload_batch_add_raw(payload_batch_t *self, const uint16_t raw[PAYLOAD_FIELD_COUNT]);
+
+int payload_batch_get_count(payload_batch_t *self);
+
+// Encode the oldest windows that fit into buffer and drop them from the batch, returns frame length
+size_t payload_batch_encode(payload_batch_t *self, uint8_t header, uint8_t *buffer, size_t size);
+
+// Batch frame of stored windows with the sequence number of the first one and the number of windows closed since it
+size_t payload_backfill_encode(payload_batch_t *self, uint8_t header, uint16_t sequence, uint16_t age, uint8_t *buffer, size_t size);
+
+#endif // _PAYLOAD_H
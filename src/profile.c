@@ -0,0 +1,109 @@
+#include <profile.h>
+
+static const char *_profile_names[PROFILE_SECTION_COUNT] = {
+    [PROFILE_SECTION_APPLICATION] = "Application",
+    [PROFILE_SECTION_COORDINATOR] = "Coordinator",
+    [PROFILE_SECTION_CALIBRATION] = "Calibration",
+    [PROFILE_SECTION_ALARM] = "Alarm",
+    [PROFILE_SECTION_BACKFILL] = "Backfill",
+    [PROFILE_SECTION_SEND_RETRY] = "Send retry",
+    [PROFILE_SECTION_DISCOVERY] = "Discovery",
+    [PROFILE_SECTION_STREAM] = "Stream",
+    [PROFILE_SECTION_BUTTON] = "Button",
+    [PROFILE_SECTION_CO2] = "CO2",
+    [PROFILE_SECTION_VOC] = "VOC",
+    [PROFILE_SECTION_HUMIDITY] = "Humidity",
+    [PROFILE_SECTION_BAROMETER] = "Barometer",
+    [PROFILE_SECTION_BATTERY] = "Battery",
+    [PROFILE_SECTION_LORA] = "LoRa",
+    [PROFILE_SECTION_AT] = "AT",
+};
+
+static struct
+{
+    profile_stats_t stats[PROFILE_SECTION_COUNT];
+    twr_tick_t begin[PROFILE_SECTION_COUNT];
+
+} _profile;
+
+void profile_init(void)
+{
+    memset(&_profile, 0, sizeof(_profile));
+}
+
+static int _profile_bucket(twr_tick_t duration)
+{
+    int bucket = 0;
+
+    while (duration > 0 && bucket < PROFILE_BUCKETS - 1)
+    {
+        duration >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static void _profile_count(uint16_t *histogram, uint16_t *max, twr_tick_t duration)
+{
+    int bucket = _profile_bucket(duration);
+
+    if (histogram[bucket] < UINT16_MAX)
+    {
+        histogram[bucket]++;
+    }
+
+    if (duration > *max)
+    {
+        *max = duration < UINT16_MAX ? duration : UINT16_MAX;
+    }
+}
+
+profile_section_t profile_begin(profile_section_t section)
+{
+    profile_stats_t *stats = &_profile.stats[section];
+    twr_tick_t now = twr_tick_get();
+    twr_tick_t spin = twr_scheduler_get_spin_tick();
+
+    _profile.begin[section] = now;
+
+    _profile_count(stats->latency, &stats->latency_max, now > spin ? now - spin : 0);
+
+    return section;
+}
+
+void profile_end(profile_section_t section)
+{
+    profile_stats_t *stats = &_profile.stats[section];
+    twr_tick_t run = twr_tick_get() - _profile.begin[section];
+
+    stats->count++;
+    stats->run_total += run;
+
+    _profile_count(stats->run, &stats->run_max, run);
+}
+
+void profile_scope_end(profile_section_t *section)
+{
+    profile_end(*section);
+}
+
+const char *profile_get_name(profile_section_t section)
+{
+    return _profile_names[section];
+}
+
+const profile_stats_t *profile_get_stats(profile_section_t section)
+{
+    return &_profile.stats[section];
+}
+
+uint16_t profile_get_bucket_min(int bucket)
+{
+    return bucket == 0 ? 0 : 1 << (bucket - 1);
+}
+
+void profile_clear(void)
+{
+    memset(_profile.stats, 0, sizeof(_profile.stats));
+}
@@ -0,0 +1,75 @@
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <twr.h>
+
+// Run time and start latency of the tasks and handlers of the application
+//
+// A section is measured from profile_begin() to profile_end(), PROFILE_SCOPE() at the top of a
+// function ends it on every return. The start latency is the time from the start of the
+// scheduler pass that dispatched the section (twr_scheduler_get_spin_tick) to its begin, the
+// time it waited behind the tasks before it. The SDK keeps the planned tick of a task to itself,
+// a task runs in the first pass after it, so the latency is how late it starts unless a pass
+// overran the planned tick. Both are counted in tick resolution into histograms of powers of two.
+
+typedef enum
+{
+    PROFILE_SECTION_APPLICATION = 0,
+    PROFILE_SECTION_COORDINATOR = 1,
+    PROFILE_SECTION_CALIBRATION = 2,
+    PROFILE_SECTION_ALARM = 3,
+    PROFILE_SECTION_BACKFILL = 4,
+    PROFILE_SECTION_SEND_RETRY = 5,
+    PROFILE_SECTION_DISCOVERY = 6,
+    PROFILE_SECTION_STREAM = 7,
+    PROFILE_SECTION_BUTTON = 8,
+    PROFILE_SECTION_CO2 = 9,
+    PROFILE_SECTION_VOC = 10,
+    PROFILE_SECTION_HUMIDITY = 11,
+    PROFILE_SECTION_BAROMETER = 12,
+    PROFILE_SECTION_BATTERY = 13,
+    PROFILE_SECTION_LORA = 14,
+    PROFILE_SECTION_AT = 15,
+    PROFILE_SECTION_COUNT
+
+} profile_section_t;
+
+// Histogram buckets in ms: 0, 1, 2-3, 4-7, ... and the last one from 2^(PROFILE_BUCKETS - 2) up
+#define PROFILE_BUCKETS 8
+
+typedef struct
+{
+    uint32_t count;
+    // Run time in ms
+    uint32_t run_total;
+    uint16_t run_max;
+    uint16_t latency_max;
+    // Counts saturate at UINT16_MAX
+    uint16_t run[PROFILE_BUCKETS];
+    uint16_t latency[PROFILE_BUCKETS];
+
+} profile_stats_t;
+
+// Measure the rest of the enclosing function as section, needs the cleanup attribute of GCC or Clang
+#define PROFILE_SCOPE(section) \
+    profile_section_t _profile_scope __attribute__((cleanup(profile_scope_end), unused)) = profile_begin(section)
+
+void profile_init(void);
+
+// Returns section for PROFILE_SCOPE()
+profile_section_t profile_begin(profile_section_t section);
+
+void profile_end(profile_section_t section);
+
+void profile_scope_end(profile_section_t *section);
+
+const char *profile_get_name(profile_section_t section);
+
+const profile_stats_t *profile_get_stats(profile_section_t section);
+
+// Lower bound of a histogram bucket in ms
+uint16_t profile_get_bucket_min(int bucket);
+
+void profile_clear(void);
+
+#endif // _PROFILE_H
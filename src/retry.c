@@ -0,0 +1,119 @@
+#include <retry.h>
+
+void retry_init(retry_t *self, const retry_config_t *config)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_config = config;
+}
+
+void retry_seed(retry_t *self, uint32_t seed)
+{
+    self->_seed = seed;
+}
+
+// xorshift32, enough for spreading the delays
+static uint32_t _retry_random(retry_t *self)
+{
+    // Seeded by the unit and the tick of the first failure, units that booted together and failed
+    // at the same tick still draw different delays
+    if (self->_random == 0)
+    {
+        self->_random = (self->_seed ^ (uint32_t) twr_tick_get()) | 1;
+    }
+
+    self->_random ^= self->_random << 13;
+    self->_random ^= self->_random >> 17;
+    self->_random ^= self->_random << 5;
+
+    return self->_random;
+}
+
+void retry_start(retry_t *self)
+{
+    self->_attempt = 1;
+    self->_attempts++;
+}
+
+twr_tick_t retry_fail(retry_t *self)
+{
+    const retry_config_t *config = self->_config;
+
+    self->_failures++;
+
+    if (self->_attempt >= config->attempts)
+    {
+        self->_attempt = 0;
+        self->_dropped++;
+
+        return TWR_TICK_INFINITY;
+    }
+
+    twr_tick_t delay = config->delay_min;
+
+    for (int i = 1; i < self->_attempt && delay < config->delay_max; i++)
+    {
+        delay *= 2;
+    }
+
+    if (delay > config->delay_max)
+    {
+        delay = config->delay_max;
+    }
+
+    if (config->jitter > 0)
+    {
+        // Uniform in delay * (100 - jitter .. 100 + jitter) / 100
+        int percent = 100 - config->jitter + (int) (_retry_random(self) % (2 * config->jitter + 1));
+
+        delay = delay * percent / 100;
+    }
+
+    return delay;
+}
+
+void retry_attempt(retry_t *self)
+{
+    self->_attempt++;
+    self->_attempts++;
+    self->_retries++;
+}
+
+void retry_done(retry_t *self)
+{
+    self->_attempt = 0;
+}
+
+bool retry_is_active(retry_t *self)
+{
+    return self->_attempt > 0;
+}
+
+void retry_drop(retry_t *self)
+{
+    if (self->_attempt > 0)
+    {
+        self->_attempt = 0;
+        self->_dropped++;
+    }
+}
+
+uint32_t retry_get_attempts(retry_t *self)
+{
+    return self->_attempts;
+}
+
+uint32_t retry_get_failures(retry_t *self)
+{
+    return self->_failures;
+}
+
+uint32_t retry_get_retries(retry_t *self)
+{
+    return self->_retries;
+}
+
+uint32_t retry_get_dropped(retry_t *self)
+{
+    return self->_dropped;
+}
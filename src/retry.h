@@ -0,0 +1,69 @@
+#ifndef _RETRY_H
+#define _RETRY_H
+
+#include <twr.h>
+
+// Bounded retries with exponential backoff
+//
+// The delay before the n-th retry is delay_min * 2^(n-1) up to delay_max, moved randomly by up
+// to jitter percent so units that failed together do not retry together. The frame is given up
+// when it failed attempts times.
+
+typedef struct
+{
+    // Attempts of one frame including the first one
+    int attempts;
+    twr_tick_t delay_min;
+    twr_tick_t delay_max;
+    // Random part of a delay in percent
+    int jitter;
+
+} retry_config_t;
+
+typedef struct
+{
+    const retry_config_t *_config;
+    int _attempt;
+    uint32_t _seed;
+    uint32_t _random;
+    uint32_t _attempts;
+    uint32_t _failures;
+    uint32_t _retries;
+    uint32_t _dropped;
+
+} retry_t;
+
+void retry_init(retry_t *self, const retry_config_t *config);
+
+// Value unique to the unit, e.g. a hash of its DevEUI, mixed with the tick of the first failure
+// into the random part of the delays
+void retry_seed(retry_t *self, uint32_t seed);
+
+// First attempt of a new frame
+void retry_start(retry_t *self);
+
+// The attempt failed, returns the delay before the next one or TWR_TICK_INFINITY when the frame is given up
+twr_tick_t retry_fail(retry_t *self);
+
+// Next attempt of the failed frame
+void retry_attempt(retry_t *self);
+
+// The attempt succeeded or failed for good in a way a retry does not help
+void retry_done(retry_t *self);
+
+// A frame is sent or waits for its next attempt
+bool retry_is_active(retry_t *self);
+
+// The active frame is given up, e.g. replaced by a newer one
+void retry_drop(retry_t *self);
+
+// Attempts including retries, failed attempts, retries and frames given up since boot
+uint32_t retry_get_attempts(retry_t *self);
+
+uint32_t retry_get_failures(retry_t *self);
+
+uint32_t retry_get_retries(retry_t *self);
+
+uint32_t retry_get_dropped(retry_t *self);
+
+#endif // _RETRY_H
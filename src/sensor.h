@@ -0,0 +1,31 @@
+#ifndef _SENSOR_H
+#define _SENSOR_H
+
+// Quantities reported by the application, in the order of the uplink fields and of the presence
+// bitmap. Payload encoder, AT$STATUS and the host decoder are all expanded from this table, so
+// a quantity is added here once, at the end so the offsets of the older ones stay. Plain macros
+// only, the decoder includes it without the SDK.
+//
+// X(id, name, label, width, sign, num, den, round, precision)
+//
+//   id         suffix of PAYLOAD_FIELD_* and DECODER_FIELD_*
+//   name       window statistics sm_<name> in application.c and key in the decoded output
+//   label      name printed by AT$STATUS
+//   width      bytes on the wire, all ones marks a missing value
+//   sign       wire value is two's complement
+//   num, den   wire value = physical value * num / den
+//   round      truncf() or ceilf() applied to the scaled value before it is sent
+//   precision  decimals printed by AT$STATUS
+
+#define SENSOR_TABLE(X) \
+    X(VOLTAGE,      voltage,      "Voltage",      1, 0, 10, 1, ceilf,  1) \
+    X(TEMPERATURE,  temperature,  "Temperature",  2, 1, 10, 1, truncf, 1) \
+    X(HUMIDITY,     humidity,     "Humidity",     1, 0,  2, 1, truncf, 1) \
+    X(VOC,          voc,          "VOC",          2, 0,  1, 1, truncf, 1) \
+    X(PRESSURE,     pressure,     "Pressure",     2, 0,  1, 2, truncf, 0) \
+    X(CO2,          co2,          "CO2",          2, 0,  1, 1, truncf, 0) \
+    X(VOLTAGE_IDLE, voltage_idle, "Voltage idle", 1, 0, 10, 1, ceilf,  1) \
+    X(TEMPERATURE_2, temperature_2, "Temperature 2", 2, 1, 10, 1, truncf, 1) \
+    X(HUMIDITY_2,   humidity_2,   "Humidity 2",   1, 0,  2, 1, truncf, 1)
+
+#endif // _SENSOR_H
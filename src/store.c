@@ -0,0 +1,270 @@
+#include <store.h>
+#include <trace.h>
+
+#define _STORE_FLAG_PENDING 0xa5
+#define _STORE_FLAG_ACKNOWLEDGED 0x00
+
+typedef struct
+{
+    uint16_t sequence;
+    uint8_t flag;
+    uint8_t crc;
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+} _store_record_t;
+
+typedef struct
+{
+    uint32_t signature;
+    uint16_t record_size;
+    uint16_t slots;
+
+} _store_header_t;
+
+#define _STORE_SLOTS STORE_LENGTH
+
+// Data EEPROM of the STM32L083 on the Core Module
+#define _STORE_EEPROM_SIZE 6144
+
+_Static_assert((_STORE_SLOTS & (_STORE_SLOTS - 1)) == 0, "store length is not a power of two");
+
+// A longer record, e.g. a field added to SENSOR_TABLE, must not move the ring over the config
+_Static_assert(STORE_CONFIG_SPACE + sizeof(_store_header_t) + _STORE_SLOTS * sizeof(_store_record_t) <= _STORE_EEPROM_SIZE,
+               "store ring overlaps the config, shorten STORE_LENGTH");
+
+static struct
+{
+    uint32_t address;
+    uint16_t sequence;
+    uint8_t pending[_STORE_SLOTS / 8];
+    uint8_t queued[_STORE_SLOTS / 8];
+
+} _store;
+
+static uint8_t _store_crc(const _store_record_t *record)
+{
+    // CRC-8 of the sequence number and the values, the flag changes on acknowledge
+    uint8_t data[sizeof(record->sequence) + sizeof(record->raw)];
+    uint8_t crc = 0xff;
+
+    memcpy(data, &record->sequence, sizeof(record->sequence));
+    memcpy(data + sizeof(record->sequence), record->raw, sizeof(record->raw));
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        crc ^= data[i];
+
+        for (int j = 0; j < 8; j++)
+        {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t _store_address(uint16_t sequence)
+{
+    return _store.address + (sequence % _STORE_SLOTS) * sizeof(_store_record_t);
+}
+
+static bool _store_bit_get(const uint8_t *bitmap, uint16_t sequence)
+{
+    size_t slot = sequence % _STORE_SLOTS;
+
+    return bitmap[slot / 8] & (1 << (slot % 8));
+}
+
+static void _store_bit_set(uint8_t *bitmap, uint16_t sequence, bool value)
+{
+    size_t slot = sequence % _STORE_SLOTS;
+
+    if (value)
+    {
+        bitmap[slot / 8] |= 1 << (slot % 8);
+    }
+    else
+    {
+        bitmap[slot / 8] &= ~(1 << (slot % 8));
+    }
+}
+
+// Ring of another layout, every slot is zeroed so none of them passes the CRC as a record
+static void _store_erase(const _store_header_t *header)
+{
+    static const _store_record_t erased;
+
+    for (size_t slot = 0; slot < _STORE_SLOTS; slot++)
+    {
+        _store_record_t record;
+        uint32_t address = _store.address + slot * sizeof(record);
+
+        if (!twr_eeprom_read(address, &record, sizeof(record)) || memcmp(&record, &erased, sizeof(record)) != 0)
+        {
+            twr_eeprom_write(address, &erased, sizeof(erased));
+        }
+    }
+
+    twr_eeprom_write(_store.address - sizeof(*header), header, sizeof(*header));
+}
+
+void store_init(void)
+{
+    memset(&_store, 0, sizeof(_store));
+
+    _store.address = twr_eeprom_get_size() - _STORE_SLOTS * sizeof(_store_record_t);
+
+    const _store_header_t header = {
+        .signature = STORE_SIGNATURE,
+        .record_size = sizeof(_store_record_t),
+        .slots = _STORE_SLOTS
+    };
+    _store_header_t stored;
+
+    if (!twr_eeprom_read(_store.address - sizeof(stored), &stored, sizeof(stored)) || memcmp(&stored, &header, sizeof(header)) != 0)
+    {
+        _store_erase(&header);
+    }
+
+    bool found = false;
+    uint16_t newest = 0;
+
+    for (size_t slot = 0; slot < _STORE_SLOTS; slot++)
+    {
+        _store_record_t record;
+
+        if (!twr_eeprom_read(_store.address + slot * sizeof(record), &record, sizeof(record)))
+        {
+            continue;
+        }
+
+        if (record.crc != _store_crc(&record) || record.sequence % _STORE_SLOTS != slot)
+        {
+            continue;
+        }
+
+        if (!found || (int16_t) (record.sequence - newest) > 0)
+        {
+            newest = record.sequence;
+            found = true;
+        }
+
+        _store_bit_set(_store.pending, record.sequence, record.flag == _STORE_FLAG_PENDING);
+    }
+
+    _store.sequence = found ? newest + 1 : 0;
+
+    TRACE_INFO(TRACE_EVENT_STORE, store_get_pending_count() > UINT8_MAX ? UINT8_MAX : store_get_pending_count(), _store.sequence);
+}
+
+uint16_t store_append(const uint16_t raw[PAYLOAD_FIELD_COUNT])
+{
+    _store_record_t record = {
+        .sequence = _store.sequence,
+        .flag = _STORE_FLAG_PENDING
+    };
+
+    memcpy(record.raw, raw, sizeof(record.raw));
+
+    record.crc = _store_crc(&record);
+
+    twr_eeprom_write(_store_address(record.sequence), &record, sizeof(record));
+
+    _store_bit_set(_store.pending, record.sequence, true);
+    _store_bit_set(_store.queued, record.sequence, false);
+
+    return _store.sequence++;
+}
+
+uint16_t store_get_sequence(void)
+{
+    return _store.sequence;
+}
+
+int store_get_pending_count(void)
+{
+    int count = 0;
+
+    for (size_t i = 0; i < sizeof(_store.pending); i++)
+    {
+        count += __builtin_popcount(_store.pending[i]);
+    }
+
+    return count;
+}
+
+int store_get_pending(uint16_t *sequence, uint16_t raw[][PAYLOAD_FIELD_COUNT], int max, uint16_t before)
+{
+    int count = 0;
+
+    for (uint16_t s = _store.sequence - _STORE_SLOTS; s != before && count < max; s++)
+    {
+        if (!_store_bit_get(_store.pending, s) || _store_bit_get(_store.queued, s))
+        {
+            if (count > 0)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        _store_record_t record;
+
+        if (!twr_eeprom_read(_store_address(s), &record, sizeof(record)) || record.crc != _store_crc(&record) || record.sequence != s)
+        {
+            _store_bit_set(_store.pending, s, false);
+
+            if (count > 0)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        if (count == 0)
+        {
+            *sequence = s;
+        }
+
+        memcpy(raw[count++], record.raw, sizeof(record.raw));
+    }
+
+    return count;
+}
+
+void store_queue(uint16_t sequence, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        _store_bit_set(_store.queued, sequence + i, true);
+    }
+}
+
+void store_confirm(void)
+{
+    static const uint8_t flag = _STORE_FLAG_ACKNOWLEDGED;
+
+    for (size_t slot = 0; slot < _STORE_SLOTS; slot++)
+    {
+        if (!(_store.queued[slot / 8] & (1 << (slot % 8))))
+        {
+            continue;
+        }
+
+        if (_store.pending[slot / 8] & (1 << (slot % 8)))
+        {
+            twr_eeprom_write(_store.address + slot * sizeof(_store_record_t) + offsetof(_store_record_t, flag), &flag, sizeof(flag));
+        }
+
+        _store.pending[slot / 8] &= ~(1 << (slot % 8));
+    }
+
+    memset(_store.queued, 0, sizeof(_store.queued));
+}
+
+void store_release(void)
+{
+    memset(_store.queued, 0, sizeof(_store.queued));
+}
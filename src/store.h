@@ -0,0 +1,52 @@
+#ifndef _STORE_H
+#define _STORE_H
+
+#include <twr.h>
+#include <payload.h>
+
+// Store-and-forward log of window results in EEPROM
+//
+// Every closed window is written with a sequence number into a ring at the end of the EEPROM,
+// the slot follows from the sequence number so the writes rotate over the whole ring and no
+// index has to be kept. A record stays pending until an uplink carrying it is confirmed, the
+// acknowledge only clears its flag byte. The ring is scanned at boot to recover the sequence
+// number and the pending records, the oldest record is overwritten when the ring is full.
+// A header in front of the ring identifies the record layout, a ring written by a firmware
+// with another layout is erased at boot instead of being read as records.
+
+// Identifies the layout of a record, change it when the layout changes, the record size and the
+// ring length are checked as well
+#define STORE_SIGNATURE 0x53544f01UL
+
+// Records in the ring at the end of the EEPROM, a power of two so the slot of a sequence number
+// stays the same when the sequence wraps
+#define STORE_LENGTH 256
+
+// Bytes at the start of the EEPROM left to twr_config, its header and config_t, the header and the
+// ring of the store must end before them
+#define STORE_CONFIG_SPACE 256
+
+void store_init(void);
+
+// Write a closed window as pending, returns its sequence number
+uint16_t store_append(const uint16_t raw[PAYLOAD_FIELD_COUNT]);
+
+// Sequence number of the next window
+uint16_t store_get_sequence(void);
+
+int store_get_pending_count(void);
+
+// Oldest run of consecutive pending records older than sequence before and not queued,
+// returns their count and the sequence number of the first one
+int store_get_pending(uint16_t *sequence, uint16_t raw[][PAYLOAD_FIELD_COUNT], int max, uint16_t before);
+
+// Mark records as carried by an uplink waiting for confirmation
+void store_queue(uint16_t sequence, int count);
+
+// An uplink was confirmed or an unconfirmed one was sent, acknowledge every queued record
+void store_confirm(void);
+
+// Confirmation failed or the uplink was not confirmed, queued records are pending again
+void store_release(void);
+
+#endif // _STORE_H
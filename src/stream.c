@@ -0,0 +1,223 @@
+#include <stream.h>
+#include <profile.h>
+
+// Delay before the task tries again to put the rest of a line into a full UART FIFO
+#define _STREAM_RETRY_DELAY 20
+
+// Retries that took nothing before the stream stops, the FIFO drains in about 11 ms
+#define _STREAM_STALLS_MAX 5
+
+// Transmit FIFO of the console and the receive FIFO that replaces the one of twr_atci
+#define _STREAM_FIFO_SIZE 128
+
+static struct
+{
+    bool enabled;
+    bool console;
+    twr_fifo_t write_fifo;
+    twr_fifo_t read_fifo;
+    uint8_t write_fifo_buffer[_STREAM_FIFO_SIZE];
+    uint8_t read_fifo_buffer[_STREAM_FIFO_SIZE];
+    uint8_t ring[STREAM_LENGTH][STREAM_RECORD_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    char line[STREAM_LINE_SIZE];
+    size_t line_offset;
+    size_t line_length;
+    uint32_t count;
+    uint32_t dropped;
+    int stalls;
+    twr_scheduler_task_id_t task_id;
+
+} _stream;
+
+static void _stream_task(void *param);
+
+size_t __real_twr_uart_write(twr_uart_channel_t channel, const void *buffer, size_t length);
+
+void stream_init(void)
+{
+    memset(&_stream, 0, sizeof(_stream));
+
+    // The UART driver keeps one pair of FIFOs per channel and twr_atci registers only the receive
+    // one, the pair set here replaces it. twr_atci reads through twr_uart_async_read and goes on working.
+    twr_fifo_init(&_stream.write_fifo, _stream.write_fifo_buffer, sizeof(_stream.write_fifo_buffer));
+    twr_fifo_init(&_stream.read_fifo, _stream.read_fifo_buffer, sizeof(_stream.read_fifo_buffer));
+    twr_uart_set_async_fifo(TWR_UART_UART2, &_stream.write_fifo, &_stream.read_fifo);
+
+    _stream.console = true;
+
+    _stream.task_id = twr_scheduler_register(_stream_task, NULL, TWR_TICK_INFINITY);
+}
+
+void stream_set_enabled(bool enabled)
+{
+    _stream.enabled = enabled;
+    _stream.stalls = 0;
+}
+
+bool stream_is_enabled(void)
+{
+    return _stream.enabled;
+}
+
+// CRC-8, polynomial 0x07, initial value 0
+static uint8_t _stream_crc(const uint8_t *buffer, size_t length)
+{
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= buffer[i];
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = crc & 0x80 ? (uint8_t) (crc << 1) ^ 0x07 : (uint8_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+void stream_sample(uint8_t field, float value)
+{
+    if (!_stream.enabled)
+    {
+        return;
+    }
+
+    if (_stream.head - _stream.tail == STREAM_LENGTH)
+    {
+        _stream.dropped++;
+
+        return;
+    }
+
+    uint8_t *record = _stream.ring[_stream.head % STREAM_LENGTH];
+    uint32_t tick = (uint32_t) twr_tick_get();
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    record[0] = tick >> 24;
+    record[1] = tick >> 16;
+    record[2] = tick >> 8;
+    record[3] = tick;
+    record[4] = field;
+    record[5] = bits >> 24;
+    record[6] = bits >> 16;
+    record[7] = bits >> 8;
+    record[8] = bits;
+    record[9] = _stream_crc(record, STREAM_RECORD_SIZE - 1);
+
+    _stream.head++;
+    _stream.count++;
+
+    twr_scheduler_plan_now(_stream.task_id);
+}
+
+static void _stream_line(const uint8_t *record)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    _stream.line[0] = '#';
+
+    for (int i = 0; i < STREAM_RECORD_SIZE; i++)
+    {
+        _stream.line[1 + 2 * i] = hex[record[i] >> 4];
+        _stream.line[2 + 2 * i] = hex[record[i] & 0x0f];
+    }
+
+    _stream.line[STREAM_LINE_SIZE - 2] = '\r';
+    _stream.line[STREAM_LINE_SIZE - 1] = '\n';
+
+    _stream.line_offset = 0;
+    _stream.line_length = STREAM_LINE_SIZE;
+}
+
+// Moves as much as the FIFO takes and comes back later for the rest
+static void _stream_task(void *param)
+{
+    PROFILE_SCOPE(PROFILE_SECTION_STREAM);
+
+    (void) param;
+
+    while (true)
+    {
+        if (_stream.line_offset == _stream.line_length)
+        {
+            if (_stream.tail == _stream.head)
+            {
+                return;
+            }
+
+            _stream_line(_stream.ring[_stream.tail % STREAM_LENGTH]);
+
+            _stream.tail++;
+        }
+
+        size_t written = twr_uart_async_write(TWR_UART_UART2, _stream.line + _stream.line_offset, _stream.line_length - _stream.line_offset);
+
+        _stream.line_offset += written;
+        _stream.stalls = written > 0 ? 0 : _stream.stalls + 1;
+
+        // Without a transmit FIFO nothing drains, stop instead of waking up every retry for good
+        // and leave the console to the blocking write
+        if (_stream.stalls == _STREAM_STALLS_MAX)
+        {
+            _stream.enabled = false;
+            _stream.console = false;
+            // The queued records and the one of the unfinished line
+            _stream.dropped += _stream.head - _stream.tail + 1;
+            _stream.tail = _stream.head;
+            _stream.line_offset = _stream.line_length;
+
+            return;
+        }
+
+        if (_stream.line_offset < _stream.line_length)
+        {
+            twr_scheduler_plan_current_from_now(_STREAM_RETRY_DELAY);
+
+            return;
+        }
+    }
+}
+
+// Waits until the FIFO took the whole buffer, it drains by interrupt meanwhile
+static void _stream_console_write(const void *buffer, size_t length)
+{
+    size_t offset = 0;
+
+    while (offset < length)
+    {
+        offset += twr_uart_async_write(TWR_UART_UART2, (const uint8_t *) buffer + offset, length - offset);
+    }
+}
+
+size_t __wrap_twr_uart_write(twr_uart_channel_t channel, const void *buffer, size_t length)
+{
+    if (channel != TWR_UART_UART2 || !_stream.console)
+    {
+        return __real_twr_uart_write(channel, buffer, length);
+    }
+
+    // The rest of the streamed line goes first so the console line does not split it
+    _stream_console_write(_stream.line + _stream.line_offset, _stream.line_length - _stream.line_offset);
+
+    _stream.line_offset = _stream.line_length;
+
+    _stream_console_write(buffer, length);
+
+    return length;
+}
+
+uint32_t stream_get_count(void)
+{
+    return _stream.count;
+}
+
+uint32_t stream_get_dropped(void)
+{
+    return _stream.dropped;
+}
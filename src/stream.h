@@ -0,0 +1,47 @@
+#ifndef _STREAM_H
+#define _STREAM_H
+
+#include <twr.h>
+
+// Raw samples on the console for characterisation
+//
+// When enabled, every sample a handler gets from a sensor is queued as a 10 B record, the low
+// 32 bits of the tick, the field (PAYLOAD_FIELD_*), the value as an IEEE 754 float and a CRC-8,
+// all big endian. A task writes the records as lines "#" followed by the record in hex through
+// the asynchronous UART FIFO, so a handler never waits for the UART. A sample that does not fit
+// in the queue is dropped and counted, a failed measurement is sent as NaN. The simulator
+// replays recorded lines with --replay. When the UART takes nothing for several retries the
+// stream disables itself and drops the queue.
+//
+// The SDK refuses a blocking twr_uart_write while an asynchronous write is in progress, so the
+// responses of twr_atci would be lost while streaming. The firmware is linked with
+// -Wl,--wrap=twr_uart_write and the console writes of UART2 go through the same FIFO, after the
+// line being streamed, waiting for room like the blocking write waits for the UART.
+
+// Records queued for the UART, 10 B each
+#ifndef STREAM_LENGTH
+#define STREAM_LENGTH 32
+#endif
+
+// Length of a record and of its line with "#" and CR LF
+#define STREAM_RECORD_SIZE 10
+#define STREAM_LINE_SIZE (1 + 2 * STREAM_RECORD_SIZE + 2)
+
+// Sets the FIFOs of the console UART, call after twr_atci_init
+void stream_init(void);
+
+void stream_set_enabled(bool enabled);
+
+bool stream_is_enabled(void);
+
+void stream_sample(uint8_t field, float value);
+
+// Samples queued and dropped since boot
+uint32_t stream_get_count(void);
+
+uint32_t stream_get_dropped(void);
+
+// Replaces twr_uart_write by -Wl,--wrap=twr_uart_write
+size_t __wrap_twr_uart_write(twr_uart_channel_t channel, const void *buffer, size_t length);
+
+#endif // _STREAM_H
@@ -0,0 +1,124 @@
+#include <trace.h>
+
+// How the value of an event is printed, the firmware records it already scaled to an integer
+static const struct
+{
+    const char *name;
+    const char *unit;
+    uint8_t decimals;
+    bool sign;
+
+} _trace_events[TRACE_EVENT_COUNT] = {
+    [TRACE_EVENT_INIT] = { "INIT", "", 0, true },
+    [TRACE_EVENT_TASK] = { "TASK", "", 0, true },
+    [TRACE_EVENT_TASK_MODEM_NOT_READY] = { "TASK MODEM NOT READY", "", 0, true },
+    [TRACE_EVENT_TASK_BATCHED] = { "TASK BATCHED", "", 0, true },
+    [TRACE_EVENT_TASK_DONE] = { "TASK DONE", "B", 0, true },
+    [TRACE_EVENT_BACKFILL] = { "BACKFILL", "", 0, false },
+    [TRACE_EVENT_LORA] = { "LORA", "", 0, true },
+    [TRACE_EVENT_CO2] = { "CO2", "ppm", 0, true },
+    [TRACE_EVENT_CO2_ALARM] = { "CO2 ALARM", "", 0, true },
+    [TRACE_EVENT_VOC] = { "VOC", "ppb", 0, true },
+    [TRACE_EVENT_VOC_ALARM] = { "VOC ALARM", "", 0, true },
+    [TRACE_EVENT_BATTERY] = { "BATTERY", "mV", 0, true },
+    [TRACE_EVENT_HUMIDITY] = { "HUMIDITY", "%", 1, true },
+    [TRACE_EVENT_TEMPERATURE] = { "TEMPERATURE", "C", 1, true },
+    [TRACE_EVENT_BAROMETER] = { "BAROMETER", "hPa", 1, true },
+    [TRACE_EVENT_DISCOVERY] = { "DISCOVERY", "", 0, true },
+    [TRACE_EVENT_STORE] = { "STORE", "", 0, false },
+    [TRACE_EVENT_DOWNLINK_UNKNOWN] = { "DOWNLINK UNKNOWN", "", 0, true },
+    [TRACE_EVENT_DOWNLINK_TRUNCATED] = { "DOWNLINK TRUNCATED", "", 0, true },
+    [TRACE_EVENT_DOWNLINK_FAILED] = { "DOWNLINK FAILED", "", 0, true },
+    [TRACE_EVENT_AIRTIME] = { "AIRTIME", "s", 0, true },
+    [TRACE_EVENT_RETRY] = { "RETRY", "s", 0, true },
+    [TRACE_EVENT_HUMIDITY_CHANNEL] = { "HUMIDITY CHANNEL", "", 0, true },
+};
+
+static struct
+{
+    trace_record_t ring[TRACE_LENGTH];
+    uint32_t total;
+
+} _trace;
+
+void trace_record(trace_event_t event, uint8_t arg, int16_t value)
+{
+    trace_record_t *record = &_trace.ring[_trace.total % TRACE_LENGTH];
+
+    record->tick = twr_tick_get();
+    record->event = event;
+    record->arg = arg;
+    record->value = value;
+
+    _trace.total++;
+}
+
+int trace_get_count(void)
+{
+    return _trace.total < TRACE_LENGTH ? (int) _trace.total : TRACE_LENGTH;
+}
+
+uint32_t trace_get_total(void)
+{
+    return _trace.total;
+}
+
+bool trace_get(int index, trace_record_t *record)
+{
+    int count = trace_get_count();
+
+    if (index < 0 || index >= count)
+    {
+        return false;
+    }
+
+    *record = _trace.ring[(_trace.total - count + index) % TRACE_LENGTH];
+
+    return true;
+}
+
+size_t trace_format(const trace_record_t *record, char *buffer, size_t size)
+{
+    if (record->event >= TRACE_EVENT_COUNT || size == 0)
+    {
+        return 0;
+    }
+
+    int32_t value = _trace_events[record->event].sign ? record->value : (uint16_t) record->value;
+    const char *sign = value < 0 ? "-" : "";
+    int length;
+
+    if (value < 0)
+    {
+        value = -value;
+    }
+
+    if (_trace_events[record->event].decimals == 1)
+    {
+        length = snprintf(buffer, size, "%lu.%03lu,%s,%u,%s%ld.%ld %s", (unsigned long) (record->tick / 1000), (unsigned long) (record->tick % 1000),
+                          _trace_events[record->event].name, record->arg, sign, (long) (value / 10), (long) (value % 10), _trace_events[record->event].unit);
+    }
+    else
+    {
+        length = snprintf(buffer, size, "%lu.%03lu,%s,%u,%s%ld %s", (unsigned long) (record->tick / 1000), (unsigned long) (record->tick % 1000),
+                          _trace_events[record->event].name, record->arg, sign, (long) value, _trace_events[record->event].unit);
+    }
+
+    if (length < 0)
+    {
+        return 0;
+    }
+
+    // Drop the space left by an empty unit
+    if ((size_t) length < size && buffer[length - 1] == ' ')
+    {
+        buffer[--length] = '\0';
+    }
+
+    return (size_t) length < size ? (size_t) length : size - 1;
+}
+
+void trace_clear(void)
+{
+    _trace.total = 0;
+}
@@ -0,0 +1,109 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <twr.h>
+
+// Binary trace of application events
+//
+// An event is recorded as its id, the tick and two small arguments into a ring in RAM, the
+// oldest event is overwritten when the ring is full. Nothing is formatted or sent to the UART
+// when recording, the text is made only when the ring is dumped by AT$TRACE. Recording macros
+// below TRACE_LEVEL are compiled out.
+
+// Events kept in RAM, 8 B each
+#ifndef TRACE_LENGTH
+#define TRACE_LENGTH 64
+#endif
+
+#define TRACE_LEVEL_DEBUG 0
+#define TRACE_LEVEL_INFO 1
+#define TRACE_LEVEL_WARNING 2
+#define TRACE_LEVEL_ERROR 3
+#define TRACE_LEVEL_OFF 4
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_DEBUG
+#endif
+
+typedef enum
+{
+    TRACE_EVENT_INIT = 0,
+    TRACE_EVENT_TASK = 1,
+    TRACE_EVENT_TASK_MODEM_NOT_READY = 2,
+    TRACE_EVENT_TASK_BATCHED = 3,
+    TRACE_EVENT_TASK_DONE = 4,
+    TRACE_EVENT_BACKFILL = 5,
+    TRACE_EVENT_LORA = 6,
+    TRACE_EVENT_CO2 = 7,
+    TRACE_EVENT_CO2_ALARM = 8,
+    TRACE_EVENT_VOC = 9,
+    TRACE_EVENT_VOC_ALARM = 10,
+    TRACE_EVENT_BATTERY = 11,
+    TRACE_EVENT_HUMIDITY = 12,
+    TRACE_EVENT_TEMPERATURE = 13,
+    TRACE_EVENT_BAROMETER = 14,
+    TRACE_EVENT_DISCOVERY = 15,
+    TRACE_EVENT_STORE = 16,
+    TRACE_EVENT_DOWNLINK_UNKNOWN = 17,
+    TRACE_EVENT_DOWNLINK_TRUNCATED = 18,
+    TRACE_EVENT_DOWNLINK_FAILED = 19,
+    TRACE_EVENT_AIRTIME = 20,
+    TRACE_EVENT_RETRY = 21,
+    TRACE_EVENT_HUMIDITY_CHANNEL = 22,
+
+    TRACE_EVENT_COUNT
+
+} trace_event_t;
+
+typedef struct
+{
+    // Low 32 bits of the tick
+    uint32_t tick;
+    uint8_t event;
+    uint8_t arg;
+    int16_t value;
+
+} trace_record_t;
+
+#if TRACE_LEVEL <= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(event, arg, value) trace_record(event, arg, value)
+#else
+#define TRACE_DEBUG(event, arg, value) ((void) 0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_INFO
+#define TRACE_INFO(event, arg, value) trace_record(event, arg, value)
+#else
+#define TRACE_INFO(event, arg, value) ((void) 0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_WARNING
+#define TRACE_WARNING(event, arg, value) trace_record(event, arg, value)
+#else
+#define TRACE_WARNING(event, arg, value) ((void) 0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_ERROR
+#define TRACE_ERROR(event, arg, value) trace_record(event, arg, value)
+#else
+#define TRACE_ERROR(event, arg, value) ((void) 0)
+#endif
+
+// Use the TRACE_* macros so the level applies
+void trace_record(trace_event_t event, uint8_t arg, int16_t value);
+
+// Events in the ring, at most TRACE_LENGTH
+int trace_get_count(void);
+
+// Events recorded since boot including the overwritten ones
+uint32_t trace_get_total(void);
+
+// Event by age, 0 is the oldest one in the ring
+bool trace_get(int index, trace_record_t *record);
+
+// Text of an event as "seconds,name,arg,value unit", returns the length
+size_t trace_format(const trace_record_t *record, char *buffer, size_t size);
+
+void trace_clear(void);
+
+#endif // _TRACE_H
@@ -0,0 +1,35 @@
+#ifndef _TEST_H
+#define _TEST_H
+
+#include <stdio.h>
+
+// Checks of the unit tests, a failed check is reported with its line and the test goes on
+
+static int test_failures;
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_CHECK_EQUAL(actual, expected) \
+    do \
+    { \
+        long long _actual = (long long) (actual); \
+        long long _expected = (long long) (expected); \
+        if (_actual != _expected) \
+        { \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, _expected); \
+            test_failures++; \
+        } \
+    } while (0)
+
+// Exit status of the test executable
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif // _TEST_H
@@ -0,0 +1,84 @@
+#include <airtime.h>
+#include <test.h>
+
+// Time on air against the Semtech LoRa calculator (AN1200.13): 125 kHz unless noted, coding rate
+// 4/5, 8 symbol preamble, explicit header and CRC, 13 B of LoRaWAN overhead on the payload.
+// The firmware rounds up to whole ms.
+
+static twr_tick_t _test_tick;
+
+twr_tick_t twr_tick_get(void)
+{
+    return _test_tick;
+}
+
+static void _test_calculate(void)
+{
+    // SF7, 46.336 ms empty and 118.016 ms with 51 B
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 5, 0), 47);
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 5, 51), 119);
+
+    // SF12 with low data rate optimization, 1155.072 ms empty and 2793.472 ms with 51 B
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 0, 0), 1156);
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 0, 51), 2794);
+
+    // SF11 with low data rate optimization 1560.576 ms, it would be 1314.816 ms without
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 1, 51), 1561);
+
+    // SF10 has no low data rate optimization, 411.648 ms with 16 B
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 2, 16), 412);
+
+    // SF7 at 250 kHz 59.008 ms, US915 SF8 at 500 kHz 53.888 ms, with 51 B
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_EU868, 6, 51), 60);
+    TEST_CHECK_EQUAL(airtime_calculate(TWR_CMWX1ZZABZ_CONFIG_BAND_US915, 4, 51), 54);
+}
+
+static void _test_budget(void)
+{
+    // 1 % of the time with 36 s of airtime in the bucket
+    _test_tick = 0;
+
+    airtime_init(10, 36000);
+
+    TEST_CHECK_EQUAL(airtime_get_budget(), 36000);
+    TEST_CHECK_EQUAL(airtime_get_wait(36000), 0);
+
+    airtime_take(30000);
+
+    TEST_CHECK_EQUAL(airtime_get_budget(), 6000);
+    TEST_CHECK_EQUAL(airtime_get_wait(6000), 0);
+
+    // 10 s more of airtime take 1000 s of refill
+    TEST_CHECK_EQUAL(airtime_get_wait(16000), 1000000);
+
+    _test_tick = 500000;
+
+    TEST_CHECK_EQUAL(airtime_get_budget(), 11000);
+    TEST_CHECK_EQUAL(airtime_get_wait(16000), 500000);
+
+    // The bucket does not fill over its capacity
+    _test_tick = 10000000;
+
+    TEST_CHECK_EQUAL(airtime_get_budget(), 36000);
+
+    // An unchecked frame takes the budget below zero
+    airtime_take(40000);
+
+    TEST_CHECK_EQUAL(airtime_get_budget(), 0);
+    TEST_CHECK_EQUAL(airtime_get_wait(1), 400100);
+    TEST_CHECK_EQUAL(airtime_get_total(), 70000);
+
+    // Without duty cycle the bucket never refills
+    airtime_init(0, 1000);
+    airtime_take(1000);
+
+    TEST_CHECK_EQUAL(airtime_get_wait(1), TWR_TICK_INFINITY);
+}
+
+int main(void)
+{
+    _test_calculate();
+    _test_budget();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,222 @@
+#include <payload.h>
+#include <decoder.h>
+#include <math.h>
+#include <test.h>
+
+// Frames of the firmware encoder decoded back by the decoder library
+
+static aggregate_t _test_aggregates[PAYLOAD_FIELD_COUNT];
+static aggregate_t *_test_window[PAYLOAD_FIELD_COUNT];
+static decoder_frame_t _test_frame;
+
+// Sample of every field in the order of SENSOR_TABLE, -0.1 °C of the second temperature is all ones on the wire
+static const float _test_values[PAYLOAD_FIELD_COUNT] = { 3.0f, 21.5f, 45.0f, 120.0f, 98000.0f, 650.0f, 3.1f, -0.1f, 52.0f };
+
+// One sample of each field in mask, the others stay without samples
+static void _test_feed(uint16_t mask)
+{
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        _test_window[i] = &_test_aggregates[i];
+
+        aggregate_reset(&_test_aggregates[i]);
+
+        if (mask & (1 << i))
+        {
+            aggregate_feed(&_test_aggregates[i], payload_field_quantize(i, _test_values[i]));
+        }
+    }
+}
+
+// Decodes a compact frame of the window and checks every field against its wire value
+static void _test_compact(uint16_t mask, size_t expected_length, const uint8_t *expected_bitmap)
+{
+    uint8_t buffer[PAYLOAD_MAX_LENGTH];
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+    _test_feed(mask);
+
+    payload_window_raw(_test_window, raw);
+
+    size_t length = payload_encode(PAYLOAD_FORMAT_COMPACT, DECODER_HEADER_UPDATE, _test_window, buffer, sizeof(buffer));
+
+    TEST_CHECK_EQUAL(length, expected_length);
+    TEST_CHECK_EQUAL(buffer[0], DECODER_HEADER_UPDATE | PAYLOAD_HEADER_COMPACT);
+    TEST_CHECK(memcmp(buffer + 1, expected_bitmap, strlen((const char *) expected_bitmap)) == 0);
+
+    // A buffer one byte short takes nothing
+    TEST_CHECK_EQUAL(payload_encode(PAYLOAD_FORMAT_COMPACT, DECODER_HEADER_UPDATE, _test_window, buffer, expected_length - 1), 0);
+
+    TEST_CHECK_EQUAL(decoder_decode(buffer, length, &_test_frame), DECODER_OK);
+    TEST_CHECK_EQUAL(_test_frame.layout, DECODER_LAYOUT_COMPACT);
+    TEST_CHECK_EQUAL(_test_frame.header, DECODER_HEADER_UPDATE);
+    TEST_CHECK_EQUAL(_test_frame.count, 1);
+    TEST_CHECK_EQUAL(_test_frame.present[0], mask);
+
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        if (mask & (1 << i))
+        {
+            TEST_CHECK_EQUAL(_test_frame.raw[0][i], raw[i]);
+        }
+    }
+
+    // A frame cut anywhere is rejected
+    for (size_t i = 1; i < length; i++)
+    {
+        TEST_CHECK(decoder_decode(buffer, i, &_test_frame) != DECODER_OK);
+    }
+}
+
+static void _test_compact_bitmap(void)
+{
+    // Fields of the first bitmap byte only, VOC missing
+    _test_compact(0x77, 11, (const uint8_t *) "\x77");
+
+    // Only the second channel, the first byte is empty apart from its continuation bit
+    _test_compact(0x180, 1 + 2 + 3, (const uint8_t *) "\x80\x03");
+
+    // Every field, the second byte of the bitmap carries the second humidity channel
+    _test_compact(0x1ff, 1 + 2 + 14, (const uint8_t *) "\xff\x03");
+
+    TEST_CHECK_EQUAL(PAYLOAD_COMPACT_MAX_LENGTH, 1 + 2 + 14);
+
+    // The compact layout leaves missing fields out, so an all ones value is a reading
+    double value;
+
+    TEST_CHECK_EQUAL(_test_frame.raw[0][PAYLOAD_FIELD_TEMPERATURE_2], 0xffff);
+    TEST_CHECK(decoder_get_value(&_test_frame, 0, DECODER_FIELD_TEMPERATURE_2, &value) && fabs(value + 0.1) < 1e-9);
+    TEST_CHECK(decoder_get_value(&_test_frame, 0, DECODER_FIELD_PRESSURE, &value) && value == 98000.0);
+}
+
+static void _test_fixed(void)
+{
+    uint8_t buffer[PAYLOAD_MAX_LENGTH];
+
+    _test_feed(0x77);
+
+    TEST_CHECK_EQUAL(payload_encode(PAYLOAD_FORMAT_FIXED, DECODER_HEADER_BOOT, _test_window, buffer, sizeof(buffer)), PAYLOAD_FIXED_LENGTH);
+    TEST_CHECK_EQUAL(decoder_decode(buffer, PAYLOAD_FIXED_LENGTH, &_test_frame), DECODER_OK);
+    TEST_CHECK_EQUAL(_test_frame.layout, DECODER_LAYOUT_FIXED);
+    TEST_CHECK(decoder_is_missing(DECODER_FIELD_VOC, _test_frame.raw[0][DECODER_FIELD_VOC]));
+    TEST_CHECK_EQUAL(_test_frame.raw[0][DECODER_FIELD_CO2], 650);
+    TEST_CHECK_EQUAL(_test_frame.raw[0][DECODER_FIELD_TEMPERATURE], 215);
+}
+
+// Integer samples take the fixed point of the float ones without float
+static void _test_field_fixed(void)
+{
+    TEST_CHECK_EQUAL(payload_field_fixed(PAYLOAD_FIELD_CO2, 1200), payload_field_quantize(PAYLOAD_FIELD_CO2, 1200.f));
+    TEST_CHECK_EQUAL(payload_field_fixed(PAYLOAD_FIELD_VOC, 65535), payload_field_quantize(PAYLOAD_FIELD_VOC, 65535.f));
+    TEST_CHECK_EQUAL(payload_field_fixed(PAYLOAD_FIELD_PRESSURE, 98001), payload_field_quantize(PAYLOAD_FIELD_PRESSURE, 98001.f));
+    TEST_CHECK_EQUAL(payload_field_fixed(PAYLOAD_FIELD_TEMPERATURE, -3), payload_field_quantize(PAYLOAD_FIELD_TEMPERATURE, -3.f));
+}
+
+// Wire values of four windows, all ones when missing, the comments give the delta to the previous window
+static const uint16_t _test_batch[4][PAYLOAD_FIELD_COUNT] = {
+    { 30, 215, 90, 120, 49000, 650, 31, 0xffff, 0xff },
+    // CO2 +127 is the largest delta, VOC goes missing
+    { 30, 200, 90, 0xffff, 49000, 777, 31, 0xffff, 0xff },
+    // CO2 -128 and the temperature to -0.5 °C are out of range, VOC and the second humidity come back
+    { 30, 0xfffb, 90, 130, 49000, 649, 31, 0xffff, 104 },
+    // Temperature +1 below zero, CO2 +2000, the second humidity goes missing
+    { 30, 0xfffc, 90, 130, 49000, 2649, 31, 0xffff, 0xff },
+};
+
+static void _test_batch_check(int first, int count)
+{
+    TEST_CHECK_EQUAL(_test_frame.layout, DECODER_LAYOUT_BATCH);
+    TEST_CHECK_EQUAL(_test_frame.count, count);
+
+    for (int i = 0; i < count && i < _test_frame.count; i++)
+    {
+        for (int j = 0; j < PAYLOAD_FIELD_COUNT; j++)
+        {
+            TEST_CHECK_EQUAL(_test_frame.raw[i][j], _test_batch[first + i][j]);
+        }
+    }
+}
+
+static void _test_batch_escape(void)
+{
+    static payload_batch_t batch;
+    uint8_t buffer[64];
+
+    payload_batch_reset(&batch);
+
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_CHECK(payload_batch_add_raw(&batch, _test_batch[i]));
+    }
+
+    // Header, count, two bitmap bytes for the second humidity, 12 B of the first window and
+    // the deltas with 2 + 4 + 2 escapes
+    size_t length = payload_batch_encode(&batch, DECODER_HEADER_UPDATE, buffer, sizeof(buffer));
+
+    TEST_CHECK_EQUAL(length, 1 + 1 + 2 + 12 + 11 + 15 + 11);
+    TEST_CHECK_EQUAL(buffer[0], DECODER_HEADER_UPDATE | PAYLOAD_HEADER_COMPACT | PAYLOAD_HEADER_BATCH);
+    TEST_CHECK_EQUAL(buffer[2], 0xff);
+    TEST_CHECK_EQUAL(buffer[3], 0x02);
+    TEST_CHECK_EQUAL(payload_batch_get_count(&batch), 0);
+
+    // The frame ends with the escape of the second humidity and its value, an escape without the value is rejected
+    TEST_CHECK_EQUAL(buffer[length - 2], PAYLOAD_BATCH_ESCAPE);
+    TEST_CHECK(decoder_decode(buffer, length - 1, &_test_frame) != DECODER_OK);
+
+    TEST_CHECK_EQUAL(decoder_decode(buffer, length, &_test_frame), DECODER_OK);
+
+    _test_batch_check(0, 4);
+
+    // At the payload limit the last window goes into a frame of its own with a one byte bitmap
+    for (int i = 0; i < 4; i++)
+    {
+        payload_batch_add_raw(&batch, _test_batch[i]);
+    }
+
+    length = payload_batch_encode(&batch, DECODER_HEADER_UPDATE, buffer, PAYLOAD_MAX_LENGTH);
+
+    TEST_CHECK_EQUAL(length, 1 + 1 + 2 + 12 + 11 + 15);
+    TEST_CHECK_EQUAL(payload_batch_get_count(&batch), 1);
+    TEST_CHECK_EQUAL(decoder_decode(buffer, length, &_test_frame), DECODER_OK);
+
+    _test_batch_check(0, 3);
+
+    length = payload_batch_encode(&batch, DECODER_HEADER_UPDATE, buffer, PAYLOAD_MAX_LENGTH);
+
+    TEST_CHECK_EQUAL(length, 1 + 1 + 1 + 11);
+    TEST_CHECK_EQUAL(buffer[2], 0x7f);
+    TEST_CHECK_EQUAL(decoder_decode(buffer, length, &_test_frame), DECODER_OK);
+
+    _test_batch_check(3, 1);
+}
+
+static void _test_backfill(void)
+{
+    static payload_batch_t batch;
+    uint8_t buffer[PAYLOAD_MAX_LENGTH];
+
+    payload_batch_reset(&batch);
+    payload_batch_add_raw(&batch, _test_batch[2]);
+    payload_batch_add_raw(&batch, _test_batch[3]);
+
+    size_t length = payload_backfill_encode(&batch, DECODER_HEADER_BACKFILL, 0xfffe, 300, buffer, sizeof(buffer));
+
+    TEST_CHECK_EQUAL(decoder_decode(buffer, length, &_test_frame), DECODER_OK);
+    TEST_CHECK_EQUAL(_test_frame.header, DECODER_HEADER_BACKFILL);
+    TEST_CHECK(_test_frame.has_sequence);
+    TEST_CHECK_EQUAL(_test_frame.sequence, 0xfffe);
+    TEST_CHECK_EQUAL(_test_frame.age, 300);
+
+    _test_batch_check(2, 2);
+}
+
+int main(void)
+{
+    _test_compact_bitmap();
+    _test_fixed();
+    _test_field_fixed();
+    _test_batch_escape();
+    _test_backfill();
+
+    return TEST_RESULT();
+}
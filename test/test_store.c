@@ -0,0 +1,250 @@
+#include <store.h>
+#include <test.h>
+
+// EEPROM ring of the windows on a RAM EEPROM, a reboot is a new store_init() on the same content
+
+static uint8_t _test_eeprom[TWR_EEPROM_SIZE];
+
+bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
+{
+    if (address + length > sizeof(_test_eeprom))
+    {
+        return false;
+    }
+
+    memcpy(_test_eeprom + address, buffer, length);
+
+    return true;
+}
+
+bool twr_eeprom_read(uint32_t address, void *buffer, size_t length)
+{
+    if (address + length > sizeof(_test_eeprom))
+    {
+        return false;
+    }
+
+    memcpy(buffer, _test_eeprom + address, length);
+
+    return true;
+}
+
+size_t twr_eeprom_get_size(void)
+{
+    return sizeof(_test_eeprom);
+}
+
+twr_tick_t twr_tick_get(void)
+{
+    return 0;
+}
+
+// Values of a window that differ for every sequence number
+static void _test_raw(uint16_t sequence, uint16_t raw[PAYLOAD_FIELD_COUNT])
+{
+    for (int i = 0; i < PAYLOAD_FIELD_COUNT; i++)
+    {
+        raw[i] = sequence * PAYLOAD_FIELD_COUNT + i;
+    }
+}
+
+static void _test_append(int count)
+{
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+
+    for (int i = 0; i < count; i++)
+    {
+        _test_raw(store_get_sequence(), raw);
+
+        store_append(raw);
+    }
+}
+
+// Oldest pending run, checks the values of every window in it
+static int _test_pending(uint16_t *sequence, int max)
+{
+    uint16_t raw[PAYLOAD_BATCH_MAX][PAYLOAD_FIELD_COUNT];
+    uint16_t expected[PAYLOAD_FIELD_COUNT];
+
+    int count = store_get_pending(sequence, raw, max, store_get_sequence());
+
+    for (int i = 0; i < count; i++)
+    {
+        _test_raw(*sequence + i, expected);
+
+        TEST_CHECK(memcmp(raw[i], expected, sizeof(expected)) == 0);
+    }
+
+    return count;
+}
+
+static void _test_wraparound(void)
+{
+    uint16_t sequence = 0;
+
+    memset(_test_eeprom, 0, sizeof(_test_eeprom));
+
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_sequence(), 0);
+    TEST_CHECK_EQUAL(store_get_pending_count(), 0);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), 0);
+
+    // The ring keeps the newest windows once it is full
+    _test_append(STORE_LENGTH + 44);
+
+    TEST_CHECK_EQUAL(store_get_sequence(), STORE_LENGTH + 44);
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 44);
+
+    // A reboot recovers the sequence number and the pending windows
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_sequence(), STORE_LENGTH + 44);
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 44);
+}
+
+static void _test_confirm(void)
+{
+    uint16_t sequence = 0;
+
+    // Queued windows are skipped, the acknowledge clears them for good
+    store_queue(44, 8);
+
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 52);
+
+    store_confirm();
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH - 8);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 52);
+
+    // Released windows are pending again
+    store_queue(52, 4);
+    store_release();
+
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH - 8);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 52);
+}
+
+static void _test_crc(void)
+{
+    uint16_t raw[PAYLOAD_FIELD_COUNT];
+    uint16_t sequence = 0;
+    uint8_t *record = NULL;
+
+    // Flip a bit in the values of window 56
+    _test_raw(56, raw);
+
+    for (size_t i = 0; i + sizeof(raw) <= sizeof(_test_eeprom); i++)
+    {
+        if (memcmp(_test_eeprom + i, raw, sizeof(raw)) == 0)
+        {
+            record = _test_eeprom + i;
+        }
+    }
+
+    TEST_CHECK(record != NULL);
+
+    if (record == NULL)
+    {
+        return;
+    }
+
+    record[1] ^= 0x10;
+
+    // The run read before the reboot ends at the bad window, which is dropped
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), 4);
+    TEST_CHECK_EQUAL(sequence, 52);
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH - 9);
+
+    store_queue(52, 4);
+    store_confirm();
+
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 57);
+
+    // The boot scan rejects it as well
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH - 13);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, 57);
+}
+
+static void _test_sequence_wrap(void)
+{
+    uint16_t sequence = 0;
+
+    memset(_test_eeprom, 0, sizeof(_test_eeprom));
+
+    store_init();
+
+    // The slot of a sequence number stays the same when the 16 bit sequence wraps
+    _test_append(0x10000 + 10);
+
+    TEST_CHECK_EQUAL(store_get_sequence(), 10);
+
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_sequence(), 10);
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH);
+    TEST_CHECK_EQUAL(_test_pending(&sequence, PAYLOAD_BATCH_MAX), PAYLOAD_BATCH_MAX);
+    TEST_CHECK_EQUAL(sequence, (uint16_t) (10 - STORE_LENGTH));
+}
+
+static void _test_signature(void)
+{
+    const uint32_t signature = STORE_SIGNATURE;
+    uint8_t *header = NULL;
+
+    // Records of the previous test survive a reboot of the same layout
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_pending_count(), STORE_LENGTH);
+
+    for (size_t i = 0; i + sizeof(signature) <= sizeof(_test_eeprom); i++)
+    {
+        if (memcmp(_test_eeprom + i, &signature, sizeof(signature)) == 0)
+        {
+            header = _test_eeprom + i;
+        }
+    }
+
+    TEST_CHECK(header != NULL);
+
+    if (header == NULL)
+    {
+        return;
+    }
+
+    // A firmware with another layout erases the ring instead of reading its records
+    header[0] ^= 0x01;
+
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_sequence(), 0);
+    TEST_CHECK_EQUAL(store_get_pending_count(), 0);
+    TEST_CHECK(memcmp(header, &signature, sizeof(signature)) == 0);
+
+    store_init();
+
+    TEST_CHECK_EQUAL(store_get_pending_count(), 0);
+}
+
+int main(void)
+{
+    _test_wraparound();
+    _test_confirm();
+    _test_crc();
+    _test_sequence_wrap();
+    _test_signature();
+
+    return TEST_RESULT();
+}